@@ -52,6 +52,9 @@ struct uacpi_runtime_context {
 #endif
     uacpi_u64 opcodes_executed;
 
+    // Only counted while the boot timeline is active, see timeline.h
+    uacpi_u64 objects_allocated;
+
     uacpi_u32 loop_timeout_seconds;
     uacpi_u32 max_call_stack_depth;
 
@@ -71,6 +74,23 @@ struct uacpi_runtime_context {
     uacpi_bool global_lock_pending;
 #endif
 
+    /*
+     * Serializes on-demand _STA/_INI evaluation, see
+     * UACPI_FLAG_LAZY_NAMESPACE_INIT. Only created if the flag is set.
+     */
+    uacpi_handle lazy_init_mutex;
+    uacpi_thread_id lazy_init_owner;
+    uacpi_bool lazy_init_active;
+
+    /*
+     * Held around every field access while the namespace is initialized in
+     * parallel, see UACPI_FLAG_PARALLEL_NAMESPACE_INIT. NULL otherwise.
+     */
+    uacpi_mutex *parallel_init_region_mutex;
+
+    // _REG for global handlers is run on first access, see UACPI_FLAG_LAZY_REG
+    uacpi_bool lazy_reg_active;
+
     uacpi_u8 log_level;
     uacpi_u8 init_level;
 };
@@ -18,3 +18,13 @@ uacpi_status uacpi_execute_control_method(
     uacpi_namespace_node *scope, uacpi_control_method *method,
     const uacpi_object_array *args, uacpi_object **ret
 );
+
+/*
+ * Same as uacpi_eval_typed, except the caller must already be holding the
+ * namespace write lock. Used by bulk APIs evaluating lots of small objects.
+ */
+uacpi_status uacpi_eval_typed_locked(
+    uacpi_namespace_node *parent, const uacpi_char *path,
+    const uacpi_object_array *args, uacpi_object_type_bits ret_mask,
+    uacpi_object **out_obj
+);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <uacpi/internal/types.h>
+#include <uacpi/internal/helpers.h>
 #include <uacpi/kernel_api.h>
 
 uacpi_bool uacpi_this_thread_owns_aml_mutex(uacpi_mutex*);
@@ -8,6 +9,18 @@ uacpi_bool uacpi_this_thread_owns_aml_mutex(uacpi_mutex*);
 uacpi_status uacpi_acquire_aml_mutex(uacpi_mutex*, uacpi_u16 timeout);
 uacpi_status uacpi_release_aml_mutex(uacpi_mutex*);
 
+#ifndef UACPI_SINGLE_THREADED
+
+static inline uacpi_handle uacpi_create_native_mutex(void)
+{
+    return uacpi_kernel_create_mutex();
+}
+
+static inline void uacpi_free_native_mutex(uacpi_handle mtx)
+{
+    uacpi_kernel_free_mutex(mtx);
+}
+
 static inline uacpi_status uacpi_acquire_native_mutex(uacpi_handle mtx)
 {
     if (uacpi_unlikely(mtx == UACPI_NULL))
@@ -50,6 +63,33 @@ static inline uacpi_status uacpi_release_native_mutex_may_be_null(
     return UACPI_STATUS_OK;
 }
 
+static inline uacpi_handle uacpi_create_native_spinlock(void)
+{
+    return uacpi_kernel_create_spinlock();
+}
+
+static inline void uacpi_free_native_spinlock(uacpi_handle lock)
+{
+    uacpi_kernel_free_spinlock(lock);
+}
+
+static inline uacpi_cpu_flags uacpi_lock_native_spinlock(uacpi_handle lock)
+{
+    return uacpi_kernel_lock_spinlock(lock);
+}
+
+static inline void uacpi_unlock_native_spinlock(
+    uacpi_handle lock, uacpi_cpu_flags flags
+)
+{
+    uacpi_kernel_unlock_spinlock(lock, flags);
+}
+
+static inline uacpi_thread_id uacpi_current_thread_id(void)
+{
+    return uacpi_kernel_get_thread_id();
+}
+
 struct uacpi_rw_lock {
     uacpi_handle read_mutex;
     uacpi_handle write_mutex;
@@ -64,3 +104,123 @@ uacpi_status uacpi_rw_unlock_read(struct uacpi_rw_lock *lock);
 
 uacpi_status uacpi_rw_lock_write(struct uacpi_rw_lock *lock);
 uacpi_status uacpi_rw_unlock_write(struct uacpi_rw_lock *lock);
+
+#else
+
+/*
+ * There's nobody to synchronize with, so native locks are never created and
+ * every operation on them succeeds immediately. A non-NULL dummy handle is
+ * handed out so that allocation failure checks at call sites keep working.
+ */
+static inline uacpi_handle uacpi_create_native_lock_dummy(void)
+{
+    static uacpi_u8 dummy;
+    return &dummy;
+}
+
+#define UACPI_SINGLE_THREAD_ID ((uacpi_thread_id)1)
+
+static inline uacpi_handle uacpi_create_native_mutex(void)
+{
+    return uacpi_create_native_lock_dummy();
+}
+
+static inline void uacpi_free_native_mutex(uacpi_handle mtx)
+{
+    UACPI_UNUSED(mtx);
+}
+
+static inline uacpi_status uacpi_acquire_native_mutex(uacpi_handle mtx)
+{
+    UACPI_UNUSED(mtx);
+    return UACPI_STATUS_OK;
+}
+
+static inline uacpi_status uacpi_acquire_native_mutex_with_timeout(
+    uacpi_handle mtx, uacpi_u16 timeout
+)
+{
+    UACPI_UNUSED(mtx);
+    UACPI_UNUSED(timeout);
+    return UACPI_STATUS_OK;
+}
+
+static inline uacpi_status uacpi_release_native_mutex(uacpi_handle mtx)
+{
+    UACPI_UNUSED(mtx);
+    return UACPI_STATUS_OK;
+}
+
+#define uacpi_acquire_native_mutex_may_be_null uacpi_acquire_native_mutex
+#define uacpi_release_native_mutex_may_be_null uacpi_release_native_mutex
+
+static inline uacpi_handle uacpi_create_native_spinlock(void)
+{
+    return uacpi_create_native_lock_dummy();
+}
+
+static inline void uacpi_free_native_spinlock(uacpi_handle lock)
+{
+    UACPI_UNUSED(lock);
+}
+
+static inline uacpi_cpu_flags uacpi_lock_native_spinlock(uacpi_handle lock)
+{
+    UACPI_UNUSED(lock);
+    return 0;
+}
+
+static inline void uacpi_unlock_native_spinlock(
+    uacpi_handle lock, uacpi_cpu_flags flags
+)
+{
+    UACPI_UNUSED(lock);
+    UACPI_UNUSED(flags);
+}
+
+static inline uacpi_thread_id uacpi_current_thread_id(void)
+{
+    return UACPI_SINGLE_THREAD_ID;
+}
+
+struct uacpi_rw_lock {
+    uacpi_u8 unused;
+};
+
+static inline uacpi_status uacpi_rw_lock_init(struct uacpi_rw_lock *lock)
+{
+    UACPI_UNUSED(lock);
+    return UACPI_STATUS_OK;
+}
+
+static inline uacpi_status uacpi_rw_lock_deinit(struct uacpi_rw_lock *lock)
+{
+    UACPI_UNUSED(lock);
+    return UACPI_STATUS_OK;
+}
+
+static inline uacpi_status uacpi_rw_lock_read(struct uacpi_rw_lock *lock)
+{
+    UACPI_UNUSED(lock);
+    return UACPI_STATUS_OK;
+}
+
+static inline uacpi_status uacpi_rw_unlock_read(struct uacpi_rw_lock *lock)
+{
+    UACPI_UNUSED(lock);
+    return UACPI_STATUS_OK;
+}
+
+static inline uacpi_status uacpi_rw_lock_write(struct uacpi_rw_lock *lock)
+{
+    UACPI_UNUSED(lock);
+    return UACPI_STATUS_OK;
+}
+
+static inline uacpi_status uacpi_rw_unlock_write(struct uacpi_rw_lock *lock)
+{
+    UACPI_UNUSED(lock);
+    return UACPI_STATUS_OK;
+}
+
+#endif
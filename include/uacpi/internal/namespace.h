@@ -22,12 +22,41 @@
  */
 #define UACPI_NAMESPACE_NODE_FLAG_TEMPORARY (1u << 2)
 
+/*
+ * _STA/_INI have been run for this node and every device below it.
+ * Set for devices, processors and thermal zones, as well as for any other
+ * node passed to uacpi_namespace_initialize_subtree.
+ */
+#define UACPI_NAMESPACE_NODE_FLAG_INITIALIZED (1u << 3)
+
+/*
+ * _STA/_INI of this node itself have already been run. Only tracked with
+ * UACPI_FLAG_LAZY_NAMESPACE_INIT.
+ */
+#define UACPI_NAMESPACE_NODE_FLAG_STA_INI_DONE (1u << 4)
+
+/*
+ * _STA reported this node as neither present nor functioning, so nothing
+ * below it must be initialized. Only valid with FLAG_STA_INI_DONE.
+ */
+#define UACPI_NAMESPACE_NODE_FLAG_NOT_PRESENT (1u << 5)
+
+/*
+ * _REG has been run for the regions of this node and every node above it.
+ * Only tracked with UACPI_FLAG_LAZY_REG.
+ */
+#define UACPI_NAMESPACE_NODE_FLAG_REG_DONE (1u << 6)
+
 #define UACPI_NAMESPACE_NODE_PREDEFINED (1u << 31)
 
 typedef struct uacpi_namespace_node {
     struct uacpi_shareable shareable;
     uacpi_object_name name;
     uacpi_u32 flags;
+
+    // See uacpi_namespace_generation
+    uacpi_u32 generation;
+
     uacpi_object *object;
     struct uacpi_namespace_node *parent;
     struct uacpi_namespace_node *child;
@@ -108,6 +137,19 @@ uacpi_status uacpi_namespace_do_for_each_child(
     enum uacpi_permanent_only, void *user
 );
 
+/*
+ * The namespace generation is bumped every time the identity or presence of a
+ * device might have changed, the affected nodes are stamped with the new value:
+ * - a permanent node is installed or uninstalled, its parent is also stamped if
+ *   the node has a predefined name like _HID or _STA
+ * - a node receives a device check notification
+ * - a node receives a bus check notification, its entire subtree is stamped
+ *
+ * All of the above are done with the namespace write lock held.
+ */
+uacpi_u32 uacpi_namespace_generation(void);
+void uacpi_namespace_on_notify(uacpi_namespace_node *node, uacpi_u64 value);
+
 uacpi_bool uacpi_namespace_node_is_dangling(uacpi_namespace_node *node);
 uacpi_bool uacpi_namespace_node_is_temporary(uacpi_namespace_node *node);
 uacpi_bool uacpi_namespace_node_is_predefined(uacpi_namespace_node *node);
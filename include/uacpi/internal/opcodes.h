@@ -1,6 +1,7 @@
 #pragma once
 
 #include <uacpi/types.h>
+#include <uacpi/internal/types.h>
 
 typedef uacpi_u16 uacpi_aml_op;
 
@@ -143,6 +144,13 @@ enum uacpi_parse_op {
     UACPI_PARSE_OP_LOAD_FALSE_OBJECT,
     UACPI_PARSE_OP_LOAD_TRUE_OBJECT,
 
+    /*
+     * Load the immutable shared integer object specified by
+     * decode_ops[pc + 1] (see enum uacpi_shared_constant). Unlike other
+     * object-generating ops, this doesn't allocate anything.
+     */
+    UACPI_PARSE_OP_LOAD_SHARED_CONSTANT,
+
     // Truncate the last item in the list if needed
     UACPI_PARSE_OP_TRUNCATE_NUMBER,
 
@@ -463,8 +471,8 @@ UACPI_OP(                                                        \
 UACPI_OP(                                                        \
     ZeroOp, 0x00,                                                \
     {                                                            \
-        UACPI_PARSE_OP_LOAD_INLINE_IMM_AS_OBJECT,                \
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          \
+        UACPI_PARSE_OP_LOAD_SHARED_CONSTANT,                     \
+        UACPI_SHARED_CONSTANT_ZERO,                              \
         UACPI_PARSE_OP_OBJECT_TRANSFER_TO_PREV,                  \
     },                                                           \
     UACPI_OP_PROPERTY_TARGET |                                   \
@@ -473,8 +481,8 @@ UACPI_OP(                                                        \
 UACPI_OP(                                                        \
     OneOp, 0x01,                                                 \
     {                                                            \
-        UACPI_PARSE_OP_LOAD_INLINE_IMM_AS_OBJECT,                \
-        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          \
+        UACPI_PARSE_OP_LOAD_SHARED_CONSTANT,                     \
+        UACPI_SHARED_CONSTANT_ONE,                               \
         UACPI_PARSE_OP_OBJECT_TRANSFER_TO_PREV,                  \
     },                                                           \
     UACPI_OP_PROPERTY_TERM_ARG                                   \
@@ -1054,9 +1062,8 @@ UACPI_METHOD_CALL_OPCODE(7)                                      \
 UACPI_OP(                                                        \
     OnesOp, 0xFF,                                                \
     {                                                            \
-        UACPI_PARSE_OP_LOAD_INLINE_IMM_AS_OBJECT,                \
-        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,          \
-        UACPI_PARSE_OP_TRUNCATE_NUMBER,                          \
+        UACPI_PARSE_OP_LOAD_SHARED_CONSTANT,                     \
+        UACPI_SHARED_CONSTANT_ONES,                              \
         UACPI_PARSE_OP_OBJECT_TRANSFER_TO_PREV,                  \
     },                                                           \
     UACPI_OP_PROPERTY_TERM_ARG                                   \
@@ -1222,8 +1229,8 @@ UACPI_BUILD_TO_FROM_BCD(To, 0x29)                           \
 UACPI_OP(                                                   \
     RevisionOp, UACPI_EXT_OP(0x30),                         \
     {                                                       \
-        UACPI_PARSE_OP_LOAD_INLINE_IMM_AS_OBJECT,           \
-        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     \
+        UACPI_PARSE_OP_LOAD_SHARED_CONSTANT,                \
+        UACPI_SHARED_CONSTANT_ONE,                          \
         UACPI_PARSE_OP_OBJECT_TRANSFER_TO_PREV,             \
     },                                                      \
     UACPI_OP_PROPERTY_TERM_ARG                              \
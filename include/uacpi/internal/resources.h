@@ -261,6 +261,8 @@ struct uacpi_resource_convert_instruction {
     };
 };
 
+struct uacpi_resource_convert_state;
+
 struct uacpi_resource_spec {
     uacpi_u8 type : 5;
     uacpi_u8 native_type : 5;
@@ -299,6 +301,19 @@ struct uacpi_resource_spec {
 
     const struct uacpi_resource_convert_instruction *to_native;
     const struct uacpi_resource_convert_instruction *to_aml;
+
+#ifdef UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+    /*
+     * Versions of the to_native/to_aml programs compiled into straight-line
+     * code, NULL if the respective program is NULL.
+     */
+    uacpi_iteration_decision (*to_native_specialized)(
+        struct uacpi_resource_convert_state*
+    );
+    uacpi_iteration_decision (*to_aml_specialized)(
+        struct uacpi_resource_convert_state*
+    );
+#endif
 };
 
 typedef uacpi_iteration_decision (*uacpi_aml_resource_iteration_callback)(
@@ -321,3 +336,29 @@ uacpi_status uacpi_native_resources_from_aml(
 uacpi_status uacpi_native_resources_to_aml(
     uacpi_resources *resources, uacpi_object **out_template
 );
+
+#ifdef UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+/*
+ * Make conversions go through the instruction interpreter instead of the
+ * specialized converters, only useful for cross-checking the two in tests.
+ */
+void uacpi_resources_force_interpreter(uacpi_bool enabled);
+#endif
+
+uacpi_status uacpi_initialize_resources(void);
+void uacpi_deinitialize_resources(void);
+
+// Drop all resources cached in 'cache', called when a device is destroyed
+void uacpi_resource_cache_release(struct uacpi_resource_cache *cache);
+
+// Drop the cached resources of all devices, e.g. after a table load
+void uacpi_resource_cache_invalidate_all(void);
+
+/*
+ * Hooks for events that might change the resources of a device. The caller
+ * must hold the namespace lock.
+ */
+void uacpi_resource_cache_on_method_call(uacpi_namespace_node *method_node);
+void uacpi_resource_cache_on_notify(
+    uacpi_namespace_node *node, uacpi_u64 value
+);
@@ -6,6 +6,14 @@ struct uacpi_shareable {
     uacpi_u32 reference_count;
 };
 
+#define UACPI_SHAREABLE_BUGGED_REFCOUNT 0xFFFFFFFF
+
+/*
+ * Static initializer for a shareable that is never freed, all reference
+ * counting operations on it are no-ops, same as for a bugged shareable.
+ */
+#define UACPI_SHAREABLE_PERMANENT { UACPI_SHAREABLE_BUGGED_REFCOUNT }
+
 void uacpi_shareable_init(uacpi_handle);
 
 uacpi_bool uacpi_bugged_shareable(uacpi_handle);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <uacpi/internal/context.h>
+#include <uacpi/platform/atomic.h>
+#include <uacpi/uacpi.h>
+
+uacpi_status uacpi_initialize_timeline(void);
+void uacpi_deinitialize_timeline(void);
+
+/*
+ * Events are only recorded with UACPI_FLAG_BOOT_TIMELINE and until the
+ * namespace is fully initialized.
+ */
+static inline uacpi_bool uacpi_timeline_is_active(void)
+{
+    return uacpi_check_flag(UACPI_FLAG_BOOT_TIMELINE) &&
+           g_uacpi_rt_ctx.init_level < UACPI_INIT_LEVEL_NAMESPACE_INITIALIZED;
+}
+
+/*
+ * Count an object or namespace node allocation towards the current events.
+ * These may happen outside of the namespace lock, hence the atomic.
+ */
+static inline void uacpi_timeline_count_allocation(void)
+{
+    if (uacpi_timeline_is_active())
+        uacpi_atomic_inc64(&g_uacpi_rt_ctx.objects_allocated);
+}
+
+/*
+ * Start recording 'event' into 'rec', the caller then fills in the subject
+ * and submits it via uacpi_timeline_end. Nothing is recorded if the timeline
+ * is not active, in which case 'rec' is only zeroed.
+ */
+void uacpi_timeline_begin(uacpi_timeline_record *rec, uacpi_timeline_event);
+void uacpi_timeline_end(uacpi_timeline_record *rec, uacpi_status);
+
+// Submit an already complete record
+void uacpi_timeline_submit(const uacpi_timeline_record *rec);
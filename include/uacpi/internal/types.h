@@ -2,6 +2,7 @@
 
 #include <uacpi/status.h>
 #include <uacpi/types.h>
+#include <uacpi/platform/config.h>
 #include <uacpi/internal/shareable.h>
 
 // object->flags field if object->type == UACPI_OBJECT_REFERENCE
@@ -19,19 +20,56 @@ enum uacpi_string_kind {
     UACPI_STRING_KIND_PATH,
 };
 
+/*
+ * uacpi_buffer->flags & uacpi_package->flags
+ *
+ * The storage is referenced by something other than plain owning objects,
+ * e.g. a buffer field, an index object or a shallow copy, so every write to
+ * it must be visible through all of those. Such storage is never shared on a
+ * deep copy and is instead copied eagerly.
+ */
+#define UACPI_STORAGE_ALIASED (1 << 0)
+
+// The storage is part of a packed allocation, see uacpi_object_try_pack
+#define UACPI_STORAGE_PACKED (1 << 1)
+
+/*
+ * uacpi_package->flags only
+ *
+ * The package consists of integers only, which are stored as a flat array in
+ * package->integers instead of separate objects. See uacpi_package_expand.
+ */
+#define UACPI_STORAGE_INTEGER_ARRAY (1 << 2)
+
 typedef struct uacpi_buffer {
     struct uacpi_shareable shareable;
+    uacpi_u8 flags;
     union {
         void *data;
         uacpi_u8 *byte_data;
         uacpi_char *text;
     };
     uacpi_size size;
+
+    /*
+     * Size of the heap allocated payload if it has spare room past 'size',
+     * see uacpi_buffer_grow_data. 0 means the allocation is exactly 'size'.
+     */
+    uacpi_size capacity;
+
+#if UACPI_BUFFER_INLINE_STORAGE_SIZE
+    // Used as the payload instead of a heap allocation for small payloads
+    uacpi_u8 inline_data[UACPI_BUFFER_INLINE_STORAGE_SIZE];
+#endif
 } uacpi_buffer;
 
 typedef struct uacpi_package {
     struct uacpi_shareable shareable;
-    uacpi_object **objects;
+    uacpi_u8 flags;
+    union {
+        uacpi_object **objects;
+        uacpi_u64 *integers;
+    };
     uacpi_size count;
 } uacpi_package;
 
@@ -124,10 +162,55 @@ typedef struct uacpi_operation_region {
     struct uacpi_operation_region *next;
 } uacpi_operation_region;
 
+enum uacpi_resource_cache_slot {
+    UACPI_RESOURCE_CACHE_SLOT_CRS = 0,
+    UACPI_RESOURCE_CACHE_SLOT_PRS = 1,
+    UACPI_RESOURCE_CACHE_SLOT_MAX = UACPI_RESOURCE_CACHE_SLOT_PRS,
+};
+
+/*
+ * Converted native resources of a device, see resources.c. The entries are
+ * only valid if 'generation' matches the global resource cache generation.
+ */
+struct uacpi_resource_cache {
+    struct uacpi_resources *entries[UACPI_RESOURCE_CACHE_SLOT_MAX + 1];
+    uacpi_u32 generation;
+
+    // Bumped every time this cache is invalidated
+    uacpi_u32 epoch;
+
+    // Indexed _PRT of a PCI root or bridge, see uacpi_get_pci_interrupt_route
+    struct uacpi_pci_routing *pci_routing;
+
+    /*
+     * Buffer object passed to the last _SRS of the device, reused by the next
+     * uacpi_set_resources call if AML didn't keep a reference to it.
+     */
+    uacpi_object *srs_template;
+};
+
+#define UACPI_DEVICE_PRESENCE_STA_VALID (1 << 0)
+#define UACPI_DEVICE_PRESENCE_IDENTITY_VALID (1 << 1)
+
+/*
+ * Last _STA and identity of a device as observed by namespace initialization
+ * or uacpi_rescan_devices, see utilities.c. Only accessed with the namespace
+ * write lock held once the namespace is initialized.
+ */
+struct uacpi_device_presence {
+    uacpi_u32 sta;
+    uacpi_u8 flags;
+
+    // Hash of _HID, _UID, _CID and _ADR
+    uacpi_u64 identity;
+};
+
 typedef struct uacpi_device {
     struct uacpi_shareable shareable;
     uacpi_address_space_handler *address_space_handlers;
     uacpi_device_notify_handler *notify_handlers;
+    struct uacpi_resource_cache resource_cache;
+    struct uacpi_device_presence presence;
 } uacpi_device;
 
 typedef struct uacpi_processor {
@@ -251,6 +334,9 @@ typedef struct uacpi_object {
     uacpi_u8 type;
     uacpi_u8 flags;
 
+    // The object is part of a packed allocation, see uacpi_object_try_pack
+    uacpi_u8 packed;
+
     union {
         uacpi_u64 integer;
         uacpi_package *package;
@@ -282,6 +368,81 @@ enum uacpi_assign_behavior {
 uacpi_status uacpi_object_assign(uacpi_object *dst, uacpi_object *src,
                                  enum uacpi_assign_behavior);
 
+/*
+ * Deep copies of strings, buffers and packages share the underlying storage
+ * until one of the owners attempts to modify it. Any code that is about to
+ * write to such storage in place, or create a long-lived alias of it, must
+ * call this first, which performs the actual copy if it's currently shared.
+ */
+enum uacpi_storage_access {
+    UACPI_STORAGE_ACCESS_WRITE,
+    UACPI_STORAGE_ACCESS_ALIAS,
+};
+
+uacpi_status uacpi_object_unshare(uacpi_object *obj,
+                                  enum uacpi_storage_access);
+
+/*
+ * Clear the aliased flag of the object's storage if the object is the only
+ * thing left that can reach it, i.e. all of the buffer fields and index
+ * objects referring to it are dead. This allows the storage to be shared with
+ * a copy instead of being duplicated. Only meant to be called on objects that
+ * are no longer reachable from AML.
+ */
+void uacpi_object_reclaim_storage(uacpi_object *obj);
+
+/*
+ * Move the contents of a package object into a single allocation holding
+ * every nested package, object and string/buffer payload, which is released
+ * as a whole once the last of its members dies. This is only done for
+ * packages that are exclusively owned by the object and only consist of
+ * plain data objects, the object is left untouched otherwise.
+ */
+void uacpi_object_try_pack(uacpi_object *obj);
+
+/*
+ * Allocate a payload of 'size' bytes for a buffer that doesn't have one yet,
+ * using the inline storage of the buffer if the payload fits. The contents
+ * are left uninitialized. Returns the new buf->data, or UACPI_NULL on failure.
+ */
+void *uacpi_buffer_alloc_data(uacpi_buffer *buf, uacpi_size size);
+
+/*
+ * Make room for at least 'size' bytes in the payload of a buffer, preserving
+ * its current contents. Growth is geometric, so that appending to the same
+ * buffer repeatedly doesn't end up copying it every time. The caller must
+ * have exclusive access to the storage. Returns the (possibly new) buf->data,
+ * or UACPI_NULL on failure, in which case the buffer is left untouched.
+ */
+void *uacpi_buffer_grow_data(uacpi_buffer *buf, uacpi_size size);
+
+// Release the payload allocated with uacpi_buffer_alloc_data, if any
+void uacpi_buffer_free_data(uacpi_buffer *buf);
+
+/*
+ * Immutable integer objects shared by the entire interpreter. They are never
+ * freed and reference counting them is a no-op, which means they can never
+ * be exclusively owned and must not be used as a store destination. Anything
+ * storing them somewhere makes a copy via uacpi_object_assign.
+ */
+enum uacpi_shared_constant {
+    UACPI_SHARED_CONSTANT_ZERO,
+    UACPI_SHARED_CONSTANT_ONE,
+
+    // All ones, truncated to 32 bits for revision 1 tables
+    UACPI_SHARED_CONSTANT_ONES,
+};
+
+uacpi_object *uacpi_shared_constant(enum uacpi_shared_constant constant);
+
+/*
+ * Replace the storage of a string or buffer object with the shared immutable
+ * empty string (of size 1) or empty buffer. Since the shared storage is never
+ * exclusively owned, any attempt to modify it via uacpi_object_unshare
+ * creates a private copy first.
+ */
+void uacpi_object_share_empty_storage(uacpi_object *obj);
+
 void uacpi_object_attach_child(uacpi_object *parent, uacpi_object *child);
 void uacpi_object_detach_child(uacpi_object *parent);
 
@@ -300,6 +461,42 @@ uacpi_bool uacpi_package_fill(
     enum uacpi_prealloc_objects prealloc_objects
 );
 
+// Same as uacpi_package_fill, but using the compact integer array storage
+uacpi_bool uacpi_package_fill_integers(
+    uacpi_package *pkg, uacpi_size num_elements
+);
+
+/*
+ * Convert a package using the compact integer array storage into the general
+ * form, where every element is a separate object. Must be done before
+ * accessing package->objects of a package that might be compact, or handing
+ * out references to its elements. No-op for packages in the general form.
+ *
+ * This changes the representation in place for anyone sharing the storage.
+ */
+uacpi_status uacpi_package_expand(uacpi_package *pkg);
+
+/*
+ * Same as uacpi_package_expand, but for use outside of the interpreter: the
+ * storage is unshared first so that AML which might be accessing it
+ * concurrently doesn't observe the change.
+ *
+ * Only the storage of 'obj' itself is unshared. Elements of a package are
+ * not copied along with it, so this must never be used on an element of
+ * another package, which might still be owned by the namespace. Use
+ * uacpi_package_element to read those instead.
+ */
+uacpi_status uacpi_object_expand_package(uacpi_object *obj);
+
+/*
+ * Returns the element at 'idx' of 'pkg' without modifying the package. For
+ * packages using the compact integer array storage the integer is stored in
+ * 'scratch', which is then returned instead. 'idx' must be in bounds.
+ */
+uacpi_object *uacpi_package_element(
+    uacpi_package *pkg, uacpi_size idx, uacpi_object *scratch
+);
+
 uacpi_mutex *uacpi_create_mutex(void);
 void uacpi_mutex_unref(uacpi_mutex*);
 
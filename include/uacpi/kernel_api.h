@@ -160,11 +160,13 @@ void uacpi_kernel_stall(uacpi_u8 usec);
  */
 void uacpi_kernel_sleep(uacpi_u64 msec);
 
+#ifndef UACPI_SINGLE_THREADED
 /*
  * Create/free an opaque non-recursive kernel mutex object.
  */
 uacpi_handle uacpi_kernel_create_mutex(void);
 void uacpi_kernel_free_mutex(uacpi_handle);
+#endif
 
 /*
  * Create/free an opaque kernel (semaphore-like) event object.
@@ -172,6 +174,7 @@ void uacpi_kernel_free_mutex(uacpi_handle);
 uacpi_handle uacpi_kernel_create_event(void);
 void uacpi_kernel_free_event(uacpi_handle);
 
+#ifndef UACPI_SINGLE_THREADED
 /*
  * Returns a unique identifier of the currently executing thread.
  *
@@ -197,6 +200,7 @@ uacpi_thread_id uacpi_kernel_get_thread_id(void);
  */
 uacpi_status uacpi_kernel_acquire_mutex(uacpi_handle, uacpi_u16);
 void uacpi_kernel_release_mutex(uacpi_handle);
+#endif
 
 /*
  * Try to wait for an event (counter > 0) with a millisecond timeout.
@@ -247,6 +251,7 @@ uacpi_status uacpi_kernel_uninstall_interrupt_handler(
     uacpi_interrupt_handler, uacpi_handle irq_handle
 );
 
+#ifndef UACPI_SINGLE_THREADED
 /*
  * Create/free a kernel spinlock object.
  *
@@ -266,6 +271,7 @@ void uacpi_kernel_free_spinlock(uacpi_handle);
  */
 uacpi_cpu_flags uacpi_kernel_lock_spinlock(uacpi_handle);
 void uacpi_kernel_unlock_spinlock(uacpi_handle, uacpi_cpu_flags);
+#endif
 
 typedef enum uacpi_work_type {
     /*
@@ -280,6 +286,20 @@ typedef enum uacpi_work_type {
      * This can run on any CPU.
      */
     UACPI_WORK_NOTIFICATION,
+
+    /*
+     * Schedule a part of a bigger operation that was split up to make use of
+     * multiple CPUs, e.g. uacpi_get_current_resources_bulk.
+     * This can run on any CPU.
+     */
+    UACPI_WORK_PARALLEL,
+
+    /*
+     * Schedule the namespace initialization started via
+     * uacpi_namespace_initialize_async for execution.
+     * This can run on any CPU.
+     */
+    UACPI_WORK_NAMESPACE_INITIALIZATION,
 } uacpi_work_type;
 
 typedef void (*uacpi_work_handler)(uacpi_handle);
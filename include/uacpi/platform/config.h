@@ -67,6 +67,28 @@ UACPI_BUILD_BUG_ON_WITH_MSG(
  */
 // #define UACPI_SIZED_FREES
 
+/*
+ * Assumes that uACPI is only ever called from a single thread of execution,
+ * e.g. early boot stages before other CPUs are brought up, or offline tools.
+ * All internal locking is compiled out and object reference counts are no
+ * longer updated atomically. The host doesn't have to implement the
+ * uacpi_kernel_*_mutex, uacpi_kernel_*_spinlock and uacpi_kernel_get_thread_id
+ * APIs in this mode.
+ *
+ * Note that the SCI handler is not synchronized against the rest of uACPI
+ * either, so the host must make sure it never runs concurrently with other
+ * uACPI API calls.
+ */
+// #define UACPI_SINGLE_THREADED
+
+/*
+ * Compiles every resource conversion program into a dedicated straight-line
+ * function instead of interpreting the instruction tables at runtime. This
+ * makes _CRS/_PRS/_SRS conversions faster at the cost of a larger binary,
+ * the instruction tables are still used as the single source of truth.
+ */
+// #define UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+
 /*
  * =========================
  * Platform-specific options
@@ -120,4 +142,19 @@ UACPI_BUILD_BUG_ON_WITH_MSG(
     "configured static table array length is too small (expecting at least 1)"
 );
 
+/*
+ * The size of the inline storage of string & buffer objects. Payloads that
+ * fit in this many bytes (including the null terminator for strings) are
+ * stored directly inside the buffer object instead of a separate heap
+ * allocation. Set to 0 to always allocate the payload separately.
+ */
+#ifndef UACPI_BUFFER_INLINE_STORAGE_SIZE
+    #define UACPI_BUFFER_INLINE_STORAGE_SIZE 16
+#endif
+
+UACPI_BUILD_BUG_ON_WITH_MSG(
+    UACPI_BUFFER_INLINE_STORAGE_SIZE < 0,
+    "configured buffer inline storage size is invalid"
+);
+
 #endif
@@ -664,11 +664,131 @@ uacpi_status uacpi_for_each_resource(
     uacpi_resources *resources, uacpi_resource_iteration_callback cb, void *user
 );
 
+/*
+ * Iterate the resources returned by 'method' of a device. For _CRS and _PRS
+ * the resources passed to the callback may be shared with other users and
+ * must not be modified.
+ */
 uacpi_status uacpi_for_each_device_resource(
     uacpi_namespace_node *device, const uacpi_char *method,
     uacpi_resource_iteration_callback cb, void *user
 );
 
+#define UACPI_RESOURCE_TYPE_BIT(type) (1ull << (type))
+
+/*
+ * Same as uacpi_for_each_device_resource, but only for resources whose
+ * UACPI_RESOURCE_TYPE_BIT is set in 'type_mask'. Those are converted one at a
+ * time into 'buffer', which must be pointer-aligned, right before 'cb' is
+ * invoked. No native resource list is allocated, the resource passed to 'cb'
+ * is only valid until the callback returns.
+ *
+ * UACPI_STATUS_INVALID_ARGUMENT is returned if a matching resource doesn't fit
+ * into 'buffer'.
+ */
+uacpi_status uacpi_for_each_device_resource_of_type(
+    uacpi_namespace_node *device, const uacpi_char *method,
+    uacpi_u64 type_mask, void *buffer, uacpi_size buffer_size,
+    uacpi_resource_iteration_callback cb, void *user
+);
+
+/*
+ * Converted _CRS and _PRS resources are cached per device. The cache is
+ * invalidated automatically whenever _SRS or _DIS of a device is invoked, on
+ * device/bus check notifications and on table loads.
+ *
+ * Drop the cached resources of 'device', or of every device if NULL. Useful
+ * if the host knows that resources changed behind the firmware's back.
+ */
+void uacpi_invalidate_resource_cache(uacpi_namespace_node *device);
+
+typedef struct uacpi_resource_cache_stats {
+    uacpi_u64 hits;
+
+    /*
+     * Uncached resources returned by uacpi_for_each_device_resource_of_type
+     * or uacpi_get_current_resources_bulk don't count as misses, as they're
+     * never cached.
+     */
+    uacpi_u64 misses;
+    uacpi_u64 invalidations;
+} uacpi_resource_cache_stats;
+
+void uacpi_get_resource_cache_stats(uacpi_resource_cache_stats *out_stats);
+
+typedef struct uacpi_device_resources {
+    uacpi_namespace_node *device;
+
+    // Status of the _CRS evaluation, 'resources' is only valid if this is OK
+    uacpi_status status;
+    uacpi_resources resources;
+} uacpi_device_resources;
+
+typedef struct uacpi_resource_set {
+    uacpi_size count;
+    uacpi_device_resources *devices;
+} uacpi_resource_set;
+
+/*
+ * Retrieve the current resources of every present device under 'parent' that
+ * has a _CRS, optionally filtered by 'hids' like uacpi_find_devices_at. Pass
+ * NULL as 'hids' to match any device. Devices are returned in namespace order.
+ *
+ * The resources of all devices are stored in a few shared buffers owned by the
+ * set, they must not be passed to uacpi_free_resources, free the entire set
+ * with uacpi_free_resource_set instead. Failing to retrieve the resources of
+ * a device only sets its 'status', the rest of the set is still valid. The set
+ * holds a reference to every 'device' node until it's freed.
+ *
+ * Cached resources are copied, the rest are converted without populating the
+ * cache. If 'num_workers' > 1 devices are split into as many chunks, which are
+ * processed via uacpi_kernel_schedule_work(UACPI_WORK_PARALLEL). This only
+ * waits for its own chunks, so it's safe to call from a work item, e.g. a
+ * notify handler. Note that _CRS evaluation is still serialized by the
+ * interpreter, only the conversion of the returned buffers runs in parallel.
+ */
+uacpi_status uacpi_get_current_resources_bulk(
+    uacpi_namespace_node *parent, const uacpi_char *const *hids,
+    uacpi_u32 num_workers, uacpi_resource_set **out_set
+);
+void uacpi_free_resource_set(uacpi_resource_set*);
+
+typedef struct uacpi_pci_interrupt_route {
+    /*
+     * The interrupt link device the pin is routed through, NULL if the pin is
+     * hardwired to 'gsi'.
+     */
+    uacpi_namespace_node *link;
+
+    /*
+     * Only valid if 'resolved' is set, a link device might not have an
+     * interrupt assigned to it, or its _CRS might not be usable.
+     */
+    uacpi_u32 gsi;
+    uacpi_u8 triggering;
+    uacpi_u8 polarity;
+    uacpi_u8 sharing;
+    uacpi_bool resolved;
+} uacpi_pci_interrupt_route;
+
+/*
+ * Look up where interrupt 'pin' (0 for INTA) of PCI device number 'device'
+ * behind 'bridge', a PCI root or bridge with a _PRT, is routed to.
+ *
+ * The _PRT of a bridge is only evaluated on the first lookup, and indexed by
+ * device and pin, the current interrupts of the link devices it references
+ * are resolved from their _CRS at the same time. Routes through a link device
+ * are resolved again after _SRS or _DIS of the link is invoked. The entire
+ * index is rebuilt whenever the resource cache of the bridge, or of all
+ * devices, is invalidated.
+ *
+ * Returns UACPI_STATUS_NOT_FOUND if the _PRT has no entry for the pin.
+ */
+uacpi_status uacpi_get_pci_interrupt_route(
+    uacpi_namespace_node *bridge, uacpi_u8 device, uacpi_u8 pin,
+    uacpi_pci_interrupt_route *out_route
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,6 +88,42 @@ uacpi_status uacpi_setup_early_table_access(
  */
 #define UACPI_FLAG_PROACTIVE_TBL_CSUM (1ull << 5)
 
+/*
+ * Initialize the subtrees of the devices under \_SB in parallel during
+ * uacpi_namespace_initialize. Each subtree is handed to the host via
+ * uacpi_kernel_schedule_work(UACPI_WORK_PARALLEL). Field accesses are
+ * serialized for the duration of the initialization, so an access from one
+ * partition never interleaves with one from another. AML execution itself is
+ * still serialized, so this only helps if _STA/_INI methods spend time
+ * sleeping or waiting. Ignored in UACPI_SINGLE_THREADED builds.
+ */
+#define UACPI_FLAG_PARALLEL_NAMESPACE_INIT (1ull << 6)
+
+/*
+ * Don't run _STA/_INI for every device during uacpi_namespace_initialize.
+ * Instead, a device along with its parents and everything below it is
+ * initialized on first use, that is uacpi_find_devices_at, uacpi_eval of
+ * anything inside of it, or an explicit uacpi_namespace_initialize_subtree.
+ */
+#define UACPI_FLAG_LAZY_NAMESPACE_INIT (1ull << 7)
+
+/*
+ * Don't run _REG for every operation region controlled by a global address
+ * space handler during uacpi_namespace_initialize. Instead, run it for all
+ * regions of a scope and the scopes above it right before the first method
+ * inside of that scope executes, parents first like during the eager walk.
+ * A region accessed directly from another scope before that is connected
+ * right before the access. AML reading a variable set by another scope's
+ * _REG without calling a method of that scope won't see it set.
+ */
+#define UACPI_FLAG_LAZY_REG (1ull << 8)
+
+/*
+ * Record a timeline of the initialization phases up until the end of
+ * uacpi_namespace_initialize, see uacpi_get_boot_timeline.
+ */
+#define UACPI_FLAG_BOOT_TIMELINE (1ull << 9)
+
 /*
  * Initializes the uACPI subsystem, iterates & records all relevant RSDT/XSDT
  * tables. Enters ACPI mode.
@@ -108,6 +144,149 @@ uacpi_status uacpi_namespace_load(void);
  */
 uacpi_status uacpi_namespace_initialize(void);
 
+typedef enum uacpi_init_stage {
+    UACPI_INIT_STAGE_NONE = 0,
+
+    // All definition blocks have been loaded, see uacpi_namespace_load
+    UACPI_INIT_STAGE_TABLES_LOADED = 1,
+
+    // \_INI and \_SB._INI have been executed
+    UACPI_INIT_STAGE_ROOT_INI_DONE = 2,
+
+    // _REG has been run for all globally installed address space handlers
+    UACPI_INIT_STAGE_REG_DONE = 3,
+
+    // _STA/_INI have been run for all devices, same as NAMESPACE_INITIALIZED
+    UACPI_INIT_STAGE_DEVICES_INITIALIZED = 4,
+} uacpi_init_stage;
+
+/*
+ * Same as calling uacpi_namespace_load (unless the namespace is already
+ * loaded) followed by uacpi_namespace_initialize, except that this is done
+ * asynchronously via uacpi_kernel_schedule_work, letting the caller continue
+ * doing other work in the meantime. Use the API below to find out when a
+ * certain stage of the initialization is reached.
+ *
+ * Note that address space handlers which are expected to be available for
+ * _REG/_INI must be installed before calling this.
+ */
+uacpi_status uacpi_namespace_initialize_async(void);
+
+// Returns the last reached namespace initialization stage
+uacpi_init_stage uacpi_get_current_init_stage(void);
+
+/*
+ * Returns UACPI_TRUE if _STA/_INI have been run for 'node' and every device
+ * below it, at which point it's safe to start probing drivers for it.
+ * 'node' is expected to be a device, processor or thermal zone, for other
+ * nodes this only becomes true once the entire namespace is initialized.
+ */
+uacpi_bool uacpi_is_subtree_initialized(uacpi_namespace_node *node);
+
+/*
+ * Wait for the asynchronous initialization to reach 'stage' or for the
+ * subtree of 'node' to be initialized respectively, with a millisecond
+ * timeout (0xFFFF meaning infinite wait).
+ *
+ * Returns UACPI_STATUS_TIMEOUT if the timeout expired, the error status if
+ * the initialization has failed, or UACPI_STATUS_INIT_LEVEL_MISMATCH if no
+ * asynchronous initialization is in progress that could still reach it.
+ */
+uacpi_status uacpi_wait_for_init_stage(
+    uacpi_init_stage stage, uacpi_u16 timeout
+);
+uacpi_status uacpi_wait_for_subtree_initialization(
+    uacpi_namespace_node *node, uacpi_u16 timeout
+);
+
+/*
+ * Run _STA/_INI for 'node', all of its parents and everything below it,
+ * unless that has already been done. Each _INI is executed at most once.
+ *
+ * This is only useful with UACPI_FLAG_LAZY_NAMESPACE_INIT, otherwise the
+ * entire namespace is already initialized by uacpi_namespace_initialize.
+ */
+uacpi_status uacpi_namespace_initialize_subtree(uacpi_namespace_node *node);
+
+typedef enum uacpi_timeline_event {
+    // Mapping and validation of the RSDP
+    UACPI_TIMELINE_EVENT_RSDP_PARSE = 0,
+
+    /*
+     * Parsing of the XSDT/RSDT ('signature') and installation of all tables
+     * it refers to, 'count' is the number of entries.
+     */
+    UACPI_TIMELINE_EVENT_RXSDT_PARSE = 1,
+
+    // Installation of table 'signature', including checksum verification
+    UACPI_TIMELINE_EVENT_TABLE_INSTALL = 2,
+
+    // Execution of the definition block 'signature'
+    UACPI_TIMELINE_EVENT_TABLE_LOAD = 3,
+
+    // _REG for all regions of address space 'space' with a global handler
+    UACPI_TIMELINE_EVENT_REG = 4,
+
+    // Evaluation of _STA of 'node', 'count' is the returned value
+    UACPI_TIMELINE_EVENT_STA = 5,
+
+    // Evaluation of _INI of 'node'
+    UACPI_TIMELINE_EVENT_INI = 6,
+
+    /*
+     * Matching of GPE methods for the GPE block of 'node', 'count' is the
+     * number of matched methods.
+     */
+    UACPI_TIMELINE_EVENT_GPE_MATCH = 7,
+} uacpi_timeline_event;
+
+const uacpi_char *uacpi_timeline_event_to_string(uacpi_timeline_event);
+
+typedef struct uacpi_timeline_record {
+    uacpi_timeline_event event;
+    uacpi_status status;
+
+    uacpi_u64 begin_ns;
+    uacpi_u64 end_ns;
+
+    /*
+     * Number of AML opcodes executed and AML objects or namespace nodes
+     * allocated during the event. These are approximate if AML is executed
+     * by multiple threads at the same time, e.g. with
+     * UACPI_FLAG_PARALLEL_NAMESPACE_INIT.
+     */
+    uacpi_u64 ops;
+    uacpi_u64 allocations;
+
+    // Event-specific counter, see uacpi_timeline_event
+    uacpi_u64 count;
+
+    // The subject of the event, only one of these is set depending on 'event'
+    uacpi_object_name signature;
+    uacpi_address_space space;
+    uacpi_namespace_node *node;
+} uacpi_timeline_record;
+
+typedef struct uacpi_boot_timeline {
+    uacpi_size count;
+    uacpi_timeline_record *records;
+} uacpi_boot_timeline;
+
+/*
+ * Retrieve a copy of the boot timeline recorded with UACPI_FLAG_BOOT_TIMELINE.
+ * Records are in the order the respective events have completed in, so an
+ * event always comes after everything that happened during it.
+ *
+ * The RSDP/XSDT parse records are also available if tables were set up via
+ * uacpi_setup_early_table_access, tables installed at that point are not
+ * recorded individually however.
+ *
+ * The returned timeline holds a reference to every node in it and must be
+ * freed via uacpi_free_boot_timeline.
+ */
+uacpi_status uacpi_get_boot_timeline(uacpi_boot_timeline **out_timeline);
+void uacpi_free_boot_timeline(uacpi_boot_timeline*);
+
 // Returns the current subsystem initialization level
 uacpi_init_level uacpi_get_current_init_level(void);
 
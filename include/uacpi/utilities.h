@@ -179,6 +179,104 @@ uacpi_status uacpi_get_namespace_node_info(
     uacpi_namespace_node *node, uacpi_namespace_node_info **out_info
 );
 
+typedef struct uacpi_device_info_snapshot_entry {
+    uacpi_namespace_node *node;
+
+    /*
+     * Result of evaluating _STA, 0 if that failed. Only evaluated for devices
+     * and processors, always 0xFFFFFFFF for any other object type.
+     */
+    uacpi_u32 sta;
+
+    // Same as returned by uacpi_get_namespace_node_info
+    uacpi_namespace_node_info *info;
+} uacpi_device_info_snapshot_entry;
+
+typedef struct uacpi_device_info_snapshot {
+    /*
+     * Namespace generation at the time of the snapshot. Pass this as
+     * 'since_generation' to a later call to only retrieve the nodes that
+     * might have changed since.
+     */
+    uacpi_u32 generation;
+
+    uacpi_size count;
+    uacpi_device_info_snapshot_entry *entries;
+
+    // Size of the entire snapshot, including all entries and their info
+    uacpi_size size;
+} uacpi_device_info_snapshot;
+
+/*
+ * Retrieve the _STA and the node information (see
+ * uacpi_get_namespace_node_info) of every node under 'parent' matching
+ * 'type_mask', e.g. UACPI_OBJECT_DEVICE_BIT. Nodes are returned in namespace
+ * order, and all of the information is stored in one allocation owned by the
+ * snapshot, free it with uacpi_free_device_info_snapshot.
+ *
+ * Nodes are collected in one namespace walk, after which all of the AML is
+ * executed with the namespace write lock acquired only once, instead of once
+ * per evaluated object.
+ *
+ * If 'since_generation' is not 0, only the nodes that were installed, had one
+ * of their _XXX objects (e.g. _HID or _STA) installed or removed, or received
+ * a bus/device check notification after the snapshot with that generation was
+ * taken are returned. Removed nodes are not reported.
+ */
+uacpi_status uacpi_get_device_info_snapshot(
+    uacpi_namespace_node *parent, uacpi_object_type_bits type_mask,
+    uacpi_u32 since_generation, uacpi_device_info_snapshot **out_snapshot
+);
+void uacpi_free_device_info_snapshot(uacpi_device_info_snapshot*);
+
+typedef enum uacpi_device_change_kind {
+    // The device is now present or functioning, but wasn't before
+    UACPI_DEVICE_CHANGE_ADDED,
+
+    // The device (or one of its parents) is no longer present nor functioning
+    UACPI_DEVICE_CHANGE_REMOVED,
+
+    // The device is still there, but its _STA or _HID/_UID/_CID/_ADR changed
+    UACPI_DEVICE_CHANGE_CHANGED,
+} uacpi_device_change_kind;
+
+const uacpi_char *uacpi_device_change_kind_to_string(uacpi_device_change_kind);
+
+typedef struct uacpi_device_change {
+    uacpi_namespace_node *node;
+    uacpi_device_change_kind kind;
+
+    // 0 if the previous _STA of the device is unknown
+    uacpi_u32 old_sta;
+    uacpi_u32 new_sta;
+} uacpi_device_change;
+
+typedef struct uacpi_device_change_list {
+    uacpi_size count;
+    uacpi_device_change changes[];
+} uacpi_device_change_list;
+
+/*
+ * Re-evaluate the presence of 'node' and every device below it, typically in
+ * response to a Notify(node, 0/1), and diff it against the state last observed
+ * by uACPI. The observed state is seeded by namespace initialization, and
+ * updated by every call to this function. Changes are returned in namespace
+ * order via 'out_list', which must be freed with uacpi_free_device_change_list.
+ *
+ * _HID, _UID, _CID and _ADR are only evaluated for devices that are present,
+ * and compared against the values recorded by a previous call. Namespace
+ * initialization doesn't record these, so the first call reports every device
+ * that is still present as changed. Devices below a device that is not present
+ * are not evaluated at all, and are reported as removed if they were present
+ * before. A present device with no previously observed state (e.g. one below a
+ * device that wasn't present during namespace initialization) is reported as
+ * added.
+ */
+uacpi_status uacpi_rescan_devices(
+    uacpi_namespace_node *node, uacpi_device_change_list **out_list
+);
+void uacpi_free_device_change_list(uacpi_device_change_list*);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,8 @@
 #include <uacpi/internal/interpreter.h>
 #include <uacpi/internal/notify.h>
 #include <uacpi/internal/utilities.h>
+#include <uacpi/internal/mutex.h>
+#include <uacpi/internal/timeline.h>
 #include <uacpi/acpi.h>
 
 #define UACPI_EVENT_DISABLED 0
@@ -875,6 +877,7 @@ static uacpi_status create_gpe_block(
 {
     uacpi_status ret = UACPI_STATUS_OUT_OF_MEMORY;
     struct gpe_match_ctx match_ctx = { 0 };
+    uacpi_timeline_record rec;
     struct gpe_block *block;
     struct gpe_register *reg;
     struct gp_event *event;
@@ -946,12 +949,18 @@ static uacpi_status create_gpe_block(
     block->irq_ctx->gpe_head = block;
     match_ctx.block = block;
 
+    uacpi_timeline_begin(&rec, UACPI_TIMELINE_EVENT_GPE_MATCH);
+    rec.node = device_node;
+
     uacpi_namespace_do_for_each_child(
         device_node, do_match_gpe_methods, UACPI_NULL,
         UACPI_OBJECT_METHOD_BIT, UACPI_MAX_DEPTH_ANY,
         UACPI_SHOULD_LOCK_YES, UACPI_PERMANENT_ONLY_YES, &match_ctx
     );
 
+    rec.count = match_ctx.matched_count;
+    uacpi_timeline_end(&rec, UACPI_STATUS_OK);
+
     uacpi_trace("initialized GPE block %.4s[%d->%d], %d AML handlers (IRQ %d)\n",
                 device_node->name.text, base_idx, base_idx + block->num_events,
                 match_ctx.matched_count, irq);
@@ -1752,7 +1761,7 @@ static uacpi_interrupt_ret handle_global_lock(uacpi_handle ctx)
         return UACPI_INTERRUPT_HANDLED;
     }
 
-    flags = uacpi_kernel_lock_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
+    flags = uacpi_lock_native_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
     if (!g_uacpi_rt_ctx.global_lock_pending) {
         uacpi_trace("spurious firmware global lock release notification\n");
         goto out;
@@ -1764,7 +1773,7 @@ static uacpi_interrupt_ret handle_global_lock(uacpi_handle ctx)
     g_uacpi_rt_ctx.global_lock_pending = UACPI_FALSE;
 
 out:
-    uacpi_kernel_unlock_spinlock(g_uacpi_rt_ctx.global_lock_spinlock, flags);
+    uacpi_unlock_native_spinlock(g_uacpi_rt_ctx.global_lock_spinlock, flags);
     return UACPI_INTERRUPT_HANDLED;
 }
 
@@ -1809,7 +1818,7 @@ uacpi_status uacpi_initialize_events(void)
     if (uacpi_unlikely(g_uacpi_rt_ctx.global_lock_event == UACPI_NULL))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
-    g_uacpi_rt_ctx.global_lock_spinlock = uacpi_kernel_create_spinlock();
+    g_uacpi_rt_ctx.global_lock_spinlock = uacpi_create_native_spinlock();
     if (uacpi_unlikely(g_uacpi_rt_ctx.global_lock_spinlock == UACPI_NULL))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
@@ -18,4 +18,5 @@ uacpi_add_sources(
     event.c
     mutex.c
     osi.c
+    timeline.c
 )
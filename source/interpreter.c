@@ -277,6 +277,13 @@ struct call_frame {
 
     struct uacpi_namespace_node *cur_scope;
 
+    /*
+     * The object passed to Return and where it should be stored, the store is
+     * performed after this frame is torn down, see ctx_reload_post_ret.
+     */
+    uacpi_object *ret_src;
+    uacpi_object *ret_dst;
+
     // Only used if the method is serialized
     uacpi_u8 prev_sync_level;
 };
@@ -721,8 +728,7 @@ static uacpi_status handle_buffer(struct execution_context *ctx)
     }
 
     dst = item_array_at(&op_ctx->items, 3)->obj;
-    dst->buffer->data = uacpi_kernel_alloc(buffer_size);
-    if (uacpi_unlikely(dst->buffer->data == UACPI_NULL))
+    if (uacpi_unlikely(!uacpi_buffer_alloc_data(dst->buffer, buffer_size)))
         return UACPI_STATUS_OUT_OF_MEMORY;
     dst->buffer->size = buffer_size;
 
@@ -748,8 +754,7 @@ uacpi_status handle_string(struct execution_context *ctx)
     if (uacpi_unlikely((length == max_bytes) || (string[length++] != 0x00)))
         return UACPI_STATUS_AML_BAD_ENCODING;
 
-    obj->buffer->text = uacpi_kernel_alloc(length);
-    if (uacpi_unlikely(obj->buffer->text == UACPI_NULL))
+    if (uacpi_unlikely(!uacpi_buffer_alloc_data(obj->buffer, length)))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
     uacpi_memcpy(obj->buffer->text, string, length);
@@ -758,6 +763,64 @@ uacpi_status handle_string(struct execution_context *ctx)
     return UACPI_STATUS_OK;
 }
 
+static uacpi_object *package_initializer_as_integer(
+    struct op_context *op_ctx, uacpi_u32 idx
+)
+{
+    uacpi_object *obj;
+
+    obj = item_array_at(&op_ctx->items, (idx * 2) + 3)->obj;
+    if (obj == UACPI_NULL)
+        return UACPI_NULL;
+
+    // Named references are converted to path strings, see handle_package
+    if (obj->type == UACPI_OBJECT_REFERENCE &&
+        obj->flags == UACPI_REFERENCE_KIND_NAMED)
+        return UACPI_NULL;
+
+    obj = uacpi_unwrap_internal_reference(obj);
+    if (obj->type != UACPI_OBJECT_INTEGER)
+        return UACPI_NULL;
+
+    return obj;
+}
+
+static uacpi_bool package_is_integer_array(
+    struct op_context *op_ctx, uacpi_u32 num_elements,
+    uacpi_u32 num_defined_elements
+)
+{
+    uacpi_u32 i;
+
+    if (num_elements == 0 || num_defined_elements != num_elements)
+        return UACPI_FALSE;
+
+    for (i = 0; i < num_elements; ++i) {
+        if (package_initializer_as_integer(op_ctx, i) == UACPI_NULL)
+            return UACPI_FALSE;
+    }
+
+    return UACPI_TRUE;
+}
+
+static uacpi_status fill_integer_package(
+    struct op_context *op_ctx, uacpi_package *package, uacpi_u32 num_elements
+)
+{
+    uacpi_u32 i;
+
+    if (uacpi_unlikely(!uacpi_package_fill_integers(package, num_elements)))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    for (i = 0; i < num_elements; ++i) {
+        package->integers[i] = package_initializer_as_integer(
+            op_ctx, i
+        )->integer;
+    }
+
+    return UACPI_STATUS_OK;
+}
+
 static uacpi_status handle_package(struct execution_context *ctx)
 {
     struct op_context *op_ctx = ctx->cur_op_ctx;
@@ -800,6 +863,13 @@ static uacpi_status handle_package(struct execution_context *ctx)
         num_defined_elements = num_elements;
     }
 
+    /*
+     * Packages that are fully initialized with integers only (e.g. _PSS/_CST
+     * entries or lookup tables) are stored as a flat integer array instead.
+     */
+    if (package_is_integer_array(op_ctx, num_elements, num_defined_elements))
+        return fill_integer_package(op_ctx, package, num_elements);
+
     // 2. Create every object in the package, start as uninitialized
     if (uacpi_unlikely(!uacpi_package_fill(package, num_elements,
                                            UACPI_PREALLOC_OBJECTS_YES)))
@@ -962,6 +1032,10 @@ static uacpi_status object_assign_with_implicit_cast(uacpi_object *dst,
     case UACPI_OBJECT_BUFFER: {
         struct object_storage_as_buffer dst_buf;
 
+        ret = uacpi_object_unshare(dst, UACPI_STORAGE_ACCESS_WRITE);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+
         ret = get_object_storage(dst, &dst_buf, UACPI_FALSE);
         if (uacpi_unlikely_error(ret))
             goto out_bad_cast;
@@ -1275,6 +1349,8 @@ static uacpi_status do_load_table(
     if (uacpi_unlikely_error(ret))
         return ret;
 
+    uacpi_resource_cache_invalidate_all();
+
     if (is_dynamic_table_load(cause))
         ret = uacpi_events_match_post_dynamic_table_load();
 
@@ -1320,6 +1396,7 @@ static uacpi_status handle_load_table(struct execution_context *ctx)
             return UACPI_STATUS_OK;
         }
 
+        uacpi_resource_cache_invalidate_all();
         uacpi_events_match_post_dynamic_table_load();
         return UACPI_STATUS_OK;
     }
@@ -1411,8 +1488,10 @@ static uacpi_status handle_load(struct execution_context *ctx)
      * We do this only if table load was successful though.
      */
     if (item_array_size(items) == 5) {
-        if (item_array_at(items, 4)->obj->integer != 0)
+        if (item_array_at(items, 4)->obj->integer != 0) {
+            uacpi_resource_cache_invalidate_all();
             uacpi_events_match_post_dynamic_table_load();
+        }
         return UACPI_STATUS_OK;
     }
 
@@ -2141,7 +2220,18 @@ static uacpi_status debug_store(uacpi_object *src)
         uacpi_size i;
 
         for (i = 0; i < pkg->count; ++i) {
-            uacpi_object *obj = pkg->objects[i];
+            uacpi_object *obj;
+            uacpi_object tmp_obj = {
+                .type = UACPI_OBJECT_INTEGER,
+            };
+
+            if (pkg->flags & UACPI_STORAGE_INTEGER_ARRAY) {
+                tmp_obj.integer = pkg->integers[i];
+                debug_store_no_recurse("Element:", &tmp_obj);
+                continue;
+            }
+
+            obj = pkg->objects[i];
             if (obj->type == UACPI_OBJECT_REFERENCE &&
                 obj->flags == UACPI_REFERENCE_KIND_PKG_INDEX)
                 obj = obj->inner_object;
@@ -2524,6 +2614,48 @@ static uacpi_status ensure_valid_idx(uacpi_object *obj, uacpi_size idx,
     return UACPI_STATUS_AML_OUT_OF_BOUNDS_INDEX;
 }
 
+/*
+ * DerefOf(Index(Pkg, X)) is the most common way to read package elements, in
+ * that case the index object is only used to fetch the value and then thrown
+ * away, so there's no need to expand an integer array package for it.
+ */
+static uacpi_bool index_is_read_only(struct execution_context *ctx)
+{
+    struct op_context *op_ctx = ctx->cur_op_ctx;
+    uacpi_object *target;
+
+    if (ctx->prev_op_ctx == UACPI_NULL ||
+        ctx->prev_op_ctx->op->code != UACPI_AML_OP_DerefOfOp)
+        return UACPI_FALSE;
+
+    // Anything other than a NULL target keeps the index object alive
+    target = item_array_at(&op_ctx->items, 2)->obj;
+    return target->type == UACPI_OBJECT_INTEGER;
+}
+
+static uacpi_status index_integer_array(
+    uacpi_package *pkg, uacpi_size idx, struct item *dst
+)
+{
+    uacpi_object *obj;
+
+    obj = uacpi_create_object(UACPI_OBJECT_INTEGER);
+    if (uacpi_unlikely(obj == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+    obj->integer = pkg->integers[idx];
+
+    dst->obj = uacpi_create_internal_reference(
+        UACPI_REFERENCE_KIND_PKG_INDEX, obj
+    );
+    uacpi_object_unref(obj);
+
+    if (uacpi_unlikely(dst->obj == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    dst->type = ITEM_OBJECT;
+    return UACPI_STATUS_OK;
+}
+
 static uacpi_status handle_index(struct execution_context *ctx)
 {
     uacpi_status ret;
@@ -2536,6 +2668,24 @@ static uacpi_status handle_index(struct execution_context *ctx)
     idx = item_array_at(&op_ctx->items, 1)->obj->integer;
     dst = item_array_at(&op_ctx->items, 3);
 
+    if (src->type == UACPI_OBJECT_PACKAGE &&
+        (src->package->flags & UACPI_STORAGE_INTEGER_ARRAY) &&
+        index_is_read_only(ctx)) {
+        ret = ensure_valid_idx(src, idx, src->package->count);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+
+        return index_integer_array(src->package, idx, dst);
+    }
+
+    /*
+     * The index object allows writing to the source in place, so it must not
+     * share storage with anyone else from this point on.
+     */
+    ret = uacpi_object_unshare(src, UACPI_STORAGE_ACCESS_ALIAS);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
     switch (src->type) {
     case UACPI_OBJECT_BUFFER:
     case UACPI_OBJECT_STRING: {
@@ -2567,6 +2717,11 @@ static uacpi_status handle_index(struct execution_context *ctx)
         if (uacpi_unlikely_error(ret))
             return ret;
 
+        // The index object must be able to reference the element itself
+        ret = uacpi_package_expand(pkg);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+
         /*
          * Lazily transform the package element into an internal reference
          * to itself of type PKG_INDEX. This is needed to support stuff like
@@ -2656,8 +2811,7 @@ static uacpi_status integer_to_string(
     // 0x prefix + repr + \0
     final_size = (is_hex ? 2 : 0) + repr_len + 1;
 
-    str->data = uacpi_kernel_alloc(final_size);
-    if (uacpi_unlikely(str->data == UACPI_NULL))
+    if (uacpi_unlikely(!uacpi_buffer_alloc_data(str, final_size)))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
     if (is_hex) {
@@ -2702,10 +2856,10 @@ static uacpi_status buffer_to_string(
     // Null terminator
     final_size += 1;
 
-    str->data = uacpi_kernel_alloc(final_size);
-    if (uacpi_unlikely(str->data == UACPI_NULL))
+    if (uacpi_unlikely(!uacpi_buffer_alloc_data(str, final_size)))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
+    str->size = final_size;
     cursor = str->data;
 
     for (i = 0; i < buf->size; ++i) {
@@ -2715,8 +2869,7 @@ static uacpi_status buffer_to_string(
             ((uacpi_u8*)buf->data)[i]
         );
         if (uacpi_unlikely(repr_len < 0)) {
-            uacpi_free(str->data, final_size);
-            str->data = UACPI_NULL;
+            uacpi_buffer_free_data(str);
             return UACPI_STATUS_INVALID_ARGUMENT;
         }
 
@@ -2727,36 +2880,34 @@ static uacpi_status buffer_to_string(
             *cursor++ = ',';
     }
 
-    str->size = final_size;
     return UACPI_STATUS_OK;
 }
 
-static uacpi_status do_make_empty_object(uacpi_buffer *buf,
-                                         uacpi_bool is_string)
+static uacpi_status do_make_empty_object(uacpi_object *obj,
+                                         uacpi_object_type type)
 {
-    buf->text = uacpi_kernel_calloc(1, sizeof(uacpi_char));
-    if (uacpi_unlikely(buf->text == UACPI_NULL))
-        return UACPI_STATUS_OUT_OF_MEMORY;
-
-    if (is_string)
-        buf->size = sizeof(uacpi_char);
-
+    /*
+     * Empty strings & buffers are extremely common, so instead of allocating
+     * a new one every time just point at the shared immutable storage, it
+     * will be copied on the first attempt to modify it.
+     */
+    obj->type = type;
+    uacpi_object_share_empty_storage(obj);
     return UACPI_STATUS_OK;
 }
 
-static uacpi_status make_null_string(uacpi_buffer *buf)
+static uacpi_status make_null_string(uacpi_object *obj)
 {
-    return do_make_empty_object(buf, UACPI_TRUE);
+    return do_make_empty_object(obj, UACPI_OBJECT_STRING);
 }
 
-static uacpi_status make_null_buffer(uacpi_buffer *buf)
+static uacpi_status make_null_buffer(uacpi_object *obj)
 {
     /*
-     * Allocate at least 1 byte just to be safe,
-     * even for empty buffers. We still set the
-     * size to 0 though.
+     * The shared empty buffer still has a valid data pointer to at least
+     * 1 byte just to be safe, we still set the size to 0 though.
      */
-    return do_make_empty_object(buf, UACPI_FALSE);
+    return do_make_empty_object(obj, UACPI_OBJECT_BUFFER);
 }
 
 static uacpi_status handle_to(struct execution_context *ctx)
@@ -2783,7 +2934,7 @@ static uacpi_status handle_to(struct execution_context *ctx)
             break;
         } else if (src->type == UACPI_OBJECT_BUFFER) {
             if (uacpi_unlikely(src->buffer->size == 0))
-                return make_null_string(dst->buffer);
+                return make_null_string(dst);
 
             ret = buffer_to_string(src->buffer, dst->buffer, is_hex);
             break;
@@ -2799,14 +2950,13 @@ static uacpi_status handle_to(struct execution_context *ctx)
             return ret;
 
         if (uacpi_unlikely(buf.len == 0))
-            return make_null_buffer(dst->buffer);
+            return make_null_buffer(dst);
 
-        dst_buf = uacpi_kernel_alloc(buf.len);
+        dst_buf = uacpi_buffer_alloc_data(dst->buffer, buf.len);
         if (uacpi_unlikely(dst_buf == UACPI_NULL))
             return UACPI_STATUS_OUT_OF_MEMORY;
 
         uacpi_memcpy(dst_buf, buf.ptr, buf.len);
-        dst->buffer->data = dst_buf;
         dst->buffer->size = buf.len;
         break;
     }
@@ -2821,21 +2971,22 @@ static uacpi_status handle_to(struct execution_context *ctx)
 static uacpi_status handle_to_string(struct execution_context *ctx)
 {
     struct op_context *op_ctx = ctx->cur_op_ctx;
+    uacpi_object *dst;
     uacpi_buffer *src_buf, *dst_buf;
     uacpi_size req_len, len;
 
     src_buf = item_array_at(&op_ctx->items, 0)->obj->buffer;
     req_len = item_array_at(&op_ctx->items, 1)->obj->integer;
-    dst_buf = item_array_at(&op_ctx->items, 3)->obj->buffer;
+    dst = item_array_at(&op_ctx->items, 3)->obj;
+    dst_buf = dst->buffer;
 
     len = UACPI_MIN(req_len, src_buf->size);
     if (uacpi_unlikely(len == 0))
-        return make_null_string(dst_buf);
+        return make_null_string(dst);
 
     len = uacpi_strnlen(src_buf->text, len);
 
-    dst_buf->text = uacpi_kernel_alloc(len + 1);
-    if (uacpi_unlikely(dst_buf->text == UACPI_NULL))
+    if (uacpi_unlikely(!uacpi_buffer_alloc_data(dst_buf, len + 1)))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
     uacpi_memcpy(dst_buf->text, src_buf->data, len);
@@ -2873,19 +3024,16 @@ static uacpi_status handle_mid(struct execution_context *ctx)
     get_object_storage(src, &src_buf, UACPI_FALSE);
 
     if (uacpi_unlikely(src_buf.len == 0 || idx >= src_buf.len || len == 0)) {
-        if (src->type == UACPI_OBJECT_STRING) {
-            dst->type = UACPI_OBJECT_STRING;
-            return make_null_string(dst_buf);
-        }
+        if (src->type == UACPI_OBJECT_STRING)
+            return make_null_string(dst);
 
-        return make_null_buffer(dst_buf);
+        return make_null_buffer(dst);
     }
 
     // Guaranteed to be at least 1 here
     len = UACPI_MIN(len, src_buf.len - idx);
 
-    dst_buf->data = uacpi_kernel_alloc(len + is_string);
-    if (uacpi_unlikely(dst_buf->data == UACPI_NULL))
+    if (uacpi_unlikely(!uacpi_buffer_alloc_data(dst_buf, len + is_string)))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
     uacpi_memcpy(dst_buf->data, (uacpi_u8*)src_buf.ptr + idx, len);
@@ -2899,6 +3047,65 @@ static uacpi_status handle_mid(struct execution_context *ctx)
     return UACPI_STATUS_OK;
 }
 
+/*
+ * Concatenate(Local0, X, Local0) is the usual way to build a buffer in a
+ * loop. If the first operand is only reachable via the target local, which is
+ * about to be overwritten with the result anyway, its storage can be appended
+ * to in place instead of being copied every time.
+ */
+static uacpi_bool can_append_in_place(struct op_context *op_ctx)
+{
+    uacpi_object *arg0, *target;
+    uacpi_buffer *buf;
+
+    arg0 = item_array_at(&op_ctx->items, 0)->obj;
+    target = item_array_at(&op_ctx->items, 2)->obj;
+
+    if (target->type != UACPI_OBJECT_REFERENCE ||
+        target->flags != UACPI_REFERENCE_KIND_LOCAL ||
+        target->inner_object != arg0)
+        return UACPI_FALSE;
+
+    /*
+     * The local is referenced by the frame and the target item, the object
+     * itself additionally by the operand item. Anything above that means
+     * someone did a RefOf or otherwise still holds on to the old value.
+     */
+    if (uacpi_shareable_refcount(target) != 2 ||
+        uacpi_shareable_refcount(arg0) != 3)
+        return UACPI_FALSE;
+
+    buf = arg0->buffer;
+    return uacpi_shareable_refcount(buf) == 1 &&
+           !(buf->flags & (UACPI_STORAGE_ALIASED | UACPI_STORAGE_PACKED));
+}
+
+/*
+ * Allocate the result of a concatenation. If *in_place is set on return, the
+ * result shares the storage of the first operand, which already contains its
+ * data at the start.
+ */
+static uacpi_u8 *concatenate_prepare_dst(
+    struct op_context *op_ctx, uacpi_size size, uacpi_bool *in_place
+)
+{
+    uacpi_object *arg0, *dst;
+
+    arg0 = item_array_at(&op_ctx->items, 0)->obj;
+    dst = item_array_at(&op_ctx->items, 3)->obj;
+
+    *in_place = can_append_in_place(op_ctx);
+    if (!*in_place)
+        return uacpi_buffer_alloc_data(dst->buffer, size);
+
+    if (uacpi_unlikely(uacpi_buffer_grow_data(arg0->buffer, size) == UACPI_NULL))
+        return UACPI_NULL;
+
+    // This can't fail as the storage is not aliased and is simply shared
+    uacpi_object_assign(dst, arg0, UACPI_ASSIGN_BEHAVIOR_DEEP_COPY);
+    return dst->buffer->data;
+}
+
 static uacpi_status handle_concatenate(struct execution_context *ctx)
 {
     uacpi_status ret = UACPI_STATUS_OK;
@@ -2906,6 +3113,7 @@ static uacpi_status handle_concatenate(struct execution_context *ctx)
     uacpi_object *arg0, *arg1, *dst;
     uacpi_u8 *dst_buf;
     uacpi_size buf_size = 0;
+    uacpi_bool in_place;
 
     arg0 = item_array_at(&op_ctx->items, 0)->obj;
     arg1 = item_array_at(&op_ctx->items, 1)->obj;
@@ -2919,7 +3127,7 @@ static uacpi_status handle_concatenate(struct execution_context *ctx)
         int_size = sizeof_int();
         buf_size = int_size * 2;
 
-        dst_buf = uacpi_kernel_alloc(buf_size);
+        dst_buf = uacpi_buffer_alloc_data(dst->buffer, buf_size);
         if (uacpi_unlikely(dst_buf == UACPI_NULL))
             return UACPI_STATUS_OUT_OF_MEMORY;
 
@@ -2936,11 +3144,12 @@ static uacpi_status handle_concatenate(struct execution_context *ctx)
         get_object_storage(arg1, &arg1_buf, UACPI_TRUE);
         buf_size = arg0_buf->size + arg1_buf.len;
 
-        dst_buf = uacpi_kernel_alloc(buf_size);
+        dst_buf = concatenate_prepare_dst(op_ctx, buf_size, &in_place);
         if (uacpi_unlikely(dst_buf == UACPI_NULL))
             return UACPI_STATUS_OUT_OF_MEMORY;
 
-        uacpi_memcpy(dst_buf, arg0_buf->data, arg0_buf->size);
+        if (!in_place)
+            uacpi_memcpy(dst_buf, arg0_buf->data, arg0_buf->size);
         uacpi_memcpy(dst_buf + arg0_buf->size, arg1_buf.ptr, arg1_buf.len);
         break;
     }
@@ -2949,6 +3158,7 @@ static uacpi_status handle_concatenate(struct execution_context *ctx)
         void *arg1_ptr;
         uacpi_size arg0_size, arg1_size;
         uacpi_buffer *arg0_buf = arg0->buffer;
+        uacpi_buffer tmp_buf = { 0 };
 
         switch (arg1->type) {
         case UACPI_OBJECT_INTEGER: {
@@ -2966,9 +3176,7 @@ static uacpi_status handle_concatenate(struct execution_context *ctx)
             arg1_ptr = arg1->buffer->data;
             arg1_size = arg1->buffer->size;
             break;
-        case UACPI_OBJECT_BUFFER: {
-            uacpi_buffer tmp_buf;
-
+        case UACPI_OBJECT_BUFFER:
             ret = buffer_to_string(arg1->buffer, &tmp_buf, UACPI_TRUE);
             if (uacpi_unlikely_error(ret))
                 return ret;
@@ -2976,7 +3184,6 @@ static uacpi_status handle_concatenate(struct execution_context *ctx)
             arg1_ptr = tmp_buf.data;
             arg1_size = tmp_buf.size;
             break;
-        }
         default:
             return UACPI_STATUS_INVALID_ARGUMENT;
         }
@@ -2984,29 +3191,27 @@ static uacpi_status handle_concatenate(struct execution_context *ctx)
         arg0_size = arg0_buf->size ? arg0_buf->size - 1 : arg0_buf->size;
         buf_size = arg0_size + arg1_size;
 
-        dst_buf = uacpi_kernel_alloc(buf_size);
+        dst_buf = concatenate_prepare_dst(op_ctx, buf_size, &in_place);
         if (uacpi_unlikely(dst_buf == UACPI_NULL)) {
             ret = UACPI_STATUS_OUT_OF_MEMORY;
             goto cleanup;
         }
 
-        uacpi_memcpy(dst_buf, arg0_buf->data, arg0_size);
+        if (!in_place)
+            uacpi_memcpy(dst_buf, arg0_buf->data, arg0_size);
         uacpi_memcpy(dst_buf + arg0_size, arg1_ptr, arg1_size);
         dst->type = UACPI_OBJECT_STRING;
 
     cleanup:
-        if (arg1->type == UACPI_OBJECT_BUFFER)
-            uacpi_free(arg1_ptr, arg1_size);
+        uacpi_buffer_free_data(&tmp_buf);
         break;
     }
     default:
         return UACPI_STATUS_INVALID_ARGUMENT;
     }
 
-    if (uacpi_likely_success(ret)) {
-        dst->buffer->data = dst_buf;
+    if (uacpi_likely_success(ret))
         dst->buffer->size = buf_size;
-    }
     return ret;
 }
 
@@ -3017,6 +3222,7 @@ static uacpi_status handle_concatenate_res(struct execution_context *ctx)
     uacpi_object *arg0, *arg1, *dst;
     uacpi_u8 *dst_buf;
     uacpi_size dst_size, arg0_size, arg1_size;
+    uacpi_bool in_place;
 
     arg0 = item_array_at(&op_ctx->items, 0)->obj;
     arg1 = item_array_at(&op_ctx->items, 1)->obj;
@@ -3032,14 +3238,14 @@ static uacpi_status handle_concatenate_res(struct execution_context *ctx)
 
     dst_size = arg0_size + arg1_size + sizeof(struct acpi_resource_end_tag);
 
-    dst_buf = uacpi_kernel_alloc(dst_size);
+    dst_buf = concatenate_prepare_dst(op_ctx, dst_size, &in_place);
     if (uacpi_unlikely(dst_buf == UACPI_NULL))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
-    dst->buffer->data = dst_buf;
     dst->buffer->size = dst_size;
 
-    uacpi_memcpy(dst_buf, arg0->buffer->data, arg0_size);
+    if (!in_place)
+        uacpi_memcpy(dst_buf, arg0->buffer->data, arg0_size);
     uacpi_memcpy(dst_buf + arg0_size, arg1->buffer->data, arg1_size);
 
     /*
@@ -3310,31 +3516,81 @@ enum match_op {
     MGT = 5,
 };
 
-static uacpi_bool match_one(enum match_op op, uacpi_u64 lhs, uacpi_u64 rhs)
+/*
+ * Every match predicate selects a contiguous range of values, so does the
+ * conjunction of two of them. Returns UACPI_FALSE if the range is empty.
+ */
+static uacpi_bool match_op_to_range(
+    enum match_op op, uacpi_u64 operand, uacpi_u64 *lo, uacpi_u64 *hi
+)
 {
     switch (op) {
     case MTR:
         return UACPI_TRUE;
     case MEQ:
-        return lhs == rhs;
+        *lo = UACPI_MAX(*lo, operand);
+        *hi = UACPI_MIN(*hi, operand);
+        break;
     case MLE:
-        return lhs <= rhs;
+        *hi = UACPI_MIN(*hi, operand);
+        break;
     case MLT:
-        return lhs < rhs;
+        if (operand == 0)
+            return UACPI_FALSE;
+        *hi = UACPI_MIN(*hi, operand - 1);
+        break;
     case MGE:
-        return lhs >= rhs;
+        *lo = UACPI_MAX(*lo, operand);
+        break;
     case MGT:
-        return lhs > rhs;
+        if (operand == 0xFFFFFFFFFFFFFFFF)
+            return UACPI_FALSE;
+        *lo = UACPI_MAX(*lo, operand + 1);
+        break;
     default:
         return UACPI_FALSE;
     }
+
+    return *lo <= *hi;
+}
+
+/*
+ * A value is within [lo, lo + span] if value - lo <= span, which is a single
+ * branchless compare. Integer-only packages are scanned in fixed-size blocks
+ * so that the inner loop can be vectorized by the compiler.
+ */
+#define MATCH_BLOCK_SIZE 8
+
+static uacpi_size match_integer_array(
+    const uacpi_u64 *values, uacpi_size start, uacpi_size count,
+    uacpi_u64 lo, uacpi_u64 span
+)
+{
+    uacpi_size i, j;
+
+    for (i = start; i + MATCH_BLOCK_SIZE <= count; i += MATCH_BLOCK_SIZE) {
+        uacpi_u8 hit = 0;
+
+        for (j = 0; j < MATCH_BLOCK_SIZE; ++j)
+            hit |= (values[i + j] - lo) <= span;
+
+        if (hit)
+            break;
+    }
+
+    for (; i < count; ++i) {
+        if ((values[i] - lo) <= span)
+            break;
+    }
+
+    return i;
 }
 
 static uacpi_status handle_match(struct execution_context *ctx)
 {
     struct op_context *op_ctx = ctx->cur_op_ctx;
     uacpi_package *pkg;
-    uacpi_u64 operand0, operand1, start_idx, i;
+    uacpi_u64 operand0, operand1, start_idx, lo, hi, span, i;
     enum match_op mop0, mop1;
     uacpi_object *dst;
 
@@ -3346,15 +3602,29 @@ static uacpi_status handle_match(struct execution_context *ctx)
     start_idx = item_array_at(&op_ctx->items, 5)->obj->integer;
     dst = item_array_at(&op_ctx->items, 6)->obj;
 
-    for (i = start_idx; i < pkg->count; ++i) {
-        uacpi_object *obj = pkg->objects[i];
+    lo = 0;
+    hi = 0xFFFFFFFFFFFFFFFF;
 
-        if (obj->type != UACPI_OBJECT_INTEGER)
-            continue;
+    if (start_idx >= pkg->count ||
+        !match_op_to_range(mop0, operand0, &lo, &hi) ||
+        !match_op_to_range(mop1, operand1, &lo, &hi)) {
+        dst->integer = ones();
+        return UACPI_STATUS_OK;
+    }
+    span = hi - lo;
 
-        if (match_one(mop0, obj->integer, operand0) &&
-            match_one(mop1, obj->integer, operand1))
-            break;
+    if (pkg->flags & UACPI_STORAGE_INTEGER_ARRAY) {
+        i = match_integer_array(pkg->integers, start_idx, pkg->count, lo, span);
+    } else {
+        for (i = start_idx; i < pkg->count; ++i) {
+            uacpi_object *obj = pkg->objects[i];
+
+            if (obj->type != UACPI_OBJECT_INTEGER)
+                continue;
+
+            if ((obj->integer - lo) <= span)
+                break;
+        }
     }
 
     if (i < pkg->count)
@@ -3795,11 +4065,11 @@ static uacpi_status handle_field_read(struct execution_context *ctx)
         buf = dst_obj->buffer;
         dst_size = field_byte_size(src_obj);
 
-        dst = uacpi_kernel_calloc(dst_size, 1);
+        dst = uacpi_buffer_alloc_data(buf, dst_size);
         if (dst == UACPI_NULL)
             return UACPI_STATUS_OUT_OF_MEMORY;
 
-        buf->data = dst;
+        uacpi_memzero(dst, dst_size);
         buf->size = dst_size;
     } else {
         dst = &dst_obj->integer;
@@ -3819,8 +4089,9 @@ static uacpi_status handle_create_buffer_field(struct execution_context *ctx)
     struct op_context *op_ctx = ctx->cur_op_ctx;
     struct uacpi_namespace_node *node;
     uacpi_buffer *src_buf;
-    uacpi_object *field_obj;
+    uacpi_object *src_obj, *field_obj;
     uacpi_buffer_field *field;
+    uacpi_status ret;
 
     /*
      * Layout of items here:
@@ -3830,7 +4101,13 @@ static uacpi_status handle_create_buffer_field(struct execution_context *ctx)
      * [3] (2 if not CreateField) -> the new namespace node
      * [4] (3 if not CreateField) -> the buffer field object we're creating here
      */
-    src_buf = item_array_at(&op_ctx->items, 0)->obj->buffer;
+    src_obj = item_array_at(&op_ctx->items, 0)->obj;
+
+    ret = uacpi_object_unshare(src_obj, UACPI_STORAGE_ACCESS_ALIAS);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    src_buf = src_obj->buffer;
 
     if (op_ctx->op->code == UACPI_AML_OP_CreateFieldOp) {
         uacpi_object *idx_obj, *len_obj;
@@ -4020,9 +4297,10 @@ static uacpi_status handle_code_block(struct execution_context *ctx)
 static uacpi_status handle_return(struct execution_context *ctx)
 {
     uacpi_status ret;
+    struct call_frame *frame = ctx->cur_frame;
     uacpi_object *dst = UACPI_NULL;
 
-    ctx->cur_frame->code_offset = ctx->cur_frame->method->size;
+    frame->code_offset = frame->method->size;
     ret = method_get_ret_object(ctx, &dst);
 
     if (uacpi_unlikely_error(ret))
@@ -4031,15 +4309,26 @@ static uacpi_status handle_return(struct execution_context *ctx)
         return UACPI_STATUS_OK;
 
     /*
-     * Should be possible to move here if method returns a literal
-     * like Return(Buffer { ... }), otherwise we have to copy just to
-     * be safe.
+     * Don't copy the object right away, if it's a temporary or only reachable
+     * via this method's locals and named objects, it can be handed over to
+     * the caller as is once those are gone.
      */
-    return uacpi_object_assign(
-        dst,
-        item_array_at(&ctx->cur_op_ctx->items, 0)->obj,
-        UACPI_ASSIGN_BEHAVIOR_DEEP_COPY
-    );
+    frame->ret_src = item_array_at(&ctx->cur_op_ctx->items, 0)->obj;
+    frame->ret_dst = dst;
+    uacpi_object_ref(frame->ret_src);
+    return UACPI_STATUS_OK;
+}
+
+static uacpi_status store_return_value(uacpi_object *dst, uacpi_object *src)
+{
+    /*
+     * Nothing but us is holding the object at this point, so no one would be
+     * able to observe the storage being shared with the caller.
+     */
+    if (uacpi_shareable_refcount(src) == 1)
+        uacpi_object_reclaim_storage(src);
+
+    return uacpi_object_assign(dst, src, UACPI_ASSIGN_BEHAVIOR_DEEP_COPY);
 }
 
 static void refresh_ctx_pointers(struct execution_context *ctx)
@@ -4413,6 +4702,7 @@ static void call_frame_clear(struct call_frame *frame)
     for (i = 0; i < 8; ++i)
         uacpi_object_unref(frame->locals[i]);
 
+    uacpi_object_unref(frame->ret_src);
     uacpi_method_unref(frame->method);
 }
 
@@ -4442,6 +4732,7 @@ static uacpi_u8 parse_op_generates_item[0x100] = {
     [UACPI_PARSE_OP_LOAD_IMM_AS_OBJECT] = ITEM_OBJECT,
     [UACPI_PARSE_OP_LOAD_FALSE_OBJECT] = ITEM_OBJECT,
     [UACPI_PARSE_OP_LOAD_TRUE_OBJECT] = ITEM_OBJECT,
+    [UACPI_PARSE_OP_LOAD_SHARED_CONSTANT] = ITEM_OBJECT,
     [UACPI_PARSE_OP_OBJECT_ALLOC] = ITEM_OBJECT,
     [UACPI_PARSE_OP_OBJECT_ALLOC_TYPED] = ITEM_OBJECT,
     [UACPI_PARSE_OP_EMPTY_OBJECT_ALLOC] = ITEM_EMPTY_OBJECT,
@@ -4986,6 +5277,24 @@ enum method_call_type {
     METHOD_CALL_TABLE_LOAD,
 };
 
+/*
+ * Connect the regions of the scope of a method before it runs, as AML commonly
+ * checks a flag set by _REG instead of touching the region itself. This runs
+ * AML, so the object of 'node' must be looked up again afterwards.
+ */
+static uacpi_status lazy_reg_before_call(uacpi_namespace_node *node)
+{
+    if (uacpi_likely(!g_uacpi_rt_ctx.lazy_reg_active))
+        return UACPI_STATUS_OK;
+
+    uacpi_opregion_lazy_reg_scope(node);
+
+    if (uacpi_unlikely(uacpi_namespace_node_is_dangling(node)))
+        return UACPI_STATUS_NAMESPACE_NODE_DANGLING;
+
+    return UACPI_STATUS_OK;
+}
+
 static uacpi_status prepare_method_call(
     struct execution_context *ctx, uacpi_namespace_node *node,
     uacpi_control_method *method, enum method_call_type type,
@@ -5003,6 +5312,9 @@ static uacpi_status prepare_method_call(
     if (uacpi_unlikely_error(ret))
         return ret;
 
+    if (type != METHOD_CALL_TABLE_LOAD)
+        uacpi_resource_cache_on_method_call(node);
+
     ret = enter_method(ctx, frame, method);
     if (uacpi_unlikely_error(ret))
         goto method_dispatch_error;
@@ -5113,7 +5425,9 @@ static uacpi_status exec_op(struct execution_context *ctx)
                 return UACPI_STATUS_OUT_OF_MEMORY;
 
             item->type = parse_op_generates_item[op];
-            if (item->type == ITEM_OBJECT) {
+            if (op == UACPI_PARSE_OP_LOAD_SHARED_CONSTANT) {
+                item->obj = uacpi_shared_constant(op_decode_byte(op_ctx));
+            } else if (item->type == ITEM_OBJECT) {
                 enum uacpi_object_type type = UACPI_OBJECT_UNINITIALIZED;
 
                 if (op == UACPI_PARSE_OP_OBJECT_ALLOC_TYPED)
@@ -5239,6 +5553,9 @@ static uacpi_status exec_op(struct execution_context *ctx)
             break;
         }
 
+        case UACPI_PARSE_OP_LOAD_SHARED_CONSTANT:
+            break;
+
         case UACPI_PARSE_OP_RECORD_AML_PC:
             item->immediate = frame->code_offset;
             break;
@@ -5521,9 +5838,20 @@ static uacpi_status exec_op(struct execution_context *ctx)
         case UACPI_PARSE_OP_DISPATCH_METHOD_CALL: {
             struct uacpi_namespace_node *node;
             struct uacpi_control_method *method;
+            uacpi_object *obj;
 
             node = item_array_at(&op_ctx->items, 0)->node;
-            method = uacpi_namespace_node_get_object(node)->method;
+
+            ret = lazy_reg_before_call(node);
+            if (uacpi_unlikely_error(ret))
+                return ret;
+
+            obj = uacpi_namespace_node_get_object_typed(
+                node, UACPI_OBJECT_METHOD_BIT
+            );
+            if (uacpi_unlikely(obj == UACPI_NULL))
+                return UACPI_STATUS_AML_INCOMPATIBLE_OBJECT_TYPE;
+            method = obj->method;
 
             ret = prepare_method_call(
                 ctx, node, method, METHOD_CALL_AML, UACPI_NULL
@@ -5611,9 +5939,11 @@ static uacpi_status exec_op(struct execution_context *ctx)
     }
 }
 
-static void ctx_reload_post_ret(struct execution_context *ctx)
+static uacpi_status ctx_reload_post_ret(struct execution_context *ctx)
 {
+    uacpi_status ret = UACPI_STATUS_OK;
     uacpi_control_method *method = ctx->cur_frame->method;
+    uacpi_object *ret_src, *ret_dst;
 
     if (method->is_serialized) {
         held_mutexes_array_remove_and_release(
@@ -5622,11 +5952,22 @@ static void ctx_reload_post_ret(struct execution_context *ctx)
         ctx->sync_level = ctx->cur_frame->prev_sync_level;
     }
 
+    ret_src = ctx->cur_frame->ret_src;
+    ret_dst = ctx->cur_frame->ret_dst;
+    ctx->cur_frame->ret_src = UACPI_NULL;
+
     call_frame_clear(ctx->cur_frame);
     call_frame_array_pop(&ctx->call_stack);
 
     ctx->cur_frame = call_frame_array_last(&ctx->call_stack);
     refresh_ctx_pointers(ctx);
+
+    if (ret_src != UACPI_NULL) {
+        ret = store_return_value(ret_dst, ret_src);
+        uacpi_object_unref(ret_src);
+    }
+
+    return ret;
 }
 
 static void trace_method_abort(struct code_block *block, uacpi_size depth)
@@ -5728,6 +6069,11 @@ uacpi_status uacpi_execute_control_method(
         }
     }
 
+    // The caller holds a reference to 'method', so it can't go away here
+    ret = lazy_reg_before_call(scope);
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
     ret = prepare_method_call(ctx, scope, method, METHOD_CALL_NATIVE, args);
     if (uacpi_unlikely_error(ret))
         goto out;
@@ -5741,7 +6087,14 @@ uacpi_status uacpi_execute_control_method(
                 continue;
 
             if (!call_frame_has_code(ctx->cur_frame)) {
-                ctx_reload_post_ret(ctx);
+                ret = ctx_reload_post_ret(ctx);
+                if (uacpi_unlikely_error(ret)) {
+                    // Failed to return a value from the outermost method
+                    if (ctx->cur_frame == UACPI_NULL)
+                        break;
+
+                    goto handle_method_abort;
+                }
                 continue;
             }
 
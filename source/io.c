@@ -43,52 +43,144 @@ static uacpi_size bit_span_offset(struct bit_span *span, uacpi_size bits)
     return delta;
 }
 
+/*
+ * Copy 'count' bits a byte at a time, never touching any bytes outside of the
+ * source and destination bit ranges.
+ */
+static void bit_copy_bytewise(
+    uacpi_u8 *dst_ptr, uacpi_u8 dst_shift,
+    const uacpi_u8 *src_ptr, uacpi_u8 src_shift, uacpi_u64 count
+)
+{
+    uacpi_u16 bits, dst_mask;
+    uacpi_u8 chunk;
+
+    while (count) {
+        chunk = count < 8 ? count : 8;
+
+        bits = *src_ptr >> src_shift;
+        if (src_shift && chunk > 8 - src_shift)
+            bits |= *(src_ptr + 1) << (8 - src_shift);
+        bits &= (1 << chunk) - 1;
+
+        dst_mask = ((1 << chunk) - 1) << dst_shift;
+        *dst_ptr = (*dst_ptr & ~dst_mask) | ((bits << dst_shift) & dst_mask);
+
+        if (dst_shift && chunk > 8 - dst_shift) {
+            dst_mask >>= 8;
+            *(dst_ptr + 1) &= ~dst_mask;
+            *(dst_ptr + 1) |= (bits >> (8 - dst_shift)) & dst_mask;
+        }
+
+        count -= chunk;
+        src_ptr++;
+        dst_ptr++;
+    }
+}
+
+/*
+ * AML buffers are little-endian bit streams, these compile down to plain
+ * unaligned 64-bit loads and stores on little-endian targets.
+ */
+static uacpi_u64 load_le64(const uacpi_u8 *ptr)
+{
+    return (uacpi_u64)ptr[0]       | (uacpi_u64)ptr[1] << 8  |
+           (uacpi_u64)ptr[2] << 16 | (uacpi_u64)ptr[3] << 24 |
+           (uacpi_u64)ptr[4] << 32 | (uacpi_u64)ptr[5] << 40 |
+           (uacpi_u64)ptr[6] << 48 | (uacpi_u64)ptr[7] << 56;
+}
+
+static void store_le64(uacpi_u8 *ptr, uacpi_u64 value)
+{
+    ptr[0] = value;
+    ptr[1] = value >> 8;
+    ptr[2] = value >> 16;
+    ptr[3] = value >> 24;
+    ptr[4] = value >> 32;
+    ptr[5] = value >> 40;
+    ptr[6] = value >> 48;
+    ptr[7] = value >> 56;
+}
+
+static void bit_zero(uacpi_u8 *dst_ptr, uacpi_u8 dst_shift, uacpi_u64 count)
+{
+    uacpi_u8 chunk;
+
+    if (dst_shift) {
+        chunk = UACPI_MIN(count, (uacpi_u64)(8 - dst_shift));
+        *dst_ptr++ &= ~(((1 << chunk) - 1) << dst_shift);
+        count -= chunk;
+    }
+
+    uacpi_memzero(dst_ptr, count / 8);
+    dst_ptr += count / 8;
+
+    if (count & 7)
+        *dst_ptr &= ~((1 << (count & 7)) - 1);
+}
+
+/*
+ * Copy src->length bits into dst, zero-extending (or truncating) to
+ * dst->length bits.
+ */
 static void bit_copy(struct bit_span *dst, struct bit_span *src)
 {
-    uacpi_u8 src_shift, dst_shift, bits = 0;
-    uacpi_u16 dst_mask;
-    uacpi_u8 *dst_ptr, *src_ptr;
-    uacpi_u64 dst_count, src_count;
+    uacpi_u8 src_shift, dst_shift, head;
+    uacpi_u8 *dst_ptr;
+    const uacpi_u8 *src_ptr;
+    uacpi_u64 count, word;
 
     dst_ptr = dst->data + (dst->index / 8);
-    src_ptr = src->data + (src->index / 8);
+    src_ptr = src->const_data + (src->index / 8);
 
-    dst_count = dst->length;
     dst_shift = dst->index & 7;
-
-    src_count = src->length;
     src_shift = src->index & 7;
 
-    while (dst_count)
-    {
-        bits = 0;
-
-        if (src_count) {
-            bits = *src_ptr >> src_shift;
+    count = UACPI_MIN(dst->length, src->length);
 
-            if (src_shift && src_count > (uacpi_u32)(8 - src_shift))
-                bits |= *(src_ptr + 1) << (8 - src_shift);
+    // Bring the destination to a byte boundary
+    if (dst_shift) {
+        head = UACPI_MIN(count, (uacpi_u64)(8 - dst_shift));
+        bit_copy_bytewise(dst_ptr, dst_shift, src_ptr, src_shift, head);
+        count -= head;
 
-            if (src_count < 8) {
-                bits &= (1 << src_count) - 1;
-                src_count = 0;
-            } else {
-                src_count -= 8;
-                src_ptr++;
-            }
+        if (count) {
+            dst_ptr++;
+            dst_shift = 0;
+            src_ptr += (src_shift + head) / 8;
+            src_shift = (src_shift + head) & 7;
         }
+    }
 
-        dst_mask = (dst_count < 8 ? (1 << dst_count) - 1 : 0xFF) << dst_shift;
-        *dst_ptr = (*dst_ptr & ~dst_mask) | ((bits << dst_shift) & dst_mask);
-
-        if (dst_shift && dst_count > (uacpi_u32)(8 - dst_shift)) {
-            dst_mask >>= 8;
-            *(dst_ptr + 1) &= ~dst_mask;
-            *(dst_ptr + 1) |= (bits >> (8 - dst_shift)) & dst_mask;
+    if (dst_shift == 0 && src_shift == 0) {
+        uacpi_memcpy(dst_ptr, src_ptr, count / 8);
+        dst_ptr += count / 8;
+        src_ptr += count / 8;
+        count &= 7;
+    } else if (dst_shift == 0) {
+        /*
+         * Since src_shift is not 0, 64 bits span 9 source bytes, all of which
+         * are within the source range as long as there are at least 64 bits
+         * left to copy.
+         */
+        while (count >= 64) {
+            word = load_le64(src_ptr) >> src_shift;
+            word |= (uacpi_u64)src_ptr[8] << (64 - src_shift);
+            store_le64(dst_ptr, word);
+
+            dst_ptr += 8;
+            src_ptr += 8;
+            count -= 64;
         }
+    }
+
+    bit_copy_bytewise(dst_ptr, dst_shift, src_ptr, src_shift, count);
 
-        dst_count = dst_count > 8 ? dst_count - 8 : 0;
-        ++dst_ptr;
+    if (dst->length > src->length) {
+        count = dst->index + src->length;
+        bit_zero(
+            dst->data + (count / 8), count & 7, dst->length - src->length
+        );
     }
 }
 
@@ -370,7 +462,52 @@ static uacpi_status do_read_misaligned_field_unit(
     return UACPI_STATUS_OK;
 }
 
-uacpi_status uacpi_read_field_unit(
+/*
+ * While the namespace is initialized in parallel, AML from different
+ * partitions interleaves at every region access because the namespace lock
+ * is dropped around handler calls. Hold the init-wide region mutex around
+ * each field access as a whole, so that multi-access sequences like those of
+ * an IndexField or a BankField can't corrupt each other. The global lock is
+ * taken beforehand if the field requires it, so that the two are always
+ * acquired in the same order. Both are recursive, which covers the nested
+ * accesses to the index, data and bank selection fields.
+ */
+static uacpi_status field_access_begin(uacpi_field_unit *field)
+{
+    uacpi_status ret;
+    uacpi_mutex *region_mutex = g_uacpi_rt_ctx.parallel_init_region_mutex;
+
+    if (region_mutex == UACPI_NULL)
+        return UACPI_STATUS_OK;
+
+    if (field->lock_rule) {
+        ret = uacpi_acquire_aml_mutex(
+            g_uacpi_rt_ctx.global_lock_mutex, 0xFFFF
+        );
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    }
+
+    ret = uacpi_acquire_aml_mutex(region_mutex, 0xFFFF);
+    if (uacpi_unlikely_error(ret) && field->lock_rule)
+        uacpi_release_aml_mutex(g_uacpi_rt_ctx.global_lock_mutex);
+
+    return ret;
+}
+
+static void field_access_end(uacpi_field_unit *field)
+{
+    uacpi_mutex *region_mutex = g_uacpi_rt_ctx.parallel_init_region_mutex;
+
+    if (region_mutex == UACPI_NULL)
+        return;
+
+    uacpi_release_aml_mutex(region_mutex);
+    if (field->lock_rule)
+        uacpi_release_aml_mutex(g_uacpi_rt_ctx.global_lock_mutex);
+}
+
+static uacpi_status read_field_unit(
     uacpi_field_unit *field, void *dst, uacpi_size size
 )
 {
@@ -407,7 +544,22 @@ uacpi_status uacpi_read_field_unit(
     return do_read_misaligned_field_unit(field, dst, size);
 }
 
-uacpi_status uacpi_write_field_unit(
+uacpi_status uacpi_read_field_unit(
+    uacpi_field_unit *field, void *dst, uacpi_size size
+)
+{
+    uacpi_status ret;
+
+    ret = field_access_begin(field);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    ret = read_field_unit(field, dst, size);
+    field_access_end(field);
+    return ret;
+}
+
+static uacpi_status write_field_unit(
     uacpi_field_unit *field, const void *src, uacpi_size size
 )
 {
@@ -472,6 +624,21 @@ uacpi_status uacpi_write_field_unit(
     return UACPI_STATUS_OK;
 }
 
+uacpi_status uacpi_write_field_unit(
+    uacpi_field_unit *field, const void *src, uacpi_size size
+)
+{
+    uacpi_status ret;
+
+    ret = field_access_begin(field);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    ret = write_field_unit(field, src, size);
+    field_access_end(field);
+    return ret;
+}
+
 static uacpi_u8 gas_get_access_bit_width(const struct acpi_gas *gas)
 {
     /*
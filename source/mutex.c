@@ -59,7 +59,7 @@ static uacpi_status uacpi_acquire_global_lock_from_firmware(void)
     if (!g_uacpi_rt_ctx.has_global_lock)
         return UACPI_STATUS_OK;
 
-    flags = uacpi_kernel_lock_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
+    flags = uacpi_lock_native_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
     for (;;) {
         spins++;
         uacpi_trace(
@@ -81,14 +81,14 @@ static uacpi_status uacpi_acquire_global_lock_from_firmware(void)
             "global lock is owned by firmware, waiting for a release "
             "notification...\n"
         );
-        uacpi_kernel_unlock_spinlock(g_uacpi_rt_ctx.global_lock_spinlock, flags);
+        uacpi_unlock_native_spinlock(g_uacpi_rt_ctx.global_lock_spinlock, flags);
 
         uacpi_kernel_wait_for_event(g_uacpi_rt_ctx.global_lock_event, 0xFFFF);
-        flags = uacpi_kernel_lock_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
+        flags = uacpi_lock_native_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
     }
 
     g_uacpi_rt_ctx.global_lock_pending = UACPI_FALSE;
-    uacpi_kernel_unlock_spinlock(g_uacpi_rt_ctx.global_lock_spinlock, flags);
+    uacpi_unlock_native_spinlock(g_uacpi_rt_ctx.global_lock_spinlock, flags);
 
     if (uacpi_unlikely(!success)) {
         uacpi_error("unable to acquire global lock after %u attempts\n", spins);
@@ -121,6 +121,7 @@ UACPI_STUB_IF_REDUCED_HARDWARE(
     void uacpi_release_global_lock_to_firmware(void)
 )
 
+#ifndef UACPI_SINGLE_THREADED
 uacpi_status uacpi_acquire_native_mutex_with_timeout(
     uacpi_handle mtx, uacpi_u16 timeout
 )
@@ -143,6 +144,7 @@ uacpi_status uacpi_acquire_native_mutex_with_timeout(
 
     return ret;
 }
+#endif
 
 uacpi_status uacpi_acquire_global_lock(uacpi_u16 timeout, uacpi_u32 *out_seq)
 {
@@ -193,7 +195,7 @@ uacpi_bool uacpi_this_thread_owns_aml_mutex(uacpi_mutex *mutex)
     uacpi_thread_id id;
 
     id = UACPI_ATOMIC_LOAD_THREAD_ID(&mutex->owner);
-    return id == uacpi_kernel_get_thread_id();
+    return id == uacpi_current_thread_id();
 }
 
 uacpi_status uacpi_acquire_aml_mutex(uacpi_mutex *mutex, uacpi_u16 timeout)
@@ -201,7 +203,7 @@ uacpi_status uacpi_acquire_aml_mutex(uacpi_mutex *mutex, uacpi_u16 timeout)
     uacpi_thread_id this_id;
     uacpi_status ret = UACPI_STATUS_OK;
 
-    this_id = uacpi_kernel_get_thread_id();
+    this_id = uacpi_current_thread_id();
     if (UACPI_ATOMIC_LOAD_THREAD_ID(&mutex->owner) == this_id) {
         if (uacpi_unlikely(mutex->depth == 0xFFFF)) {
             uacpi_warn(
@@ -250,15 +252,16 @@ uacpi_status uacpi_release_aml_mutex(uacpi_mutex *mutex)
     return UACPI_STATUS_OK;
 }
 
+#ifndef UACPI_SINGLE_THREADED
 uacpi_status uacpi_rw_lock_init(struct uacpi_rw_lock *lock)
 {
-    lock->read_mutex = uacpi_kernel_create_mutex();
+    lock->read_mutex = uacpi_create_native_mutex();
     if (uacpi_unlikely(lock->read_mutex == UACPI_NULL))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
-    lock->write_mutex = uacpi_kernel_create_mutex();
+    lock->write_mutex = uacpi_create_native_mutex();
     if (uacpi_unlikely(lock->write_mutex == UACPI_NULL)) {
-        uacpi_kernel_free_mutex(lock->read_mutex);
+        uacpi_free_native_mutex(lock->read_mutex);
         lock->read_mutex = UACPI_NULL;
         return UACPI_STATUS_OUT_OF_MEMORY;
     }
@@ -276,11 +279,11 @@ uacpi_status uacpi_rw_lock_deinit(struct uacpi_rw_lock *lock)
     }
 
     if (lock->read_mutex != UACPI_NULL) {
-        uacpi_kernel_free_mutex(lock->read_mutex);
+        uacpi_free_native_mutex(lock->read_mutex);
         lock->read_mutex = UACPI_NULL;
     }
     if (lock->write_mutex != UACPI_NULL) {
-        uacpi_kernel_free_mutex(lock->write_mutex);
+        uacpi_free_native_mutex(lock->write_mutex);
         lock->write_mutex = UACPI_NULL;
     }
 
@@ -301,7 +304,7 @@ uacpi_status uacpi_rw_lock_read(struct uacpi_rw_lock *lock)
             lock->num_readers = 0;
     }
 
-    uacpi_kernel_release_mutex(lock->read_mutex);
+    uacpi_release_native_mutex(lock->read_mutex);
     return ret;
 }
 
@@ -316,7 +319,7 @@ uacpi_status uacpi_rw_unlock_read(struct uacpi_rw_lock *lock)
     if (lock->num_readers-- == 1)
         uacpi_release_native_mutex(lock->write_mutex);
 
-    uacpi_kernel_release_mutex(lock->read_mutex);
+    uacpi_release_native_mutex(lock->read_mutex);
     return ret;
 }
 
@@ -329,3 +332,4 @@ uacpi_status uacpi_rw_unlock_write(struct uacpi_rw_lock *lock)
 {
     return uacpi_release_native_mutex(lock->write_mutex);
 }
+#endif
@@ -7,7 +7,9 @@
 #include <uacpi/internal/log.h>
 #include <uacpi/internal/utilities.h>
 #include <uacpi/internal/mutex.h>
+#include <uacpi/internal/timeline.h>
 #include <uacpi/kernel_api.h>
+#include <uacpi/platform/atomic.h>
 
 #define UACPI_REV_VALUE 2
 #define UACPI_OS_VALUE "Microsoft Windows NT"
@@ -33,6 +35,7 @@ predefined_namespaces[UACPI_PREDEFINED_NAMESPACE_MAX + 1] = {
 };
 
 static struct uacpi_rw_lock namespace_lock;
+static uacpi_u32 namespace_generation;
 
 uacpi_status uacpi_namespace_read_lock(void)
 {
@@ -80,8 +83,8 @@ static uacpi_object *make_object_for_predefined(
         if (uacpi_unlikely(obj == UACPI_NULL))
             return obj;
 
-        obj->buffer->text = uacpi_kernel_alloc(sizeof(UACPI_OS_VALUE));
-        if (uacpi_unlikely(obj->buffer->text == UACPI_NULL)) {
+        if (uacpi_unlikely(!uacpi_buffer_alloc_data(
+                obj->buffer, sizeof(UACPI_OS_VALUE)))) {
             uacpi_object_unref(obj);
             return UACPI_NULL;
         }
@@ -241,6 +244,7 @@ void uacpi_deinitialize_namespace(void)
 
     free_namespace_node(uacpi_namespace_root());
     uacpi_rw_lock_deinit(&namespace_lock);
+    namespace_generation = 0;
 }
 
 uacpi_namespace_node *uacpi_namespace_root(void)
@@ -268,6 +272,7 @@ uacpi_namespace_node *uacpi_namespace_node_alloc(uacpi_object_name name)
     if (uacpi_unlikely(ret == UACPI_NULL))
         return ret;
 
+    uacpi_timeline_count_allocation();
     uacpi_shareable_init(ret);
     ret->name = name;
     return ret;
@@ -278,6 +283,60 @@ void uacpi_namespace_node_unref(uacpi_namespace_node *node)
     uacpi_shareable_unref_and_delete_if_last(node, free_namespace_node);
 }
 
+uacpi_u32 uacpi_namespace_generation(void)
+{
+    // Might be called without the namespace lock
+    return uacpi_atomic_load32(&namespace_generation);
+}
+
+static void stamp_node_and_parent(uacpi_namespace_node *node)
+{
+    uacpi_namespace_node *parent = node->parent;
+
+    if (uacpi_namespace_node_is_temporary(node))
+        return;
+
+    node->generation = ++namespace_generation;
+
+    // Identity and presence of the parent device are described by _XXX objects
+    if (parent != UACPI_NULL && node->name.text[0] == '_')
+        parent->generation = namespace_generation;
+}
+
+static uacpi_iteration_decision stamp_one(
+    void *user, uacpi_namespace_node *node, uacpi_u32 depth
+)
+{
+    uacpi_u32 *generation = user;
+    UACPI_UNUSED(depth);
+
+    node->generation = *generation;
+    return UACPI_ITERATION_DECISION_CONTINUE;
+}
+
+void uacpi_namespace_on_notify(uacpi_namespace_node *node, uacpi_u64 value)
+{
+    uacpi_u32 generation;
+
+    switch (value) {
+    case 0: // Bus Check
+        generation = ++namespace_generation;
+        node->generation = generation;
+
+        uacpi_namespace_do_for_each_child(
+            node, stamp_one, UACPI_NULL, UACPI_OBJECT_ANY_BIT,
+            UACPI_MAX_DEPTH_ANY, UACPI_SHOULD_LOCK_NO,
+            UACPI_PERMANENT_ONLY_YES, &generation
+        );
+        break;
+    case 1: // Device Check
+        node->generation = ++namespace_generation;
+        break;
+    default:
+        break;
+    }
+}
+
 uacpi_status uacpi_namespace_node_install(
     uacpi_namespace_node *parent,
     uacpi_namespace_node *node
@@ -304,6 +363,7 @@ uacpi_status uacpi_namespace_node_install(
     }
 
     node->parent = parent;
+    stamp_node_and_parent(node);
     return UACPI_STATUS_OK;
 }
 
@@ -426,6 +486,7 @@ uacpi_status uacpi_namespace_node_uninstall(uacpi_namespace_node *node)
         prev->next = node->next;
     }
 
+    stamp_node_and_parent(node);
     node->flags |= UACPI_NAMESPACE_NODE_FLAG_DANGLING;
     uacpi_namespace_node_unref(node);
 
@@ -874,8 +935,10 @@ uacpi_status uacpi_namespace_do_for_each_child(
             }
 
             decision = cb(user, node, depth);
+
+            // The lock is already dropped at this point
             if (decision == UACPI_ITERATION_DECISION_BREAK)
-                goto out;
+                return ret;
 
             if (should_lock == UACPI_SHOULD_LOCK_YES) {
                 ret = uacpi_namespace_read_lock();
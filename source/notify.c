@@ -4,13 +4,14 @@
 #include <uacpi/internal/log.h>
 #include <uacpi/internal/mutex.h>
 #include <uacpi/internal/utilities.h>
+#include <uacpi/internal/resources.h>
 #include <uacpi/kernel_api.h>
 
 static uacpi_handle notify_mutex;
 
 uacpi_status uacpi_initialize_notify(void)
 {
-    notify_mutex = uacpi_kernel_create_mutex();
+    notify_mutex = uacpi_create_native_mutex();
     if (uacpi_unlikely(notify_mutex == UACPI_NULL))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
@@ -20,7 +21,7 @@ uacpi_status uacpi_initialize_notify(void)
 void uacpi_deinitialize_notify(void)
 {
     if (notify_mutex != UACPI_NULL)
-        uacpi_kernel_free_mutex(notify_mutex);
+        uacpi_free_native_mutex(notify_mutex);
 
     notify_mutex = UACPI_NULL;
 }
@@ -76,6 +77,9 @@ uacpi_status uacpi_notify_all(uacpi_namespace_node *node, uacpi_u64 value)
     if (uacpi_unlikely(node_object == UACPI_NULL))
         return UACPI_STATUS_INVALID_ARGUMENT;
 
+    uacpi_resource_cache_on_notify(node, value);
+    uacpi_namespace_on_notify(node, value);
+
     ret = uacpi_acquire_native_mutex(notify_mutex);
     if (uacpi_unlikely_error(ret))
         return ret;
@@ -229,6 +229,7 @@ const uacpi_char *const pop_names[UACPI_PARSE_OP_MAX + 1] = {
     [POP(LOAD_IMM_AS_OBJECT)] = "LOAD_IMM_AS_OBJECT",
     [POP(LOAD_FALSE_OBJECT)] = "LOAD_FALSE_OBJECT",
     [POP(LOAD_TRUE_OBJECT)] = "LOAD_TRUE_OBJECT",
+    [POP(LOAD_SHARED_CONSTANT)] = "LOAD_SHARED_CONSTANT",
     [POP(TRUNCATE_NUMBER)] = "TRUNCATE_NUMBER",
     [POP(TYPECHECK)] = "TYPECHECK",
     [POP(INSTALL_NAMESPACE_NODE)] = "INSTALL_NAMESPACE_NODE",
@@ -172,6 +172,88 @@ static uacpi_address_space_handler *find_handler(
     return UACPI_NULL;
 }
 
+/*
+ * With UACPI_FLAG_LAZY_REG, _REG for regions controlled by global address
+ * space handlers is not run during namespace initialization. Instead, it's
+ * run for every region of a scope right before the first method inside of
+ * that scope executes, see uacpi_opregion_lazy_reg_scope. Regions accessed
+ * from elsewhere before that are connected on first access. Called with the
+ * namespace write lock held.
+ */
+static uacpi_status region_lazy_reg(
+    uacpi_namespace_node *node, uacpi_object *obj
+)
+{
+    uacpi_operation_region *region = obj->op_region;
+    uacpi_address_space_handler *global_handler;
+    uacpi_status ret;
+
+    if (region->state_flags & UACPI_OP_REGION_STATE_REG_EXECUTED)
+        return UACPI_STATUS_OK;
+    if (!space_needs_reg(region->space))
+        return UACPI_STATUS_OK;
+
+    // Other handlers run _REG eagerly at installation time
+    global_handler = find_handler(
+        g_uacpi_rt_ctx.root_object->address_space_handlers, region->space
+    );
+    if (region->handler != global_handler)
+        return UACPI_STATUS_OK;
+
+    /*
+     * Set this before running _REG, as it's allowed to access the region
+     * itself, which would otherwise end up back here.
+     */
+    region->state_flags |= UACPI_OP_REGION_STATE_REG_EXECUTED;
+
+    uacpi_object_ref(obj);
+    ret = region_run_reg(node, ACPI_REG_CONNECT);
+    if (uacpi_unlikely_error(ret))
+        region->state_flags &= ~UACPI_OP_REGION_STATE_REG_EXECUTED;
+    uacpi_object_unref(obj);
+
+    if (uacpi_namespace_node_is_dangling(node))
+        return UACPI_STATUS_NAMESPACE_NODE_DANGLING;
+
+    return UACPI_STATUS_OK;
+}
+
+static uacpi_iteration_decision do_lazy_reg(
+    void *opaque, uacpi_namespace_node *node, uacpi_u32 depth
+)
+{
+    UACPI_UNUSED(opaque);
+    UACPI_UNUSED(depth);
+
+    region_lazy_reg(node, uacpi_namespace_node_get_object(node));
+    return UACPI_ITERATION_DECISION_CONTINUE;
+}
+
+void uacpi_opregion_lazy_reg_scope(uacpi_namespace_node *node)
+{
+    uacpi_namespace_node *scope;
+
+    while (!(node->flags & UACPI_NAMESPACE_NODE_FLAG_REG_DONE)) {
+        /*
+         * Go from the outermost scope that hasn't been done yet inwards, so
+         * that _REG runs for parents first, same as during an eager walk.
+         */
+        scope = node;
+        while (scope->parent != UACPI_NULL &&
+               !(scope->parent->flags & UACPI_NAMESPACE_NODE_FLAG_REG_DONE))
+            scope = scope->parent;
+
+        // Set this first, as _REG itself is a method inside of this scope
+        scope->flags |= UACPI_NAMESPACE_NODE_FLAG_REG_DONE;
+
+        uacpi_namespace_do_for_each_child(
+            scope, do_lazy_reg, UACPI_NULL,
+            UACPI_OBJECT_OPERATION_REGION_BIT, 1,
+            UACPI_SHOULD_LOCK_NO, UACPI_PERMANENT_ONLY_YES, UACPI_NULL
+        );
+    }
+}
+
 static uacpi_operation_region *find_previous_region_link(
     uacpi_operation_region *region
 )
@@ -214,6 +296,18 @@ uacpi_status uacpi_opregion_attach(uacpi_namespace_node *node)
 
     if (region->handler == UACPI_NULL)
         return UACPI_STATUS_NO_HANDLER;
+
+    // Not connected yet if accessed from outside of its scope
+    if (uacpi_unlikely(g_uacpi_rt_ctx.lazy_reg_active)) {
+        ret = region_lazy_reg(node, obj);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+
+        // _REG might have changed the handler
+        if (uacpi_unlikely(region->handler == UACPI_NULL))
+            return UACPI_STATUS_NO_HANDLER;
+    }
+
     if (region->state_flags & UACPI_OP_REGION_STATE_ATTACHED)
         return UACPI_STATUS_OK;
 
@@ -5,6 +5,10 @@
 #include <uacpi/internal/utilities.h>
 #include <uacpi/internal/log.h>
 #include <uacpi/internal/namespace.h>
+#include <uacpi/internal/shareable.h>
+#include <uacpi/internal/mutex.h>
+#include <uacpi/internal/context.h>
+#include <uacpi/internal/dynamic_array.h>
 #include <uacpi/uacpi.h>
 
 #define LARGE_RESOURCE_BASE (ACPI_RESOURCE_END_TAG + 1)
@@ -593,141 +597,132 @@ static uacpi_size aml_size_for_serial_connection(
 #define ARG2(value) .arg2 = (value)
 
 
-static const struct uacpi_resource_convert_instruction convert_irq_to_native[] = {
-    OP(PACKED_ARRAY_16, AML_F(irq, irq_mask), NATIVE_F(irq, irqs),
-       ARG2(NATIVE_O(irq, num_irqs))),
-    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(3), IMM(6)),
-        OP(SET_TO_IMM, NATIVE_F(irq, length_kind),
-           IMM(UACPI_RESOURCE_LENGTH_KIND_FULL)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, triggering), IMM(0)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, polarity), IMM(3)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, sharing), IMM(4)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, wake_capability), IMM(5)),
-        END(),
-    OP(SET_TO_IMM, NATIVE_F(irq, length_kind),
-       IMM(UACPI_RESOURCE_LENGTH_KIND_ONE_LESS)),
-    OP(SET_TO_IMM, NATIVE_F(irq, triggering), IMM(UACPI_TRIGGERING_EDGE)),
-    END(),
-};
+#define CONVERT_IRQ_TO_NATIVE_PROGRAM                                        \
+    OP(PACKED_ARRAY_16, AML_F(irq, irq_mask), NATIVE_F(irq, irqs),           \
+       ARG2(NATIVE_O(irq, num_irqs))),                                       \
+    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(3), IMM(6)),                         \
+        OP(SET_TO_IMM, NATIVE_F(irq, length_kind),                           \
+           IMM(UACPI_RESOURCE_LENGTH_KIND_FULL)),                            \
+        OP(BIT_FIELD_1, AML_F(irq, flags),                                   \
+           NATIVE_F(irq, triggering), IMM(0)),                               \
+        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, polarity), IMM(3)), \
+        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, sharing), IMM(4)),  \
+        OP(BIT_FIELD_1, AML_F(irq, flags),                                   \
+           NATIVE_F(irq, wake_capability), IMM(5)),                          \
+        END(),                                                               \
+    OP(SET_TO_IMM, NATIVE_F(irq, length_kind),                               \
+       IMM(UACPI_RESOURCE_LENGTH_KIND_ONE_LESS)),                            \
+    OP(SET_TO_IMM, NATIVE_F(irq, triggering), IMM(UACPI_TRIGGERING_EDGE)),   \
+    END()
 
-const struct uacpi_resource_convert_instruction convert_irq_to_aml[] = {
-    OP(PACKED_ARRAY_16, AML_F(irq, irq_mask), NATIVE_F(irq, irqs),
-       ARG2(NATIVE_O(irq, num_irqs))),
-    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(3), IMM(4)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, triggering), IMM(0)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, polarity), IMM(3)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, sharing), IMM(4)),
-        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, wake_capability), IMM(5)),
-    END(),
-};
+#define CONVERT_IRQ_TO_AML_PROGRAM                                           \
+    OP(PACKED_ARRAY_16, AML_F(irq, irq_mask), NATIVE_F(irq, irqs),           \
+       ARG2(NATIVE_O(irq, num_irqs))),                                       \
+    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(3), IMM(4)),                         \
+        OP(BIT_FIELD_1, AML_F(irq, flags),                                   \
+           NATIVE_F(irq, triggering), IMM(0)),                               \
+        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, polarity), IMM(3)), \
+        OP(BIT_FIELD_1, AML_F(irq, flags), NATIVE_F(irq, sharing), IMM(4)),  \
+        OP(BIT_FIELD_1, AML_F(irq, flags),                                   \
+           NATIVE_F(irq, wake_capability), IMM(5)),                          \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_dma[] = {
-    OP(PACKED_ARRAY_8, AML_F(dma, channel_mask), NATIVE_F(dma, channels),
-       ARG2(NATIVE_O(dma, num_channels))),
-    OP(BIT_FIELD_2, AML_F(dma, flags), NATIVE_F(dma, transfer_type), IMM(0)),
-    OP(BIT_FIELD_1, AML_F(dma, flags), NATIVE_F(dma, bus_master_status), IMM(2)),
-    OP(BIT_FIELD_2, AML_F(dma, flags), NATIVE_F(dma, channel_speed), IMM(5)),
-    END(),
-};
+#define CONVERT_DMA_PROGRAM                                                   \
+    OP(PACKED_ARRAY_8, AML_F(dma, channel_mask), NATIVE_F(dma, channels),     \
+       ARG2(NATIVE_O(dma, num_channels))),                                    \
+    OP(BIT_FIELD_2, AML_F(dma, flags), NATIVE_F(dma, transfer_type), IMM(0)), \
+    OP(BIT_FIELD_1, AML_F(dma, flags),                                        \
+       NATIVE_F(dma, bus_master_status), IMM(2)),                             \
+    OP(BIT_FIELD_2, AML_F(dma, flags), NATIVE_F(dma, channel_speed), IMM(5)), \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_start_dependent_to_native[] = {
-    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(1), IMM(4)),
-        OP(SET_TO_IMM, NATIVE_F(start_dependent, length_kind),
-           IMM(UACPI_RESOURCE_LENGTH_KIND_FULL)),
-        OP(BIT_FIELD_2, AML_F(start_dependent, flags),
-           NATIVE_F(start_dependent, compatibility), IMM(0)),
-        OP(BIT_FIELD_2, AML_F(start_dependent, flags),
-           NATIVE_F(start_dependent, performance), IMM(2)),
-        END(),
-    OP(SET_TO_IMM, NATIVE_F(start_dependent, length_kind),
-       IMM(UACPI_RESOURCE_LENGTH_KIND_ONE_LESS)),
-    OP(SET_TO_IMM, NATIVE_F(start_dependent, compatibility),
-       IMM(UACPI_ACCEPTABLE)),
-    OP(SET_TO_IMM, NATIVE_F(start_dependent, performance),
-       IMM(UACPI_ACCEPTABLE)),
-    END(),
-};
+#define CONVERT_START_DEPENDENT_TO_NATIVE_PROGRAM              \
+    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(1), IMM(4)),           \
+        OP(SET_TO_IMM, NATIVE_F(start_dependent, length_kind), \
+           IMM(UACPI_RESOURCE_LENGTH_KIND_FULL)),              \
+        OP(BIT_FIELD_2, AML_F(start_dependent, flags),         \
+           NATIVE_F(start_dependent, compatibility), IMM(0)),  \
+        OP(BIT_FIELD_2, AML_F(start_dependent, flags),         \
+           NATIVE_F(start_dependent, performance), IMM(2)),    \
+        END(),                                                 \
+    OP(SET_TO_IMM, NATIVE_F(start_dependent, length_kind),     \
+       IMM(UACPI_RESOURCE_LENGTH_KIND_ONE_LESS)),              \
+    OP(SET_TO_IMM, NATIVE_F(start_dependent, compatibility),   \
+       IMM(UACPI_ACCEPTABLE)),                                 \
+    OP(SET_TO_IMM, NATIVE_F(start_dependent, performance),     \
+       IMM(UACPI_ACCEPTABLE)),                                 \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_start_dependent_to_aml[] = {
-    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(1), IMM(1)),
-        OP(BIT_FIELD_2, AML_F(start_dependent, flags),
-           NATIVE_F(start_dependent, compatibility), IMM(0)),
-        OP(BIT_FIELD_2, AML_F(start_dependent, flags),
-           NATIVE_F(start_dependent, performance), IMM(2)),
-    END(),
-};
+#define CONVERT_START_DEPENDENT_TO_AML_PROGRAM                \
+    OP(SKIP_IF_AML_SIZE_LESS_THAN, ARG0(1), IMM(1)),          \
+        OP(BIT_FIELD_2, AML_F(start_dependent, flags),        \
+           NATIVE_F(start_dependent, compatibility), IMM(0)), \
+        OP(BIT_FIELD_2, AML_F(start_dependent, flags),        \
+           NATIVE_F(start_dependent, performance), IMM(2)),   \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_io[] = {
-    OP(BIT_FIELD_1, AML_F(io, information), NATIVE_F(io, decode_type)),
-    OP(FIELD_16, AML_F(io, minimum), NATIVE_F(io, minimum)),
-    OP(FIELD_16, AML_F(io, maximum), NATIVE_F(io, maximum)),
-    OP(FIELD_8, AML_F(io, alignment), NATIVE_F(io, alignment)),
-    OP(FIELD_8, AML_F(io, length), NATIVE_F(io, length)),
-    END(),
-};
+#define CONVERT_IO_PROGRAM                                              \
+    OP(BIT_FIELD_1, AML_F(io, information), NATIVE_F(io, decode_type)), \
+    OP(FIELD_16, AML_F(io, minimum), NATIVE_F(io, minimum)),            \
+    OP(FIELD_16, AML_F(io, maximum), NATIVE_F(io, maximum)),            \
+    OP(FIELD_8, AML_F(io, alignment), NATIVE_F(io, alignment)),         \
+    OP(FIELD_8, AML_F(io, length), NATIVE_F(io, length)),               \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_fixed_io[] = {
-    OP(FIELD_16, AML_F(fixed_io, address), NATIVE_F(fixed_io, address)),
-    OP(FIELD_8, AML_F(fixed_io, length), NATIVE_F(fixed_io, length)),
-    END(),
-};
+#define CONVERT_FIXED_IO_PROGRAM                                         \
+    OP(FIELD_16, AML_F(fixed_io, address), NATIVE_F(fixed_io, address)), \
+    OP(FIELD_8, AML_F(fixed_io, length), NATIVE_F(fixed_io, length)),    \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_fixed_dma[] = {
-    OP(FIELD_16, AML_F(fixed_dma, request_line),
-                 NATIVE_F(fixed_dma, request_line)),
-    OP(FIELD_16, AML_F(fixed_dma, channel), NATIVE_F(fixed_dma, channel)),
-    OP(FIELD_8, AML_F(fixed_dma, transfer_width),
-                NATIVE_F(fixed_dma, transfer_width)),
-    END(),
-};
+#define CONVERT_FIXED_DMA_PROGRAM                                          \
+    OP(FIELD_16, AML_F(fixed_dma, request_line),                           \
+                 NATIVE_F(fixed_dma, request_line)),                       \
+    OP(FIELD_16, AML_F(fixed_dma, channel), NATIVE_F(fixed_dma, channel)), \
+    OP(FIELD_8, AML_F(fixed_dma, transfer_width),                          \
+                NATIVE_F(fixed_dma, transfer_width)),                      \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_vendor_type0[] = {
-    OP(LOAD_AML_SIZE_32, NATIVE_F(vendor, length)),
-    OP(FIELD_8, AML_F(vendor_defined_type0, byte_data), NATIVE_F(vendor, data)),
-    END(),
-};
+#define CONVERT_VENDOR_TYPE0_PROGRAM                    \
+    OP(LOAD_AML_SIZE_32, NATIVE_F(vendor, length)),     \
+    OP(FIELD_8, AML_F(vendor_defined_type0, byte_data), \
+       NATIVE_F(vendor, data)),                         \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_vendor_type1[] = {
-    OP(LOAD_AML_SIZE_32, NATIVE_F(vendor, length)),
-    OP(FIELD_8, AML_F(vendor_defined_type1, byte_data), NATIVE_F(vendor, data)),
-    END(),
-};
+#define CONVERT_VENDOR_TYPE1_PROGRAM                    \
+    OP(LOAD_AML_SIZE_32, NATIVE_F(vendor, length)),     \
+    OP(FIELD_8, AML_F(vendor_defined_type1, byte_data), \
+       NATIVE_F(vendor, data)),                         \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_memory24[] = {
-    OP(BIT_FIELD_1, AML_F(memory24, information),
-                    NATIVE_F(memory24, write_status), IMM(0)),
-    OP(FIELD_16, AML_F(memory24, minimum), NATIVE_F(memory24, minimum), IMM(4)),
-    END(),
-};
+#define CONVERT_MEMORY24_PROGRAM                               \
+    OP(BIT_FIELD_1, AML_F(memory24, information),              \
+                    NATIVE_F(memory24, write_status), IMM(0)), \
+    OP(FIELD_16, AML_F(memory24, minimum),                     \
+       NATIVE_F(memory24, minimum), IMM(4)),                   \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_memory32[] = {
-    OP(BIT_FIELD_1, AML_F(memory32, information),
-                    NATIVE_F(memory32, write_status), IMM(0)),
-    OP(FIELD_32, AML_F(memory32, minimum), NATIVE_F(memory32, minimum), IMM(4)),
-    END(),
-};
+#define CONVERT_MEMORY32_PROGRAM                               \
+    OP(BIT_FIELD_1, AML_F(memory32, information),              \
+                    NATIVE_F(memory32, write_status), IMM(0)), \
+    OP(FIELD_32, AML_F(memory32, minimum),                     \
+       NATIVE_F(memory32, minimum), IMM(4)),                   \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_fixed_memory32[] = {
-    OP(BIT_FIELD_1, AML_F(fixed_memory32, information),
-                    NATIVE_F(fixed_memory32, write_status), IMM(0)),
-    OP(FIELD_32, AML_F(fixed_memory32, address),
-                 NATIVE_F(fixed_memory32, address)),
-    OP(FIELD_32, AML_F(fixed_memory32, length),
-                 NATIVE_F(fixed_memory32, length)),
-    END(),
-};
+#define CONVERT_FIXED_MEMORY32_PROGRAM                               \
+    OP(BIT_FIELD_1, AML_F(fixed_memory32, information),              \
+                    NATIVE_F(fixed_memory32, write_status), IMM(0)), \
+    OP(FIELD_32, AML_F(fixed_memory32, address),                     \
+                 NATIVE_F(fixed_memory32, address)),                 \
+    OP(FIELD_32, AML_F(fixed_memory32, length),                      \
+                 NATIVE_F(fixed_memory32, length)),                  \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_generic_register[] = {
-    OP(FIELD_8, AML_F(generic_register, address_space_id),
-                NATIVE_F(generic_register, address_space_id), IMM(4)),
-    OP(FIELD_64, AML_F(generic_register, address),
-                NATIVE_F(generic_register, address)),
-    END(),
-};
+#define CONVERT_GENERIC_REGISTER_PROGRAM                               \
+    OP(FIELD_8, AML_F(generic_register, address_space_id),             \
+                NATIVE_F(generic_register, address_space_id), IMM(4)), \
+    OP(FIELD_64, AML_F(generic_register, address),                     \
+                NATIVE_F(generic_register, address)),                  \
+    END()
 
 #define CONVERT_TYPE_SPECIFIC_FLAGS(addr_type)                                 \
     OP(LOAD_8_STORE, AML_F(addr_type, common.type),                            \
@@ -776,64 +771,59 @@ convert_generic_register[] = {
       AML_F(addr_type, common.flags),                          \
       NATIVE_F(addr_type, common.fixed_max_address), IMM(3))   \
 
-#define DEFINE_ADDRESS_CONVERSION(width)                              \
-    static const struct uacpi_resource_convert_instruction            \
-    convert_address##width[] = {                                      \
-        CONVERT_GENERAL_ADDRESS_FLAGS(address##width),                \
-        OP(FIELD_##width, AML_F(address##width, granularity),         \
-           NATIVE_F(address##width, granularity), IMM(5)),            \
-        OP(RESOURCE_SOURCE, NATIVE_F(address##width, source)),        \
-        CONVERT_TYPE_SPECIFIC_FLAGS(address##width),                  \
-    };
-
-DEFINE_ADDRESS_CONVERSION(16)
-DEFINE_ADDRESS_CONVERSION(32)
-DEFINE_ADDRESS_CONVERSION(64)
-
-static const struct uacpi_resource_convert_instruction
-convert_address64_extended[] = {
-    CONVERT_GENERAL_ADDRESS_FLAGS(address64_extended),
-    OP(FIELD_8, AML_F(address64_extended, revision_id),
-       NATIVE_F(address64_extended, revision_id)),
-    OP(FIELD_64, AML_F(address64_extended, granularity),
-       NATIVE_F(address64_extended, granularity), IMM(6)),
-    CONVERT_TYPE_SPECIFIC_FLAGS(address64_extended),
-};
-
-static const struct uacpi_resource_convert_instruction
-convert_extended_irq[] = {
-    OP(BIT_FIELD_1, AML_F(extended_irq, flags),
-                    NATIVE_F(extended_irq, direction), IMM(0)),
-    OP(BIT_FIELD_1, AML_F(extended_irq, flags),
-                    NATIVE_F(extended_irq, triggering), IMM(1)),
-    OP(BIT_FIELD_1, AML_F(extended_irq, flags),
-                    NATIVE_F(extended_irq, polarity), IMM(2)),
-    OP(BIT_FIELD_1, AML_F(extended_irq, flags),
-                    NATIVE_F(extended_irq, sharing), IMM(3)),
-    OP(BIT_FIELD_1, AML_F(extended_irq, flags),
-                    NATIVE_F(extended_irq, wake_capability), IMM(4)),
-    OP(LOAD_8_STORE, AML_F(extended_irq, num_irqs),
-       NATIVE_F(extended_irq, num_irqs), IMM(4)),
-    OP(RESOURCE_SOURCE, NATIVE_F(extended_irq, source)),
-
-    // Use FIELD_8 here since the accumulator has been multiplied by 4
-    OP(FIELD_8, AML_F(extended_irq, irqs), NATIVE_F(extended_irq, irqs)),
-    END(),
-};
+#define CONVERT_ADDRESS_PROGRAM(width)                     \
+    CONVERT_GENERAL_ADDRESS_FLAGS(address##width),         \
+    OP(FIELD_##width, AML_F(address##width, granularity),  \
+       NATIVE_F(address##width, granularity), IMM(5)),     \
+    OP(RESOURCE_SOURCE, NATIVE_F(address##width, source)), \
+    CONVERT_TYPE_SPECIFIC_FLAGS(address##width)
+
+#define CONVERT_ADDRESS16_PROGRAM CONVERT_ADDRESS_PROGRAM(16)
+#define CONVERT_ADDRESS32_PROGRAM CONVERT_ADDRESS_PROGRAM(32)
+#define CONVERT_ADDRESS64_PROGRAM CONVERT_ADDRESS_PROGRAM(64)
+
+#define CONVERT_ADDRESS64_EXTENDED_PROGRAM                 \
+    CONVERT_GENERAL_ADDRESS_FLAGS(address64_extended),     \
+    OP(FIELD_8, AML_F(address64_extended, revision_id),    \
+       NATIVE_F(address64_extended, revision_id)),         \
+    OP(FIELD_64, AML_F(address64_extended, granularity),   \
+       NATIVE_F(address64_extended, granularity), IMM(6)), \
+    CONVERT_TYPE_SPECIFIC_FLAGS(address64_extended)
+
+#define CONVERT_EXTENDED_IRQ_PROGRAM                                      \
+    OP(BIT_FIELD_1, AML_F(extended_irq, flags),                           \
+                    NATIVE_F(extended_irq, direction), IMM(0)),           \
+    OP(BIT_FIELD_1, AML_F(extended_irq, flags),                           \
+                    NATIVE_F(extended_irq, triggering), IMM(1)),          \
+    OP(BIT_FIELD_1, AML_F(extended_irq, flags),                           \
+                    NATIVE_F(extended_irq, polarity), IMM(2)),            \
+    OP(BIT_FIELD_1, AML_F(extended_irq, flags),                           \
+                    NATIVE_F(extended_irq, sharing), IMM(3)),             \
+    OP(BIT_FIELD_1, AML_F(extended_irq, flags),                           \
+                    NATIVE_F(extended_irq, wake_capability), IMM(4)),     \
+    OP(LOAD_8_STORE, AML_F(extended_irq, num_irqs),                       \
+       NATIVE_F(extended_irq, num_irqs), IMM(4)),                         \
+    OP(RESOURCE_SOURCE, NATIVE_F(extended_irq, source)),                  \
+                                                                          \
+    /* Use FIELD_8 here since the accumulator has been multiplied by 4 */ \
+    OP(FIELD_8, AML_F(extended_irq, irqs), NATIVE_F(extended_irq, irqs)), \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_clock_input[] = {
-    OP(FIELD_8, AML_F(clock_input, revision_id),
-       NATIVE_F(clock_input, revision_id)),
-    OP(BIT_FIELD_1, AML_F(clock_input, flags), NATIVE_F(clock_input, frequency),
-       IMM(0)),
-    OP(BIT_FIELD_2, AML_F(clock_input, flags), NATIVE_F(clock_input, scale),
-       IMM(1)),
-    OP(FIELD_16, AML_F(clock_input, divisor), NATIVE_F(clock_input, divisor)),
-    OP(FIELD_32, AML_F(clock_input, numerator), NATIVE_F(clock_input, numerator)),
-    OP(FIELD_8, AML_F(clock_input, source_index), NATIVE_F(clock_input, source.index)),
-    OP(RESOURCE_SOURCE_NO_INDEX, NATIVE_F(clock_input, source)),
-    END(),
-};
+#define CONVERT_CLOCK_INPUT_PROGRAM                                          \
+    OP(FIELD_8, AML_F(clock_input, revision_id),                             \
+       NATIVE_F(clock_input, revision_id)),                                  \
+    OP(BIT_FIELD_1, AML_F(clock_input, flags),                               \
+       NATIVE_F(clock_input, frequency), IMM(0)),                            \
+    OP(BIT_FIELD_2, AML_F(clock_input, flags), NATIVE_F(clock_input, scale), \
+       IMM(1)),                                                              \
+    OP(FIELD_16, AML_F(clock_input, divisor),                                \
+       NATIVE_F(clock_input, divisor)),                                      \
+    OP(FIELD_32, AML_F(clock_input, numerator),                              \
+       NATIVE_F(clock_input, numerator)),                                    \
+    OP(FIELD_8, AML_F(clock_input, source_index),                            \
+       NATIVE_F(clock_input, source.index)),                                 \
+    OP(RESOURCE_SOURCE_NO_INDEX, NATIVE_F(clock_input, source)),             \
+    END()
 
 #define DECODE_SOURCE_INDEX(short_aml_name)          \
     OP(FIELD_8, AML_F(short_aml_name, source_index), \
@@ -854,88 +844,82 @@ static const struct uacpi_resource_convert_instruction convert_clock_input[] = {
        NATIVE_F(short_aml_name, vendor_data_length),                   \
        ARG2(NATIVE_O(short_aml_name, vendor_data)))
 
-static const struct uacpi_resource_convert_instruction
-convert_gpio_connection[] = {
-    OP(FIELD_8, AML_F(gpio_connection, revision_id),
-       NATIVE_F(gpio_connection, revision_id)),
-    OP(BIT_FIELD_1, AML_F(gpio_connection, general_flags),
-       NATIVE_F(gpio_connection, direction)),
-    OP(FIELD_8, AML_F(gpio_connection, pull_configuration),
-       NATIVE_F(gpio_connection, pull_configuration)),
-    OP(FIELD_16, AML_F(gpio_connection, drive_strength),
-       NATIVE_F(gpio_connection, drive_strength), IMM(2)),
-    DECODE_SOURCE_INDEX(gpio_connection),
-    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(
-        gpio_connection, SOURCE_NO_INDEX, source_offset, source
-    ),
-    OP(LOAD_8_STORE, AML_F(gpio_connection, type), NATIVE_F(gpio_connection, type)),
-    OP(SKIP_IF_NOT_EQUALS, ARG0(UACPI_GPIO_CONNECTION_INTERRUPT), IMM(5)),
-        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),
-           NATIVE_F(gpio_connection, interrupt.triggering), IMM(0)),
-        OP(BIT_FIELD_2, AML_F(gpio_connection, connection_flags),
-           NATIVE_F(gpio_connection, interrupt.polarity), IMM(1)),
-        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),
-           NATIVE_F(gpio_connection, interrupt.sharing), IMM(3)),
-        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),
-           NATIVE_F(gpio_connection, interrupt.wake_capability), IMM(4)),
-        END(),
-    OP(SKIP_IF_NOT_EQUALS, ARG0(UACPI_GPIO_CONNECTION_IO), IMM(3)),
-        OP(BIT_FIELD_2, AML_F(gpio_connection, connection_flags),
-           NATIVE_F(gpio_connection, io.restriction), IMM(0)),
-        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),
-           NATIVE_F(gpio_connection, io.sharing), IMM(3)),
-        END(),
-    OP(FIELD_16, AML_F(gpio_connection, connection_flags),
-       NATIVE_F(gpio_connection, type_specific), IMM(0xFF)),
-    END(),
-};
+#define CONVERT_GPIO_CONNECTION_PROGRAM                                    \
+    OP(FIELD_8, AML_F(gpio_connection, revision_id),                       \
+       NATIVE_F(gpio_connection, revision_id)),                            \
+    OP(BIT_FIELD_1, AML_F(gpio_connection, general_flags),                 \
+       NATIVE_F(gpio_connection, direction)),                              \
+    OP(FIELD_8, AML_F(gpio_connection, pull_configuration),                \
+       NATIVE_F(gpio_connection, pull_configuration)),                     \
+    OP(FIELD_16, AML_F(gpio_connection, drive_strength),                   \
+       NATIVE_F(gpio_connection, drive_strength), IMM(2)),                 \
+    DECODE_SOURCE_INDEX(gpio_connection),                                  \
+    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(                                    \
+        gpio_connection, SOURCE_NO_INDEX, source_offset, source            \
+    ),                                                                     \
+    OP(LOAD_8_STORE, AML_F(gpio_connection, type),                         \
+       NATIVE_F(gpio_connection, type)),                                   \
+    OP(SKIP_IF_NOT_EQUALS, ARG0(UACPI_GPIO_CONNECTION_INTERRUPT), IMM(5)), \
+        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),          \
+           NATIVE_F(gpio_connection, interrupt.triggering), IMM(0)),       \
+        OP(BIT_FIELD_2, AML_F(gpio_connection, connection_flags),          \
+           NATIVE_F(gpio_connection, interrupt.polarity), IMM(1)),         \
+        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),          \
+           NATIVE_F(gpio_connection, interrupt.sharing), IMM(3)),          \
+        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),          \
+           NATIVE_F(gpio_connection, interrupt.wake_capability), IMM(4)),  \
+        END(),                                                             \
+    OP(SKIP_IF_NOT_EQUALS, ARG0(UACPI_GPIO_CONNECTION_IO), IMM(3)),        \
+        OP(BIT_FIELD_2, AML_F(gpio_connection, connection_flags),          \
+           NATIVE_F(gpio_connection, io.restriction), IMM(0)),             \
+        OP(BIT_FIELD_1, AML_F(gpio_connection, connection_flags),          \
+           NATIVE_F(gpio_connection, io.sharing), IMM(3)),                 \
+        END(),                                                             \
+    OP(FIELD_16, AML_F(gpio_connection, connection_flags),                 \
+       NATIVE_F(gpio_connection, type_specific), IMM(0xFF)),               \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_pin_function[] = {
-    OP(FIELD_8, AML_F(pin_function, revision_id),
-       NATIVE_F(pin_function, revision_id)),
-    OP(BIT_FIELD_1, AML_F(pin_function, flags),
-       NATIVE_F(pin_function, sharing), IMM(0)),
-    OP(FIELD_8, AML_F(pin_function, pull_configuration),
-       NATIVE_F(pin_function, pull_configuration)),
-    OP(FIELD_16, AML_F(pin_function, function_number),
-       NATIVE_F(pin_function, function_number)),
-    DECODE_SOURCE_INDEX(pin_function),
-    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(
-        pin_function, SOURCE_NO_INDEX, source_offset, source
-    ),
-    END(),
-};
+#define CONVERT_PIN_FUNCTION_PROGRAM                         \
+    OP(FIELD_8, AML_F(pin_function, revision_id),            \
+       NATIVE_F(pin_function, revision_id)),                 \
+    OP(BIT_FIELD_1, AML_F(pin_function, flags),              \
+       NATIVE_F(pin_function, sharing), IMM(0)),             \
+    OP(FIELD_8, AML_F(pin_function, pull_configuration),     \
+       NATIVE_F(pin_function, pull_configuration)),          \
+    OP(FIELD_16, AML_F(pin_function, function_number),       \
+       NATIVE_F(pin_function, function_number)),             \
+    DECODE_SOURCE_INDEX(pin_function),                       \
+    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(                      \
+        pin_function, SOURCE_NO_INDEX, source_offset, source \
+    ),                                                       \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_pin_configuration[] = {
-    OP(FIELD_8, AML_F(pin_configuration, revision_id),
-       NATIVE_F(pin_configuration, revision_id)),
-    OP(BIT_FIELD_1, AML_F(pin_configuration, flags),
-       NATIVE_F(pin_configuration, sharing), IMM(0)),
-    OP(BIT_FIELD_1, AML_F(pin_configuration, flags),
-       NATIVE_F(pin_configuration, direction), IMM(1)),
-    OP(FIELD_8, AML_F(pin_configuration, type),
-       NATIVE_F(pin_configuration, type)),
-    OP(FIELD_32, AML_F(pin_configuration, value),
-       NATIVE_F(pin_configuration, value)),
-    DECODE_SOURCE_INDEX(pin_configuration),
-    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(
-        pin_configuration, SOURCE_NO_INDEX, source_offset, source
-    ),
-    END(),
-};
+#define CONVERT_PIN_CONFIGURATION_PROGRAM                         \
+    OP(FIELD_8, AML_F(pin_configuration, revision_id),            \
+       NATIVE_F(pin_configuration, revision_id)),                 \
+    OP(BIT_FIELD_1, AML_F(pin_configuration, flags),              \
+       NATIVE_F(pin_configuration, sharing), IMM(0)),             \
+    OP(BIT_FIELD_1, AML_F(pin_configuration, flags),              \
+       NATIVE_F(pin_configuration, direction), IMM(1)),           \
+    OP(FIELD_8, AML_F(pin_configuration, type),                   \
+       NATIVE_F(pin_configuration, type)),                        \
+    OP(FIELD_32, AML_F(pin_configuration, value),                 \
+       NATIVE_F(pin_configuration, value)),                       \
+    DECODE_SOURCE_INDEX(pin_configuration),                       \
+    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(                           \
+        pin_configuration, SOURCE_NO_INDEX, source_offset, source \
+    ),                                                            \
+    END()
 
-static const struct uacpi_resource_convert_instruction convert_pin_group[] = {
-    OP(FIELD_8, AML_F(pin_group, revision_id),
-       NATIVE_F(pin_group, revision_id)),
-    OP(BIT_FIELD_1, AML_F(pin_group, flags),
-       NATIVE_F(pin_group, direction), IMM(0)),
-    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(
-        pin_group, LABEL, source_lable_offset, label
-    ),
-    END(),
-};
+#define CONVERT_PIN_GROUP_PROGRAM                    \
+    OP(FIELD_8, AML_F(pin_group, revision_id),       \
+       NATIVE_F(pin_group, revision_id)),            \
+    OP(BIT_FIELD_1, AML_F(pin_group, flags),         \
+       NATIVE_F(pin_group, direction), IMM(0)),      \
+    DECODE_RES_PIN_TBL_AND_VENDOR_DATA(              \
+        pin_group, LABEL, source_lable_offset, label \
+    ),                                               \
+    END()
 
 #define DECODE_PIN_GROUP_RES_SOURCES(postfix)                           \
     DECODE_SOURCE_INDEX(pin_group_##postfix),                           \
@@ -950,103 +934,164 @@ static const struct uacpi_resource_convert_instruction convert_pin_group[] = {
        NATIVE_F(pin_group_##postfix, vendor_data_length),               \
        ARG2(NATIVE_O(pin_group_##postfix, vendor_data)))
 
-static const struct uacpi_resource_convert_instruction
-convert_pin_group_function[] = {
-    OP(FIELD_8, AML_F(pin_group_function, revision_id),
-       NATIVE_F(pin_group_function, revision_id)),
-    OP(BIT_FIELD_1, AML_F(pin_group_function, flags),
-       NATIVE_F(pin_group_function, sharing), IMM(0)),
-    OP(BIT_FIELD_1, AML_F(pin_group_function, flags),
-       NATIVE_F(pin_group_function, direction), IMM(1)),
-    OP(FIELD_16, AML_F(pin_group_function, function),
-       NATIVE_F(pin_group_function, function)),
-    DECODE_PIN_GROUP_RES_SOURCES(function),
-    END(),
-};
+#define CONVERT_PIN_GROUP_FUNCTION_PROGRAM               \
+    OP(FIELD_8, AML_F(pin_group_function, revision_id),  \
+       NATIVE_F(pin_group_function, revision_id)),       \
+    OP(BIT_FIELD_1, AML_F(pin_group_function, flags),    \
+       NATIVE_F(pin_group_function, sharing), IMM(0)),   \
+    OP(BIT_FIELD_1, AML_F(pin_group_function, flags),    \
+       NATIVE_F(pin_group_function, direction), IMM(1)), \
+    OP(FIELD_16, AML_F(pin_group_function, function),    \
+       NATIVE_F(pin_group_function, function)),          \
+    DECODE_PIN_GROUP_RES_SOURCES(function),              \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_pin_group_configuration[] = {
-    OP(FIELD_8, AML_F(pin_group_configuration, revision_id),
-       NATIVE_F(pin_group_configuration, revision_id)),
-    OP(BIT_FIELD_1, AML_F(pin_group_configuration, flags),
-       NATIVE_F(pin_group_configuration, sharing), IMM(0)),
-    OP(BIT_FIELD_1, AML_F(pin_group_configuration, flags),
-       NATIVE_F(pin_group_configuration, direction), IMM(1)),
-    OP(FIELD_8, AML_F(pin_group_configuration, type),
-       NATIVE_F(pin_group_configuration, type)),
-    OP(FIELD_32, AML_F(pin_group_configuration, value),
-       NATIVE_F(pin_group_configuration, value)),
-    DECODE_PIN_GROUP_RES_SOURCES(configuration),
-    END(),
-};
+#define CONVERT_PIN_GROUP_CONFIGURATION_PROGRAM               \
+    OP(FIELD_8, AML_F(pin_group_configuration, revision_id),  \
+       NATIVE_F(pin_group_configuration, revision_id)),       \
+    OP(BIT_FIELD_1, AML_F(pin_group_configuration, flags),    \
+       NATIVE_F(pin_group_configuration, sharing), IMM(0)),   \
+    OP(BIT_FIELD_1, AML_F(pin_group_configuration, flags),    \
+       NATIVE_F(pin_group_configuration, direction), IMM(1)), \
+    OP(FIELD_8, AML_F(pin_group_configuration, type),         \
+       NATIVE_F(pin_group_configuration, type)),              \
+    OP(FIELD_32, AML_F(pin_group_configuration, value),       \
+       NATIVE_F(pin_group_configuration, value)),             \
+    DECODE_PIN_GROUP_RES_SOURCES(configuration),              \
+    END()
 
-static const struct uacpi_resource_convert_instruction
-convert_generic_serial_bus[] = {
-    OP(FIELD_8, AML_F(serial, revision_id),
-       NATIVE_F(serial_bus_common, revision_id)),
-    OP(FIELD_8, AML_F(serial, type_specific_revision_id),
-       NATIVE_F(serial_bus_common, type_revision_id)),
-    OP(FIELD_8, AML_F(serial, source_index),
-       NATIVE_F(serial_bus_common, source.index)),
-    OP(FIELD_16, AML_F(serial, type_data_length),
-       NATIVE_F(serial_bus_common, type_data_length)),
-    OP(BIT_FIELD_1, AML_F(serial, flags),
-       NATIVE_F(serial_bus_common, mode), IMM(0)),
-    OP(BIT_FIELD_1, AML_F(serial, flags),
-       NATIVE_F(serial_bus_common, direction), IMM(1)),
-    OP(BIT_FIELD_1, AML_F(serial, flags),
-       NATIVE_F(serial_bus_common, sharing), IMM(2)),
-    OP(SERIAL_TYPE_SPECIFIC, AML_F(serial, type),
-       NATIVE_F(serial_bus_common, type)),
-    OP(RESOURCE_SOURCE_NO_INDEX, NATIVE_F(serial_bus_common, source)),
-    OP(LOAD_8_NATIVE, NATIVE_F(serial_bus_common, type)),
-    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_I2C), IMM(4)),
-        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),
-           NATIVE_F(i2c_connection, addressing_mode), IMM(0)),
-        OP(FIELD_32, AML_F(serial_i2c, connection_speed),
-           NATIVE_F(i2c_connection, connection_speed), IMM(0xFF)),
-        OP(FIELD_16, AML_F(serial_i2c, slave_address),
-           NATIVE_F(i2c_connection, slave_address)),
-        END(),
-    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_SPI), IMM(5)),
-        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),
-           NATIVE_F(spi_connection, wire_mode), IMM(0)),
-        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),
-           NATIVE_F(spi_connection, device_polarity), IMM(1)),
-        OP(FIELD_32, AML_F(serial_spi, connection_speed),
-           NATIVE_F(spi_connection, connection_speed), IMM(0xFF)),
-        OP(FIELD_8, AML_F(serial_spi, data_bit_length),
-           NATIVE_F(spi_connection, data_bit_length), IMM(5)),
-        END(),
-    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_UART), IMM(8)),
-        OP(BIT_FIELD_2, AML_F(serial, type_specific_flags),
-           NATIVE_F(uart_connection, flow_control), IMM(0)),
-        OP(BIT_FIELD_2, AML_F(serial, type_specific_flags),
-           NATIVE_F(uart_connection, stop_bits), IMM(2)),
-        OP(BIT_FIELD_3, AML_F(serial, type_specific_flags),
-           NATIVE_F(uart_connection, data_bits), IMM(4)),
-        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),
-           NATIVE_F(uart_connection, endianness), IMM(7)),
-        OP(FIELD_32, AML_F(serial_uart, baud_rate),
-           NATIVE_F(uart_connection, baud_rate), IMM(0xFF)),
-        OP(FIELD_16, AML_F(serial_uart, rx_fifo),
-           NATIVE_F(uart_connection, rx_fifo), IMM(2)),
-        OP(FIELD_8, AML_F(serial_uart, parity),
-           NATIVE_F(uart_connection, parity), IMM(2)),
-        END(),
-    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_CSI2), IMM(3)),
-        OP(BIT_FIELD_2, AML_F(serial, type_specific_flags),
-           NATIVE_F(csi2_connection, phy_type), IMM(0)),
-        OP(BIT_FIELD_6, AML_F(serial, type_specific_flags),
-           NATIVE_F(csi2_connection, local_port), IMM(2)),
-        END(),
+#define CONVERT_GENERIC_SERIAL_BUS_PROGRAM                                    \
+    OP(FIELD_8, AML_F(serial, revision_id),                                   \
+       NATIVE_F(serial_bus_common, revision_id)),                             \
+    OP(FIELD_8, AML_F(serial, type_specific_revision_id),                     \
+       NATIVE_F(serial_bus_common, type_revision_id)),                        \
+    OP(FIELD_8, AML_F(serial, source_index),                                  \
+       NATIVE_F(serial_bus_common, source.index)),                            \
+    OP(FIELD_16, AML_F(serial, type_data_length),                             \
+       NATIVE_F(serial_bus_common, type_data_length)),                        \
+    OP(BIT_FIELD_1, AML_F(serial, flags),                                     \
+       NATIVE_F(serial_bus_common, mode), IMM(0)),                            \
+    OP(BIT_FIELD_1, AML_F(serial, flags),                                     \
+       NATIVE_F(serial_bus_common, direction), IMM(1)),                       \
+    OP(BIT_FIELD_1, AML_F(serial, flags),                                     \
+       NATIVE_F(serial_bus_common, sharing), IMM(2)),                         \
+    OP(SERIAL_TYPE_SPECIFIC, AML_F(serial, type),                             \
+       NATIVE_F(serial_bus_common, type)),                                    \
+    OP(RESOURCE_SOURCE_NO_INDEX, NATIVE_F(serial_bus_common, source)),        \
+    OP(LOAD_8_NATIVE, NATIVE_F(serial_bus_common, type)),                     \
+    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_I2C), IMM(4)),               \
+        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(i2c_connection, addressing_mode), IMM(0)),                \
+        OP(FIELD_32, AML_F(serial_i2c, connection_speed),                     \
+           NATIVE_F(i2c_connection, connection_speed), IMM(0xFF)),            \
+        OP(FIELD_16, AML_F(serial_i2c, slave_address),                        \
+           NATIVE_F(i2c_connection, slave_address)),                          \
+        END(),                                                                \
+    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_SPI), IMM(5)),               \
+        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(spi_connection, wire_mode), IMM(0)),                      \
+        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(spi_connection, device_polarity), IMM(1)),                \
+        OP(FIELD_32, AML_F(serial_spi, connection_speed),                     \
+           NATIVE_F(spi_connection, connection_speed), IMM(0xFF)),            \
+        OP(FIELD_8, AML_F(serial_spi, data_bit_length),                       \
+           NATIVE_F(spi_connection, data_bit_length), IMM(5)),                \
+        END(),                                                                \
+    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_UART), IMM(8)),              \
+        OP(BIT_FIELD_2, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(uart_connection, flow_control), IMM(0)),                  \
+        OP(BIT_FIELD_2, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(uart_connection, stop_bits), IMM(2)),                     \
+        OP(BIT_FIELD_3, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(uart_connection, data_bits), IMM(4)),                     \
+        OP(BIT_FIELD_1, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(uart_connection, endianness), IMM(7)),                    \
+        OP(FIELD_32, AML_F(serial_uart, baud_rate),                           \
+           NATIVE_F(uart_connection, baud_rate), IMM(0xFF)),                  \
+        OP(FIELD_16, AML_F(serial_uart, rx_fifo),                             \
+           NATIVE_F(uart_connection, rx_fifo), IMM(2)),                       \
+        OP(FIELD_8, AML_F(serial_uart, parity),                               \
+           NATIVE_F(uart_connection, parity), IMM(2)),                        \
+        END(),                                                                \
+    OP(SKIP_IF_NOT_EQUALS, ARG0(ACPI_SERIAL_TYPE_CSI2), IMM(3)),              \
+        OP(BIT_FIELD_2, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(csi2_connection, phy_type), IMM(0)),                      \
+        OP(BIT_FIELD_6, AML_F(serial, type_specific_flags),                   \
+           NATIVE_F(csi2_connection, local_port), IMM(2)),                    \
+        END(),                                                                \
+                                                                              \
+    /*                                                                        \
+     * Insert a trap to catch unimplemented types, this should be unreachable \
+     * because of validation earlier.                                         \
+     */                                                                       \
+    OP(UNREACHABLE)
 
-    /*
-     * Insert a trap to catch unimplemented types, this should be unreachable
-     * because of validation earlier.
-     */
-    OP(UNREACHABLE),
-};
+/*
+ * Every conversion program is listed here, which allows expanding them both
+ * into instruction tables and into specialized converters, see
+ * UACPI_SPECIALIZED_RESOURCE_CONVERTERS.
+ */
+#define ENUMERATE_CONVERSION_PROGRAMS                                        \
+    CONVERSION_PROGRAM(irq_to_native, IRQ_TO_NATIVE)                         \
+    CONVERSION_PROGRAM(irq_to_aml, IRQ_TO_AML)                               \
+    CONVERSION_PROGRAM(dma, DMA)                                             \
+    CONVERSION_PROGRAM(start_dependent_to_native, START_DEPENDENT_TO_NATIVE) \
+    CONVERSION_PROGRAM(start_dependent_to_aml, START_DEPENDENT_TO_AML)       \
+    CONVERSION_PROGRAM(io, IO)                                               \
+    CONVERSION_PROGRAM(fixed_io, FIXED_IO)                                   \
+    CONVERSION_PROGRAM(fixed_dma, FIXED_DMA)                                 \
+    CONVERSION_PROGRAM(vendor_type0, VENDOR_TYPE0)                           \
+    CONVERSION_PROGRAM(vendor_type1, VENDOR_TYPE1)                           \
+    CONVERSION_PROGRAM(memory24, MEMORY24)                                   \
+    CONVERSION_PROGRAM(memory32, MEMORY32)                                   \
+    CONVERSION_PROGRAM(fixed_memory32, FIXED_MEMORY32)                       \
+    CONVERSION_PROGRAM(generic_register, GENERIC_REGISTER)                   \
+    CONVERSION_PROGRAM(address16, ADDRESS16)                                 \
+    CONVERSION_PROGRAM(address32, ADDRESS32)                                 \
+    CONVERSION_PROGRAM(address64, ADDRESS64)                                 \
+    CONVERSION_PROGRAM(address64_extended, ADDRESS64_EXTENDED)               \
+    CONVERSION_PROGRAM(extended_irq, EXTENDED_IRQ)                           \
+    CONVERSION_PROGRAM(clock_input, CLOCK_INPUT)                             \
+    CONVERSION_PROGRAM(gpio_connection, GPIO_CONNECTION)                     \
+    CONVERSION_PROGRAM(pin_function, PIN_FUNCTION)                           \
+    CONVERSION_PROGRAM(pin_configuration, PIN_CONFIGURATION)                 \
+    CONVERSION_PROGRAM(pin_group, PIN_GROUP)                                 \
+    CONVERSION_PROGRAM(pin_group_function, PIN_GROUP_FUNCTION)               \
+    CONVERSION_PROGRAM(pin_group_configuration, PIN_GROUP_CONFIGURATION)     \
+    CONVERSION_PROGRAM(generic_serial_bus, GENERIC_SERIAL_BUS)
+
+#define CONVERSION_PROGRAM(name, program)                               \
+    static const struct uacpi_resource_convert_instruction              \
+    convert_##name[] = {                                                \
+        CONVERT_##program##_PROGRAM                                     \
+    };
+ENUMERATE_CONVERSION_PROGRAMS
+#undef CONVERSION_PROGRAM
+
+#ifdef UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+#define CONVERSION_PROGRAM(name, program)                             \
+    static UACPI_MAYBE_UNUSED uacpi_iteration_decision                \
+    convert_##name##_to_native(struct uacpi_resource_convert_state*); \
+    static UACPI_MAYBE_UNUSED uacpi_iteration_decision                \
+    convert_##name##_to_aml(struct uacpi_resource_convert_state*);
+ENUMERATE_CONVERSION_PROGRAMS
+#undef CONVERSION_PROGRAM
+
+static uacpi_bool g_force_interpreter;
+
+void uacpi_resources_force_interpreter(uacpi_bool enabled)
+{
+    g_force_interpreter = enabled;
+}
+
+#define TO_NATIVE(program) \
+    .to_native = program, .to_native_specialized = program##_to_native
+#define TO_AML(program) \
+    .to_aml = program, .to_aml_specialized = program##_to_aml
+#else
+#define TO_NATIVE(program) .to_native = program
+#define TO_AML(program) .to_aml = program
+#endif
 
 #define NATIVE_RESOURCE_HEADER_SIZE 8
 
@@ -1093,8 +1138,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED_OR_ONE_LESS,
         .extra_size_for_native = extra_size_for_native_irq_or_dma,
         .size_for_aml = size_for_aml_irq,
-        .to_native = convert_irq_to_native,
-        .to_aml = convert_irq_to_aml,
+        TO_NATIVE(convert_irq_to_native),
+        TO_AML(convert_irq_to_aml),
     ),
     DEFINE_SMALL_AML_RESOURCE(
         UACPI_AML_RESOURCE_DMA,
@@ -1103,8 +1148,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         uacpi_resource_dma,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
         .extra_size_for_native = extra_size_for_native_irq_or_dma,
-        .to_native = convert_dma,
-        .to_aml = convert_dma,
+        TO_NATIVE(convert_dma),
+        TO_AML(convert_dma),
     ),
     DEFINE_SMALL_AML_RESOURCE(
         UACPI_AML_RESOURCE_START_DEPENDENT,
@@ -1113,8 +1158,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         uacpi_resource_start_dependent,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED_OR_ONE_LESS,
         .size_for_aml = size_for_aml_start_dependent,
-        .to_native = convert_start_dependent_to_native,
-        .to_aml = convert_start_dependent_to_aml,
+        TO_NATIVE(convert_start_dependent_to_native),
+        TO_AML(convert_start_dependent_to_aml),
     ),
     DEFINE_SMALL_AML_RESOURCE_NO_NATIVE_REPR(
         UACPI_AML_RESOURCE_END_DEPENDENT,
@@ -1128,8 +1173,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_io,
         uacpi_resource_io,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_io,
-        .to_aml = convert_io,
+        TO_NATIVE(convert_io),
+        TO_AML(convert_io),
     ),
     DEFINE_SMALL_AML_RESOURCE(
         UACPI_AML_RESOURCE_FIXED_IO,
@@ -1137,8 +1182,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_fixed_io,
         uacpi_resource_fixed_io,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_fixed_io,
-        .to_aml = convert_fixed_io,
+        TO_NATIVE(convert_fixed_io),
+        TO_AML(convert_fixed_io),
     ),
     DEFINE_SMALL_AML_RESOURCE(
         UACPI_AML_RESOURCE_FIXED_DMA,
@@ -1146,8 +1191,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_fixed_dma,
         uacpi_resource_fixed_dma,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_fixed_dma,
-        .to_aml = convert_fixed_dma,
+        TO_NATIVE(convert_fixed_dma),
+        TO_AML(convert_fixed_dma),
     ),
     DEFINE_SMALL_AML_RESOURCE(
         UACPI_AML_RESOURCE_VENDOR_TYPE0,
@@ -1157,8 +1202,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .size_for_aml = size_for_aml_vendor,
         .extra_size_for_native = extra_size_for_native_vendor,
-        .to_native = convert_vendor_type0,
-        .to_aml = convert_vendor_type0,
+        TO_NATIVE(convert_vendor_type0),
+        TO_AML(convert_vendor_type0),
     ),
     DEFINE_SMALL_AML_RESOURCE_NO_NATIVE_REPR(
         UACPI_AML_RESOURCE_END_TAG,
@@ -1172,8 +1217,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_memory24,
         uacpi_resource_memory24,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_memory24,
-        .to_aml = convert_memory24,
+        TO_NATIVE(convert_memory24),
+        TO_AML(convert_memory24),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_GENERIC_REGISTER,
@@ -1181,8 +1226,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_generic_register,
         uacpi_resource_generic_register,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_generic_register,
-        .to_aml = convert_generic_register,
+        TO_NATIVE(convert_generic_register),
+        TO_AML(convert_generic_register),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_VENDOR_TYPE1,
@@ -1192,8 +1237,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_vendor,
         .size_for_aml = size_for_aml_vendor,
-        .to_native = convert_vendor_type1,
-        .to_aml = convert_vendor_type1,
+        TO_NATIVE(convert_vendor_type1),
+        TO_AML(convert_vendor_type1),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_MEMORY32,
@@ -1201,8 +1246,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_memory32,
         uacpi_resource_memory32,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_memory32,
-        .to_aml = convert_memory32,
+        TO_NATIVE(convert_memory32),
+        TO_AML(convert_memory32),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_FIXED_MEMORY32,
@@ -1210,8 +1255,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_fixed_memory32,
         uacpi_resource_fixed_memory32,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_fixed_memory32,
-        .to_aml = convert_fixed_memory32,
+        TO_NATIVE(convert_fixed_memory32),
+        TO_AML(convert_fixed_memory32),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_ADDRESS32,
@@ -1221,8 +1266,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_address_or_clock_input,
         .size_for_aml = size_for_aml_address_or_clock_input,
-        .to_native = convert_address32,
-        .to_aml = convert_address32,
+        TO_NATIVE(convert_address32),
+        TO_AML(convert_address32),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_ADDRESS16,
@@ -1232,8 +1277,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_address_or_clock_input,
         .size_for_aml = size_for_aml_address_or_clock_input,
-        .to_native = convert_address16,
-        .to_aml = convert_address16,
+        TO_NATIVE(convert_address16),
+        TO_AML(convert_address16),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_EXTENDED_IRQ,
@@ -1243,8 +1288,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_extended_irq,
         .size_for_aml = size_for_aml_extended_irq,
-        .to_native = convert_extended_irq,
-        .to_aml = convert_extended_irq,
+        TO_NATIVE(convert_extended_irq),
+        TO_AML(convert_extended_irq),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_ADDRESS64,
@@ -1254,8 +1299,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_address_or_clock_input,
         .size_for_aml = size_for_aml_address_or_clock_input,
-        .to_native = convert_address64,
-        .to_aml = convert_address64,
+        TO_NATIVE(convert_address64),
+        TO_AML(convert_address64),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_ADDRESS64_EXTENDED,
@@ -1263,8 +1308,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         struct acpi_resource_address64_extended,
         uacpi_resource_address64_extended,
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_FIXED,
-        .to_native = convert_address64_extended,
-        .to_aml = convert_address64_extended,
+        TO_NATIVE(convert_address64_extended),
+        TO_AML(convert_address64_extended),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_GPIO_CONNECTION,
@@ -1274,8 +1319,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_gpio_or_pins,
         .size_for_aml = size_for_aml_gpio_or_pins,
-        .to_aml = convert_gpio_connection,
-        .to_native = convert_gpio_connection,
+        TO_AML(convert_gpio_connection),
+        TO_NATIVE(convert_gpio_connection),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_PIN_FUNCTION,
@@ -1285,8 +1330,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_gpio_or_pins,
         .size_for_aml = size_for_aml_gpio_or_pins,
-        .to_aml = convert_pin_function,
-        .to_native = convert_pin_function,
+        TO_AML(convert_pin_function),
+        TO_NATIVE(convert_pin_function),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_SERIAL_CONNECTION,
@@ -1296,8 +1341,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_serial_connection,
         .size_for_aml = aml_size_for_serial_connection,
-        .to_native = convert_generic_serial_bus,
-        .to_aml = convert_generic_serial_bus,
+        TO_NATIVE(convert_generic_serial_bus),
+        TO_AML(convert_generic_serial_bus),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_PIN_CONFIGURATION,
@@ -1307,8 +1352,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_gpio_or_pins,
         .size_for_aml = size_for_aml_gpio_or_pins,
-        .to_native = convert_pin_configuration,
-        .to_aml = convert_pin_configuration,
+        TO_NATIVE(convert_pin_configuration),
+        TO_AML(convert_pin_configuration),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_PIN_GROUP,
@@ -1318,8 +1363,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_gpio_or_pins,
         .size_for_aml = size_for_aml_gpio_or_pins,
-        .to_native = convert_pin_group,
-        .to_aml = convert_pin_group,
+        TO_NATIVE(convert_pin_group),
+        TO_AML(convert_pin_group),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_PIN_GROUP_FUNCTION,
@@ -1329,8 +1374,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_pin_group,
         .size_for_aml = size_for_aml_pin_group,
-        .to_native = convert_pin_group_function,
-        .to_aml = convert_pin_group_function,
+        TO_NATIVE(convert_pin_group_function),
+        TO_AML(convert_pin_group_function),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_PIN_GROUP_CONFIGURATION,
@@ -1340,8 +1385,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_pin_group,
         .size_for_aml = size_for_aml_pin_group,
-        .to_native = convert_pin_group_configuration,
-        .to_aml = convert_pin_group_configuration,
+        TO_NATIVE(convert_pin_group_configuration),
+        TO_AML(convert_pin_group_configuration),
     ),
     DEFINE_LARGE_AML_RESOURCE(
         UACPI_AML_RESOURCE_CLOCK_INPUT,
@@ -1351,8 +1396,8 @@ const struct uacpi_resource_spec aml_resources[UACPI_AML_RESOURCE_MAX + 1] = {
         .size_kind =  UACPI_AML_RESOURCE_SIZE_KIND_VARIABLE,
         .extra_size_for_native = extra_size_for_native_address_or_clock_input,
         .size_for_aml = size_for_aml_address_or_clock_input,
-        .to_native = convert_clock_input,
-        .to_aml = convert_clock_input,
+        TO_NATIVE(convert_clock_input),
+        TO_AML(convert_clock_input),
     ),
 };
 
@@ -1540,18 +1585,102 @@ uacpi_status uacpi_find_aml_resource_end_tag(
     return UACPI_STATUS_OK;
 }
 
+/*
+ * All resource lists handed out by uACPI are reference counted, so that the
+ * same list can be shared between the per-device cache and its users.
+ */
+struct resources_storage {
+    struct uacpi_shareable shareable;
+
+    // Size of the allocation following the header, >= resources.length
+    uacpi_size capacity;
+    uacpi_resources resources;
+};
+
+static uacpi_resources *resources_alloc(uacpi_size length)
+{
+    struct resources_storage *storage;
+
+    storage = uacpi_kernel_alloc(sizeof(*storage) + length);
+    if (uacpi_unlikely(storage == UACPI_NULL))
+        return UACPI_NULL;
+
+    uacpi_shareable_init(storage);
+    storage->capacity = length;
+    storage->resources.length = length;
+    storage->resources.entries = UACPI_PTR_ADD(storage, sizeof(*storage));
+
+    return &storage->resources;
+}
+
+/*
+ * Conversions are done in a single pass, the output buffer is grown on demand
+ * as resources are appended to it, see reserve_native_output and
+ * reserve_aml_output.
+ */
 struct resource_conversion_ctx {
     union {
         void *buf;
         uacpi_u8 *byte_buf;
-        uacpi_size size;
     };
     uacpi_status st;
+
+    uacpi_u8 *base;
+    uacpi_size capacity;
+
+    union {
+        uacpi_resources *resources;
+        uacpi_buffer *aml_buffer;
+    };
+};
+
+// Realistically any resource buffer bigger than this is probably a bug
+#define MAX_RESOURCE_BUFFER_SIZE (5 * 1024u * 1024u)
+
+/*
+ * State of a single resource being converted, shared by the conversion program
+ * interpreter and the specialized converters.
+ */
+struct uacpi_resource_convert_state {
+    struct resource_conversion_ctx *ctx;
+    const struct uacpi_resource_spec *spec;
+    uacpi_resource *resource;
+
+    // The AML resource, including the header
+    uacpi_u8 *aml;
+    void *resource_end;
+
+    // Size of the AML resource, excluding the header
+    uacpi_u32 aml_size;
+    uacpi_u32 base_aml_size;
+    uacpi_u32 base_aml_size_with_header;
+    uacpi_u32 accumulator;
+    uacpi_u8 header_size;
+
+    // Number of instructions to skip, set by the SKIP_IF_* opcodes
+    uacpi_u8 skip;
+    uacpi_bool done;
 };
 
+/*
+ * Conversion steps never take the address of a state field, this way the
+ * compiler is able to keep the entire state in registers once the steps are
+ * inlined into a specialized converter.
+ */
+static UACPI_ALWAYS_INLINE uacpi_u32 load_u32_zerout(
+    const void *src, uacpi_size bytes
+)
+{
+    uacpi_u32 value;
+
+    uacpi_memcpy_zerout(&value, src, sizeof(value), bytes);
+    return value;
+}
+
 // Opcodes that are the same for both AML->native and native->AML
 #define CONVERSION_OPCODES_COMMON(native_buf)                                \
     case UACPI_RESOURCE_CONVERT_OPCODE_END:                                  \
+        state->done = UACPI_TRUE;                                            \
         return UACPI_ITERATION_DECISION_CONTINUE;                            \
                                                                              \
     case UACPI_RESOURCE_CONVERT_OPCODE_FIELD_8:                              \
@@ -1561,20 +1690,21 @@ struct resource_conversion_ctx {
         uacpi_u8 bytes;                                                      \
                                                                              \
         bytes = 1 << (insn->code - UACPI_RESOURCE_CONVERT_OPCODE_FIELD_8);   \
-        accumulator = insn->imm == 0xFF ? 0 : accumulator + insn->imm;       \
+        state->accumulator = insn->imm == 0xFF ?                             \
+            0 : state->accumulator + insn->imm;                              \
                                                                              \
-        uacpi_memcpy(dst, src, bytes * UACPI_MAX(1, accumulator));           \
-        accumulator = 0;                                                     \
+        uacpi_memcpy(dst, src, bytes * UACPI_MAX(1, state->accumulator));    \
+        state->accumulator = 0;                                              \
         break;                                                               \
     }                                                                        \
                                                                              \
     case UACPI_RESOURCE_CONVERT_OPCODE_SKIP_IF_AML_SIZE_LESS_THAN:           \
         if (aml_size < insn->arg0)                                           \
-            pc += insn->imm;                                                 \
+            state->skip = insn->imm;                                         \
         break;                                                               \
     case UACPI_RESOURCE_CONVERT_OPCODE_SKIP_IF_NOT_EQUALS:                   \
-        if (insn->arg0 != accumulator)                                       \
-            pc += insn->imm;                                                 \
+        if (insn->arg0 != state->accumulator)                                \
+            state->skip = insn->imm;                                         \
         break;                                                               \
                                                                              \
     case UACPI_RESOURCE_CONVERT_OPCODE_SET_TO_IMM:                           \
@@ -1582,16 +1712,19 @@ struct resource_conversion_ctx {
         break;                                                               \
                                                                              \
     case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_IMM:                             \
-        accumulator = insn->imm;                                             \
+        state->accumulator = insn->imm;                                      \
         break;                                                               \
                                                                              \
-    case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_8_STORE:                         \
-        uacpi_memcpy_zerout(&accumulator, src, sizeof(accumulator), 1);      \
-        uacpi_memcpy(dst, &accumulator, 1);                                  \
+    case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_8_STORE: {                       \
+        uacpi_u32 value = load_u32_zerout(src, 1);                           \
+                                                                             \
+        uacpi_memcpy(dst, &value, 1);                                        \
                                                                              \
         if (insn->imm)                                                       \
-            accumulator *= insn->imm;                                        \
+            value *= insn->imm;                                              \
+        state->accumulator = value;                                          \
         break;                                                               \
+    }                                                                        \
                                                                              \
     case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_8_NATIVE:                        \
     case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_16_NATIVE: {                     \
@@ -1599,9 +1732,7 @@ struct resource_conversion_ctx {
                                                                              \
         bytes =                                                              \
             1 << (insn->code - UACPI_RESOURCE_CONVERT_OPCODE_LOAD_8_NATIVE); \
-        uacpi_memcpy_zerout(                                                 \
-            &accumulator, native_buf, sizeof(accumulator), bytes             \
-        );                                                                   \
+        state->accumulator = load_u32_zerout(native_buf, bytes);             \
         break;                                                               \
     }                                                                        \
                                                                              \
@@ -1633,10 +1764,10 @@ struct resource_conversion_ctx {
     }
 
 #define CHECK_AML_OFFSET_BASE(offset, what)                             \
-    if (uacpi_unlikely(offset < base_aml_size_with_header)) {           \
+    if (uacpi_unlikely(offset < state->base_aml_size_with_header)) {    \
         uacpi_error(                                                    \
             "invalid " what " offset: %zu, expected at least %u\n",     \
-            (uacpi_size)offset, base_aml_size_with_header);             \
+            (uacpi_size)offset, state->base_aml_size_with_header);      \
         ctx->st = UACPI_STATUS_AML_INVALID_RESOURCE;                    \
         return UACPI_ITERATION_DECISION_BREAK;                          \
     }
@@ -1645,319 +1776,453 @@ struct resource_conversion_ctx {
     CHECK_AML_OOB(offset, "end of ", what) \
     CHECK_AML_OFFSET_BASE(offset, what)
 
-static uacpi_resource_type aml_serial_to_native_type(
-        uacpi_u8 type
+static const struct uacpi_resource_spec *resource_spec_from_native(
+        uacpi_resource *resource
 )
 {
-    return (type - ACPI_SERIAL_TYPE_I2C) +
-           UACPI_RESOURCE_TYPE_SERIAL_I2C_CONNECTION;
+    return &aml_resources[native_resource_to_type[resource->type]];
 }
 
-static uacpi_iteration_decision do_aml_resource_to_native(
-    void *opaque, uacpi_u8 *data, uacpi_u16 aml_size,
-    const struct uacpi_resource_spec *spec
+static void rebase_pointer(void *slot, void *old_base, void *new_base)
+{
+    uacpi_u8 *ptr;
+
+    uacpi_memcpy(&ptr, slot, sizeof(ptr));
+    if (ptr == UACPI_NULL)
+        return;
+
+    ptr = (uacpi_u8*)new_base + (ptr - (uacpi_u8*)old_base);
+    uacpi_memcpy(slot, &ptr, sizeof(ptr));
+}
+
+/*
+ * Native resources contain pointers into their own buffer: resource source
+ * strings, labels, pin tables and vendor data. Find those via the conversion
+ * programs and rebase them after the buffer has been moved to 'buf'.
+ */
+static void rebase_native_resources(
+    void *buf, uacpi_size length, void *old_base
 )
 {
-    struct resource_conversion_ctx *ctx = opaque;
-    uacpi_resource *resource = ctx->buf;
-    const struct uacpi_resource_convert_instruction *insns, *insn;
-    uacpi_u8 header_size, pc = 0;
-    uacpi_u8 *src, *dst;
-    void *resource_end;
-    uacpi_u16 base_aml_size;
-    uacpi_u32 base_aml_size_with_header, accumulator = 0;
+    const struct uacpi_resource_convert_instruction *insn;
+    uacpi_resource *resource;
+    uacpi_size offset;
+    void *slot;
+
+    for (offset = 0; offset < length; offset += resource->length) {
+        resource = UACPI_PTR_ADD(buf, offset);
+        insn = resource_spec_from_native(resource)->to_native;
+
+        for (; insn && insn->code != UACPI_RESOURCE_CONVERT_OPCODE_END;
+             ++insn) {
+            switch (insn->code) {
+            case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE:
+            case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE_NO_INDEX:
+                slot = NATIVE_OFFSET(
+                    resource, insn->native_offset +
+                    uacpi_offsetof(uacpi_resource_source, string)
+                );
+                break;
+            case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL:
+                slot = NATIVE_OFFSET(
+                    resource, insn->native_offset +
+                    uacpi_offsetof(uacpi_resource_label, string)
+                );
+                break;
+            case UACPI_RESOURCE_CONVERT_OPCODE_PIN_TABLE:
+            case UACPI_RESOURCE_CONVERT_OPCODE_VENDOR_DATA:
+                slot = NATIVE_OFFSET(resource, insn->arg2);
+                break;
+            case UACPI_RESOURCE_CONVERT_OPCODE_SERIAL_TYPE_SPECIFIC:
+                slot = &resource->serial_bus_common.vendor_data;
+                break;
+            default:
+                continue;
+            }
 
-    insns = spec->to_native;
+            rebase_pointer(slot, old_base, buf);
+        }
+    }
+}
 
-    header_size = aml_resource_kind_to_header_size[spec->resource_kind];
-    resource->type = spec->native_type;
-    resource->length = native_size_for_aml_resource(data, aml_size, spec);
-    resource_end = ctx->byte_buf + spec->native_size;
-    ctx->byte_buf += resource->length;
+static uacpi_resources *move_native_resources(
+    uacpi_resources *resources, uacpi_size used, uacpi_size capacity
+)
+{
+    uacpi_resources *new_resources;
 
-    base_aml_size = base_aml_size_with_header = spec->aml_size;
-    base_aml_size_with_header += header_size;
+    new_resources = resources_alloc(capacity);
+    if (uacpi_unlikely(new_resources == UACPI_NULL))
+        return UACPI_NULL;
 
-    if (insns == UACPI_NULL)
-        return UACPI_ITERATION_DECISION_CONTINUE;
+    uacpi_memcpy(new_resources->entries, resources->entries, used);
+    rebase_native_resources(new_resources->entries, used, resources->entries);
+    uacpi_free_resources(resources);
 
-    for (;;) {
-        insn = &insns[pc++];
-
-        src = data + insn->aml_offset;
-        dst = NATIVE_OFFSET(resource, insn->native_offset);
-
-        switch (insn->code) {
-        case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_8:
-        case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16: {
-            uacpi_size i, j, max_bit;
-            uacpi_u16 value;
-
-            if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16) {
-                max_bit = 16;
-                uacpi_memcpy(&value, src, sizeof(uacpi_u16));
-            } else {
-                max_bit = 8;
-                uacpi_memcpy_zerout(
-                    &value, src, sizeof(value), sizeof(uacpi_u8)
-                );
-            }
+    return new_resources;
+}
 
-            for (i = 0, j = 0; i < max_bit; ++i) {
-                if (!(value & (1 << i)))
-                    continue;
+static uacpi_bool reserve_native_output(
+    struct resource_conversion_ctx *ctx, uacpi_size size
+)
+{
+    uacpi_size used, capacity;
+    uacpi_resources *resources;
 
-                dst[j++] = i;
-            }
+    used = ctx->byte_buf - ctx->base;
+    if (uacpi_likely(size <= ctx->capacity - used))
+        goto out;
 
-            uacpi_memcpy(NATIVE_OFFSET(resource, insn->arg2), &j, 1);
-            break;
-        }
+    // Caller-provided buffer, see uacpi_for_each_device_resource_of_type
+    if (ctx->resources == UACPI_NULL) {
+        uacpi_warn("resource doesn't fit into the buffer: %zu > %zu\n",
+                   size, ctx->capacity);
+        ctx->st = UACPI_STATUS_INVALID_ARGUMENT;
+        return UACPI_FALSE;
+    }
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_1:
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_2:
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_3:
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_6:{
-            uacpi_u8 mask, value;
+    if (uacpi_unlikely(used + size > MAX_RESOURCE_BUFFER_SIZE)) {
+        uacpi_error("bug: bogus native resource buffer size %zu\n",
+                    used + size);
+        ctx->st = UACPI_STATUS_INTERNAL_ERROR;
+        return UACPI_FALSE;
+    }
 
-            mask = (insn->code - UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_1) + 1;
-            mask = (1 << mask) - 1;
+    capacity = UACPI_MAX(ctx->capacity * 2, used + size);
+    capacity = UACPI_MIN(capacity, MAX_RESOURCE_BUFFER_SIZE);
 
-            value = (*src >> insn->imm) & mask;
-            uacpi_memcpy(dst, &value, sizeof(value));
-            break;
-        }
+    resources = move_native_resources(ctx->resources, used, capacity);
+    if (uacpi_unlikely(resources == UACPI_NULL)) {
+        ctx->st = UACPI_STATUS_OUT_OF_MEMORY;
+        return UACPI_FALSE;
+    }
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_AML_SIZE_32:
-            accumulator = aml_size;
-            uacpi_memcpy(dst, &accumulator, 4);
-            break;
+    ctx->resources = resources;
+    ctx->base = (uacpi_u8*)resources->entries;
+    ctx->byte_buf = ctx->base + used;
+    ctx->capacity = capacity;
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE:
-        case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE_NO_INDEX:
-        case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL: {
-            uacpi_size offset = 0, max_offset, length = 0;
-            uacpi_char *src_string, *dst_string;
-            union {
-                void *ptr;
-                uacpi_resource_source *source;
-                uacpi_resource_label *label;
-            } dst_name = { .ptr = dst };
+out:
+    // Conversion programs only write the fields that are present
+    uacpi_memzero(ctx->byte_buf, size);
+    return UACPI_TRUE;
+}
 
-            /*
-             * Check if the string is bounded by anything at the top. If not, we
-             * just assume it ends at the end of the resource.
-             */
-            if (insn->arg2) {
-                uacpi_memcpy_zerout(&max_offset, data + insn->arg2,
-                                    sizeof(max_offset), sizeof(uacpi_u16));
-                CHECK_AML_OFFSET(max_offset, "resource source");
-            } else {
-                max_offset = aml_size + header_size;
-            }
+static uacpi_resource_type aml_serial_to_native_type(
+        uacpi_u8 type
+)
+{
+    return (type - ACPI_SERIAL_TYPE_I2C) +
+           UACPI_RESOURCE_TYPE_SERIAL_I2C_CONNECTION;
+}
 
-            offset += base_aml_size_with_header;
-            offset += accumulator;
+static UACPI_ALWAYS_INLINE uacpi_iteration_decision aml_to_native_step(
+    struct uacpi_resource_convert_state *state,
+    const struct uacpi_resource_convert_instruction *insn
+)
+{
+    struct resource_conversion_ctx *ctx = state->ctx;
+    uacpi_resource *resource = state->resource;
+    uacpi_u8 *data = state->aml;
+    uacpi_u32 aml_size = state->aml_size;
+    uacpi_u8 header_size = state->header_size;
+    uacpi_u8 *src, *dst;
 
-            if (insn->code != UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL)
-                dst_name.source->index_present = UACPI_TRUE;
+    src = data + insn->aml_offset;
+    dst = NATIVE_OFFSET(resource, insn->native_offset);
+
+    switch (insn->code) {
+    case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_8:
+    case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16: {
+        uacpi_size i, j, max_bit;
+        uacpi_u16 value;
+
+        if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16) {
+            max_bit = 16;
+            uacpi_memcpy(&value, src, sizeof(uacpi_u16));
+        } else {
+            max_bit = 8;
+            uacpi_memcpy_zerout(
+                &value, src, sizeof(value), sizeof(uacpi_u8)
+            );
+        }
 
-            if (offset >= max_offset) {
-                if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE)
-                    dst_name.source->index_present = UACPI_FALSE;
-                break;
-            }
+        for (i = 0, j = 0; i < max_bit; ++i) {
+            if (!(value & (1 << i)))
+                continue;
 
-            src_string = PTR_AT(data, offset);
+            dst[j++] = i;
+        }
 
-            if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE) {
-                uacpi_memcpy(&dst_name.source->index, src_string++, 1);
-                offset++;
-            }
+        uacpi_memcpy(NATIVE_OFFSET(resource, insn->arg2), &j, 1);
+        break;
+    }
 
-            if (offset == max_offset)
-                break;
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_1:
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_2:
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_3:
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_6:{
+        uacpi_u8 mask, value;
 
-            while (offset++ < max_offset) {
-                if (src_string[length++] == '\0')
-                    break;
-            }
+        mask = (insn->code - UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_1) + 1;
+        mask = (1 << mask) - 1;
 
-            if (src_string[length - 1] != '\0') {
-                uacpi_error("non-null-terminated resource source string\n");
-                ctx->st = UACPI_STATUS_AML_INVALID_RESOURCE;
-                return UACPI_ITERATION_DECISION_BREAK;
-            }
+        value = (*src >> insn->imm) & mask;
+        uacpi_memcpy(dst, &value, sizeof(value));
+        break;
+    }
 
-            dst_string = PTR_AT(resource_end, accumulator);
-            uacpi_memcpy(dst_string, src_string, length);
+    case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_AML_SIZE_32: {
+        uacpi_u32 size = aml_size;
 
-            if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL) {
-                dst_name.label->length = length;
-                dst_name.label->string = dst_string;
-            } else {
-                dst_name.source->length = length;
-                dst_name.source->string = dst_string;
-            }
+        state->accumulator = size;
+        uacpi_memcpy(dst, &size, sizeof(size));
+        break;
+    }
 
-            break;
+    case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE:
+    case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE_NO_INDEX:
+    case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL: {
+        uacpi_size offset = 0, max_offset, length = 0;
+        uacpi_char *src_string, *dst_string;
+        union {
+            void *ptr;
+            uacpi_resource_source *source;
+            uacpi_resource_label *label;
+        } dst_name = { .ptr = dst };
+
+        /*
+         * Check if the string is bounded by anything at the top. If not, we
+         * just assume it ends at the end of the resource.
+         */
+        if (insn->arg2) {
+            uacpi_memcpy_zerout(&max_offset, data + insn->arg2,
+                                sizeof(max_offset), sizeof(uacpi_u16));
+            CHECK_AML_OFFSET(max_offset, "resource source");
+        } else {
+            max_offset = aml_size + header_size;
         }
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_PIN_TABLE_LENGTH:
-            uacpi_memcpy_zerout(&accumulator, src,
-                                sizeof(accumulator), sizeof(uacpi_u16));
-            CHECK_AML_OFFSET(accumulator, "pin table");
+        offset += state->base_aml_size_with_header;
+        offset += state->accumulator;
 
-            accumulator -= base_aml_size_with_header;
-            break;
+        if (insn->code != UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL)
+            dst_name.source->index_present = UACPI_TRUE;
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_PIN_TABLE: {
-            uacpi_u16 entry_count = accumulator / 2;
+        if (offset >= max_offset) {
+            if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE)
+                dst_name.source->index_present = UACPI_FALSE;
+            break;
+        }
 
-            /*
-             * Pin table is stored right at the end of the resource buffer,
-             * copy the data there.
-             */
-            uacpi_memcpy(
-                resource_end,
-                data + base_aml_size_with_header,
-                accumulator
-            );
+        src_string = PTR_AT(data, offset);
 
-            // Set pin_table_length
-            uacpi_memcpy(dst, &entry_count, sizeof(entry_count));
+        if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE) {
+            uacpi_memcpy(&dst_name.source->index, src_string++, 1);
+            offset++;
+        }
 
-            // Set pin_table pointer
-            uacpi_memcpy(NATIVE_OFFSET(resource, insn->arg2),
-                         &resource_end, sizeof(void*));
+        if (offset == max_offset)
             break;
+
+        while (offset++ < max_offset) {
+            if (src_string[length++] == '\0')
+                break;
         }
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_VENDOR_DATA: {
-            uacpi_size length;
-            uacpi_u16 data_offset, offset_from_end;
-            void *native_dst, *vendor_data;
+        if (src_string[length - 1] != '\0') {
+            uacpi_error("non-null-terminated resource source string\n");
+            ctx->st = UACPI_STATUS_AML_INVALID_RESOURCE;
+            return UACPI_ITERATION_DECISION_BREAK;
+        }
 
-            uacpi_memcpy(&data_offset, src, sizeof(data_offset));
-            CHECK_AML_OFFSET(data_offset, "vendor data");
+        dst_string = PTR_AT(state->resource_end, state->accumulator);
+        uacpi_memcpy(dst_string, src_string, length);
 
-            vendor_data = data + data_offset;
+        if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL) {
+            dst_name.label->length = length;
+            dst_name.label->string = dst_string;
+        } else {
+            dst_name.source->length = length;
+            dst_name.source->string = dst_string;
+        }
 
-            /*
-             * Rebase the offset to cut off the header as it's not included
-             * in the size fields.
-             */
-            data_offset -= header_size;
+        break;
+    }
 
-            length = aml_size - data_offset;
-            if (length == 0)
-                break;
+    case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_PIN_TABLE_LENGTH:
+        state->accumulator = load_u32_zerout(src, sizeof(uacpi_u16));
+        CHECK_AML_OFFSET(state->accumulator, "pin table");
 
-            uacpi_memcpy(dst, &length, sizeof(uacpi_u16));
+        state->accumulator -= state->base_aml_size_with_header;
+        break;
 
-            offset_from_end = data_offset - base_aml_size;
-            native_dst = PTR_AT(resource_end, offset_from_end);
+    case UACPI_RESOURCE_CONVERT_OPCODE_PIN_TABLE: {
+        uacpi_u16 entry_count = state->accumulator / 2;
+        void *pin_table = state->resource_end;
+
+        /*
+         * Pin table is stored right at the end of the resource buffer,
+         * copy the data there.
+         */
+        uacpi_memcpy(
+            pin_table,
+            data + state->base_aml_size_with_header,
+            state->accumulator
+        );
+
+        // Set pin_table_length
+        uacpi_memcpy(dst, &entry_count, sizeof(entry_count));
+
+        // Set pin_table pointer
+        uacpi_memcpy(NATIVE_OFFSET(resource, insn->arg2),
+                     &pin_table, sizeof(void*));
+        break;
+    }
 
-            uacpi_memcpy(native_dst, vendor_data, length);
-            uacpi_memcpy(NATIVE_OFFSET(resource, insn->arg2),
-                         &native_dst, sizeof(void*));
-            break;
-        }
+    case UACPI_RESOURCE_CONVERT_OPCODE_VENDOR_DATA: {
+        uacpi_size length;
+        uacpi_u16 data_offset, offset_from_end;
+        void *native_dst, *vendor_data;
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_SERIAL_TYPE_SPECIFIC: {
-            uacpi_resource_serial_bus_common *serial_bus_common;
-            uacpi_u8 serial_type, extra_size, type_length;
+        uacpi_memcpy(&data_offset, src, sizeof(data_offset));
+        CHECK_AML_OFFSET(data_offset, "vendor data");
 
-            serial_bus_common = &resource->serial_bus_common;
-            serial_type = *src;
-            serial_bus_common->type = serial_type;
-            resource->type = aml_serial_to_native_type(serial_type);
+        vendor_data = data + data_offset;
 
-            /*
-             * Now that we know the serial type rebase the end pointers and
-             * sizes.
-             */
-            resource_end = PTR_AT(
-                resource_end,
-                aml_serial_resource_to_extra_native_size[serial_type]
-            );
-            extra_size = aml_serial_resource_to_extra_aml_size[serial_type];
-            base_aml_size += extra_size;
-            base_aml_size_with_header += extra_size;
+        /*
+         * Rebase the offset to cut off the header as it's not included
+         * in the size fields.
+         */
+        data_offset -= header_size;
 
-            type_length = serial_bus_common->type_data_length;
-            if (uacpi_unlikely(type_length < extra_size)) {
-                uacpi_error(
-                    "invalid type-specific data length: %d, "
-                    "expected at least %d\n", type_length, extra_size
-                );
-                ctx->st = UACPI_STATUS_AML_INVALID_RESOURCE;
-                return UACPI_ITERATION_DECISION_BREAK;
-            }
+        length = aml_size - data_offset;
+        if (length == 0)
+            break;
 
-            /*
-             * Calculate the length of the vendor data. All the extra data
-             * beyond the end of type-specific size is considered vendor data.
-             */
-            accumulator = type_length - extra_size;
-            if (accumulator == 0)
-                break;
+        uacpi_memcpy(dst, &length, sizeof(uacpi_u16));
+
+        offset_from_end = data_offset - state->base_aml_size;
+        native_dst = PTR_AT(state->resource_end, offset_from_end);
+
+        uacpi_memcpy(native_dst, vendor_data, length);
+        uacpi_memcpy(NATIVE_OFFSET(resource, insn->arg2),
+                     &native_dst, sizeof(void*));
+        break;
+    }
 
-            serial_bus_common->vendor_data_length = accumulator;
-            serial_bus_common->vendor_data = resource_end;
-            uacpi_memcpy(
-                resource_end,
-                data + base_aml_size_with_header,
-                accumulator
+    case UACPI_RESOURCE_CONVERT_OPCODE_SERIAL_TYPE_SPECIFIC: {
+        uacpi_resource_serial_bus_common *serial_bus_common;
+        uacpi_u8 serial_type, extra_size, type_length;
+
+        serial_bus_common = &resource->serial_bus_common;
+        serial_type = *src;
+        serial_bus_common->type = serial_type;
+        resource->type = aml_serial_to_native_type(serial_type);
+
+        /*
+         * Now that we know the serial type rebase the end pointers and
+         * sizes.
+         */
+        state->resource_end = PTR_AT(
+            state->resource_end,
+            aml_serial_resource_to_extra_native_size[serial_type]
+        );
+        extra_size = aml_serial_resource_to_extra_aml_size[serial_type];
+        state->base_aml_size += extra_size;
+        state->base_aml_size_with_header += extra_size;
+
+        type_length = serial_bus_common->type_data_length;
+        if (uacpi_unlikely(type_length < extra_size)) {
+            uacpi_error(
+                "invalid type-specific data length: %d, "
+                "expected at least %d\n", type_length, extra_size
             );
-            break;
+            ctx->st = UACPI_STATUS_AML_INVALID_RESOURCE;
+            return UACPI_ITERATION_DECISION_BREAK;
         }
 
-        CONVERSION_OPCODES_COMMON(dst)
-        }
-    }
-}
+        /*
+         * Calculate the length of the vendor data. All the extra data
+         * beyond the end of type-specific size is considered vendor data.
+         */
+        state->accumulator = type_length - extra_size;
+        if (state->accumulator == 0)
+            break;
 
-static uacpi_status aml_resources_to_native(
-    uacpi_buffer *aml_buffer, void *native_buffer
-)
-{
-    uacpi_status ret;
-    struct resource_conversion_ctx ctx = {
-        .buf = native_buffer,
-    };
+        serial_bus_common->vendor_data_length = state->accumulator;
+        serial_bus_common->vendor_data = state->resource_end;
+        uacpi_memcpy(
+            state->resource_end,
+            data + state->base_aml_size_with_header,
+            state->accumulator
+        );
+        break;
+    }
 
-    ret = uacpi_for_each_aml_resource(
-        aml_buffer, do_aml_resource_to_native, &ctx
-    );
-    if (uacpi_unlikely_error(ret))
-        return ret;
+    CONVERSION_OPCODES_COMMON(dst)
+    }
 
-    return ctx.st;
+    return UACPI_ITERATION_DECISION_CONTINUE;
 }
 
-static uacpi_iteration_decision accumulate_native_buffer_size(
-    void *opaque, uacpi_u8 *data, uacpi_u16 resource_size,
+static uacpi_iteration_decision do_aml_resource_to_native(
+    void *opaque, uacpi_u8 *data, uacpi_u16 aml_size,
     const struct uacpi_resource_spec *spec
 )
 {
     struct resource_conversion_ctx *ctx = opaque;
-    uacpi_size size_for_this;
+    struct uacpi_resource_convert_state state;
+    const struct uacpi_resource_convert_instruction *insns;
+    uacpi_iteration_decision decision;
+    uacpi_resource *resource;
+    uacpi_size native_size;
+    uacpi_u8 pc = 0;
+
+    insns = spec->to_native;
 
-    size_for_this = native_size_for_aml_resource(data, resource_size, spec);
-    if (size_for_this == 0 || (ctx->size + size_for_this) < ctx->size) {
-        uacpi_error("invalid native size for aml resource: %zu\n",
-                    size_for_this);
-        ctx->st = UACPI_STATUS_AML_INVALID_RESOURCE;
+    native_size = native_size_for_aml_resource(data, aml_size, spec);
+    if (!reserve_native_output(ctx, native_size))
         return UACPI_ITERATION_DECISION_BREAK;
-    }
 
-    ctx->size += size_for_this;
-    return UACPI_ITERATION_DECISION_CONTINUE;
-}
+    resource = ctx->buf;
+    resource->type = spec->native_type;
+    resource->length = native_size;
+    ctx->byte_buf += resource->length;
 
-static uacpi_status eval_resource_helper(
-    uacpi_namespace_node *node, const uacpi_char *method,
+    state.ctx = ctx;
+    state.spec = spec;
+    state.resource = resource;
+    state.aml = data;
+    state.resource_end = PTR_AT(resource, spec->native_size);
+    state.aml_size = aml_size;
+    state.header_size = aml_resource_kind_to_header_size[spec->resource_kind];
+    state.base_aml_size = state.base_aml_size_with_header = spec->aml_size;
+    state.base_aml_size_with_header += state.header_size;
+    state.accumulator = 0;
+    state.skip = 0;
+    state.done = UACPI_FALSE;
+
+    if (insns == UACPI_NULL)
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+#ifdef UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+    if (!g_force_interpreter)
+        return spec->to_native_specialized(&state);
+#endif
+
+    for (;;) {
+        decision = aml_to_native_step(&state, &insns[pc++]);
+        if (decision != UACPI_ITERATION_DECISION_CONTINUE || state.done)
+            return decision;
+
+        pc += state.skip;
+        state.skip = 0;
+    }
+}
+
+static uacpi_status eval_resource_helper(
+    uacpi_namespace_node *node, const uacpi_char *method,
     uacpi_object **out_obj
 )
 {
@@ -1972,6 +2237,36 @@ static uacpi_status eval_resource_helper(
     );
 }
 
+static struct resources_storage *resources_to_storage(
+    uacpi_resources *resources
+)
+{
+    return (struct resources_storage*)(
+        (uacpi_u8*)resources -
+        uacpi_offsetof(struct resources_storage, resources)
+    );
+}
+
+static void resources_ref(uacpi_resources *resources)
+{
+    uacpi_shareable_ref(resources_to_storage(resources));
+}
+
+static void free_resources_storage(uacpi_handle handle)
+{
+    struct resources_storage *storage = handle;
+
+    uacpi_free(storage, sizeof(*storage) + storage->capacity);
+}
+
+/*
+ * Native resources are usually about twice as big as their AML counterparts,
+ * so start with that and grow if needed. Leftover space is only given back
+ * if it's worth the extra copy, as lists may be kept around in the cache.
+ */
+#define NATIVE_SIZE_ESTIMATE(aml_size) ((aml_size) * 2 + 64)
+#define NATIVE_SHRINK_THRESHOLD 128
+
 uacpi_status uacpi_native_resources_from_aml(
     uacpi_buffer *aml_buffer, uacpi_resources **out_resources
 )
@@ -1979,36 +2274,43 @@ uacpi_status uacpi_native_resources_from_aml(
     uacpi_status ret;
     struct resource_conversion_ctx ctx = { 0 };
     uacpi_resources *resources;
+    uacpi_size used, capacity;
+
+    capacity = NATIVE_SIZE_ESTIMATE(aml_buffer->size);
+    capacity = UACPI_MIN(capacity, MAX_RESOURCE_BUFFER_SIZE);
+
+    ctx.resources = resources_alloc(capacity);
+    if (uacpi_unlikely(ctx.resources == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    ctx.base = ctx.buf = ctx.resources->entries;
+    ctx.capacity = capacity;
 
     ret = uacpi_for_each_aml_resource(
-        aml_buffer, accumulate_native_buffer_size, &ctx
+        aml_buffer, do_aml_resource_to_native, &ctx
     );
-    if (uacpi_unlikely_error(ret))
+    if (ret == UACPI_STATUS_OK)
+        ret = ctx.st;
+    if (uacpi_unlikely_error(ret)) {
+        uacpi_free_resources(ctx.resources);
         return ret;
-
-    if (uacpi_unlikely_error(ctx.st))
-        return ctx.st;
-
-    // Realistically any resource buffer bigger than this is probably a bug
-    if (uacpi_unlikely(ctx.size > (5 * 1024u * 1024u))) {
-        uacpi_error("bug: bogus native resource buffer size %zu\n", ctx.size);
-        return UACPI_STATUS_INTERNAL_ERROR;
     }
 
-    resources = uacpi_kernel_calloc(ctx.size + sizeof(uacpi_resources), 1);
-    if (uacpi_unlikely(resources == UACPI_NULL))
-        return UACPI_STATUS_OUT_OF_MEMORY;
-    resources->length = ctx.size;
-    resources->entries = UACPI_PTR_ADD(resources, sizeof(uacpi_resources));
+    resources = ctx.resources;
+    used = ctx.byte_buf - ctx.base;
 
-    ret = aml_resources_to_native(aml_buffer, resources->entries);
-    if (uacpi_unlikely_error(ret)) {
-        uacpi_free_resources(resources);
-        return ret;
+    if (ctx.capacity - used >= NATIVE_SHRINK_THRESHOLD &&
+        ctx.capacity - used > ctx.capacity / 4) {
+        resources = move_native_resources(resources, used, used);
+        if (uacpi_unlikely(resources == UACPI_NULL)) {
+            // Not fatal, just keep the bigger buffer
+            resources = ctx.resources;
+        }
     }
 
+    resources->length = used;
     *out_resources = resources;
-    return ret;
+    return UACPI_STATUS_OK;
 }
 
 void uacpi_free_resources(uacpi_resources *resources)
@@ -2016,7 +2318,9 @@ void uacpi_free_resources(uacpi_resources *resources)
     if (resources == UACPI_NULL)
         return;
 
-    uacpi_free(resources, sizeof(uacpi_resources) + resources->length);
+    uacpi_shareable_unref_and_delete_if_last(
+        resources_to_storage(resources), free_resources_storage
+    );
 }
 
 static uacpi_status extract_native_resources_from_method(
@@ -2037,18 +2341,677 @@ static uacpi_status extract_native_resources_from_method(
     return ret;
 }
 
+/*
+ * Per-device cache of converted _CRS and _PRS resources. Drivers tend to
+ * query the same resources multiple times during probe, each query would
+ * otherwise re-evaluate the method and redo the entire conversion.
+ *
+ * The cache of a device is dropped whenever its resources may have changed:
+ * - _SRS or _DIS of the device is invoked (including uacpi_set_resources)
+ * - the device receives a device check notification
+ * Caches of all devices are dropped on bus check notifications and table
+ * loads by bumping the global generation.
+ */
+static uacpi_handle resource_cache_lock;
+static uacpi_u32 resource_cache_generation = 1;
+static uacpi_resource_cache_stats resource_cache_stats;
+
+uacpi_status uacpi_initialize_resources(void)
+{
+    resource_cache_lock = uacpi_create_native_spinlock();
+    if (uacpi_unlikely(resource_cache_lock == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    return UACPI_STATUS_OK;
+}
+
+void uacpi_deinitialize_resources(void)
+{
+    if (resource_cache_lock != UACPI_NULL)
+        uacpi_free_native_spinlock(resource_cache_lock);
+
+    resource_cache_lock = UACPI_NULL;
+    resource_cache_generation = 1;
+    uacpi_memzero(&resource_cache_stats, sizeof(resource_cache_stats));
+}
+
+static void resource_cache_take_entries(
+    struct uacpi_resource_cache *cache, uacpi_resources **out_entries
+)
+{
+    uacpi_size i;
+
+    for (i = 0; i <= UACPI_RESOURCE_CACHE_SLOT_MAX; ++i) {
+        out_entries[i] = cache->entries[i];
+        cache->entries[i] = UACPI_NULL;
+    }
+}
+
+static void free_resource_cache_entries(uacpi_resources **entries)
+{
+    uacpi_size i;
+
+    for (i = 0; i <= UACPI_RESOURCE_CACHE_SLOT_MAX; ++i)
+        uacpi_free_resources(entries[i]);
+}
+
+static void free_pci_routing(struct uacpi_pci_routing *routing);
+
+void uacpi_resource_cache_release(struct uacpi_resource_cache *cache)
+{
+    uacpi_resources *entries[UACPI_RESOURCE_CACHE_SLOT_MAX + 1];
+
+    resource_cache_take_entries(cache, entries);
+    free_resource_cache_entries(entries);
+
+    free_pci_routing(cache->pci_routing);
+    cache->pci_routing = UACPI_NULL;
+    uacpi_object_unref(cache->srs_template);
+    cache->srs_template = UACPI_NULL;
+}
+
+static void resource_cache_invalidate(uacpi_namespace_node *node)
+{
+    uacpi_object *obj;
+    struct uacpi_resource_cache *cache;
+    uacpi_resources *entries[UACPI_RESOURCE_CACHE_SLOT_MAX + 1];
+    uacpi_cpu_flags flags;
+
+    if (resource_cache_lock == UACPI_NULL)
+        return;
+
+    obj = uacpi_namespace_node_get_object_typed(node, UACPI_OBJECT_DEVICE_BIT);
+    if (obj == UACPI_NULL)
+        return;
+    cache = &obj->device->resource_cache;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+    resource_cache_take_entries(cache, entries);
+    cache->epoch++;
+    resource_cache_stats.invalidations++;
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+
+    free_resource_cache_entries(entries);
+}
+
+void uacpi_resource_cache_invalidate_all(void)
+{
+    uacpi_cpu_flags flags;
+
+    if (resource_cache_lock == UACPI_NULL)
+        return;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+    resource_cache_generation++;
+    resource_cache_stats.invalidations++;
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+}
+
+void uacpi_resource_cache_on_method_call(uacpi_namespace_node *method_node)
+{
+    const uacpi_char *name = method_node->name.text;
+
+    if (name[0] != '_' || method_node->parent == UACPI_NULL)
+        return;
+
+    if (uacpi_memcmp(name, "_SRS", 4) == 0 ||
+        uacpi_memcmp(name, "_DIS", 4) == 0)
+        resource_cache_invalidate(method_node->parent);
+}
+
+void uacpi_resource_cache_on_notify(
+    uacpi_namespace_node *node, uacpi_u64 value
+)
+{
+    switch (value) {
+    case 0: // Bus Check
+        uacpi_resource_cache_invalidate_all();
+        break;
+    case 1: // Device Check
+        resource_cache_invalidate(node);
+        break;
+    default:
+        break;
+    }
+}
+
+static uacpi_bool resource_cache_slot(
+    const uacpi_char *method, enum uacpi_resource_cache_slot *out_slot
+)
+{
+    if (uacpi_strcmp(method, "_CRS") == 0) {
+        *out_slot = UACPI_RESOURCE_CACHE_SLOT_CRS;
+        return UACPI_TRUE;
+    }
+
+    if (uacpi_strcmp(method, "_PRS") == 0) {
+        *out_slot = UACPI_RESOURCE_CACHE_SLOT_PRS;
+        return UACPI_TRUE;
+    }
+
+    return UACPI_FALSE;
+}
+
+// Must be called with the resource cache lock held
+static uacpi_resources *resource_cache_get_locked(
+    struct uacpi_resource_cache *cache, enum uacpi_resource_cache_slot slot
+)
+{
+    uacpi_resources *resources;
+
+    if (cache->generation != resource_cache_generation)
+        return UACPI_NULL;
+
+    resources = cache->entries[slot];
+    if (resources != UACPI_NULL) {
+        resources_ref(resources);
+        resource_cache_stats.hits++;
+    }
+
+    return resources;
+}
+
+/*
+ * Returns a new reference to the cached resources in 'slot' or NULL. The
+ * generation and epoch of the cache at the time of the lookup are returned as
+ * well, a list converted afterwards may only be cached if they're unchanged.
+ */
+static uacpi_resources *resource_cache_lookup(
+    struct uacpi_resource_cache *cache, enum uacpi_resource_cache_slot slot,
+    uacpi_u32 *out_generation, uacpi_u32 *out_epoch
+)
+{
+    uacpi_resources *resources;
+    uacpi_cpu_flags flags;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+
+    *out_generation = resource_cache_generation;
+    *out_epoch = cache->epoch;
+
+    resources = resource_cache_get_locked(cache, slot);
+    if (resources == UACPI_NULL)
+        resource_cache_stats.misses++;
+
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+    return resources;
+}
+
+/*
+ * Same as resource_cache_lookup, except a miss is not counted, as the caller
+ * is not going to populate the cache afterwards.
+ */
+static uacpi_resources *resource_cache_peek(
+    struct uacpi_resource_cache *cache, enum uacpi_resource_cache_slot slot
+)
+{
+    uacpi_resources *resources;
+    uacpi_cpu_flags flags;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+    resources = resource_cache_get_locked(cache, slot);
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+
+    return resources;
+}
+
+/*
+ * Returns a reference to the (possibly cached) native resources of a device,
+ * which may be shared with other users and must not be modified.
+ */
+static uacpi_status get_shared_device_resources(
+    uacpi_namespace_node *device, const uacpi_char *method,
+    uacpi_resources **out_resources
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
+    struct uacpi_resource_cache *cache;
+    enum uacpi_resource_cache_slot slot;
+    uacpi_resources *resources, *stale[UACPI_RESOURCE_CACHE_SLOT_MAX + 1];
+    uacpi_u32 generation, epoch;
+    uacpi_cpu_flags flags;
+
+    if (!resource_cache_slot(method, &slot) || resource_cache_lock == UACPI_NULL)
+        return extract_native_resources_from_method(
+            device, method, out_resources
+        );
+
+    ret = uacpi_namespace_node_acquire_object_typed(
+        device, UACPI_OBJECT_DEVICE_BIT, &obj
+    );
+    if (uacpi_unlikely_error(ret))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+    cache = &obj->device->resource_cache;
+
+    resources = resource_cache_lookup(cache, slot, &generation, &epoch);
+    if (resources != UACPI_NULL) {
+        *out_resources = resources;
+        goto out;
+    }
+
+    ret = extract_native_resources_from_method(device, method, &resources);
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    stale[0] = stale[1] = UACPI_NULL;
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+
+    // Don't cache anything if the cache was invalidated while we were busy
+    if (generation == resource_cache_generation && epoch == cache->epoch) {
+        if (cache->generation != generation) {
+            resource_cache_take_entries(cache, stale);
+            cache->generation = generation;
+        }
+
+        if (cache->entries[slot] == UACPI_NULL) {
+            resources_ref(resources);
+            cache->entries[slot] = resources;
+        }
+    }
+
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+    free_resource_cache_entries(stale);
+
+    *out_resources = resources;
+out:
+    uacpi_object_unref(obj);
+    return ret;
+}
+
+/*
+ * Make a private copy of a shared (cached) resource list. The copy must not
+ * point into 'shared' in any way, as the cache entry may be invalidated and
+ * freed as soon as the caller drops its reference.
+ */
+static uacpi_resources *copy_shared_resources(uacpi_resources *shared)
+{
+    uacpi_resources *copy;
+
+    copy = resources_alloc(shared->length);
+    if (uacpi_unlikely(copy == UACPI_NULL))
+        return copy;
+
+    uacpi_memcpy(copy->entries, shared->entries, shared->length);
+    rebase_native_resources(copy->entries, copy->length, shared->entries);
+    return copy;
+}
+
+static uacpi_status get_device_resources(
+    uacpi_namespace_node *device, const uacpi_char *method,
+    uacpi_resources **out_resources
+)
+{
+    uacpi_status ret;
+    uacpi_resources *shared, *copy;
+
+    ret = get_shared_device_resources(device, method, &shared);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    // Callers are allowed to modify what they get, so give them a private copy
+    copy = copy_shared_resources(shared);
+    uacpi_free_resources(shared);
+    if (uacpi_unlikely(copy == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    *out_resources = copy;
+    return ret;
+}
+
 uacpi_status uacpi_get_current_resources(
     uacpi_namespace_node *device, uacpi_resources **out_resources
 )
 {
-    return extract_native_resources_from_method(device, "_CRS", out_resources);
+    return get_device_resources(device, "_CRS", out_resources);
 }
 
 uacpi_status uacpi_get_possible_resources(
     uacpi_namespace_node *device, uacpi_resources **out_resources
 )
 {
-    return extract_native_resources_from_method(device, "_PRS", out_resources);
+    return get_device_resources(device, "_PRS", out_resources);
+}
+
+void uacpi_invalidate_resource_cache(uacpi_namespace_node *device)
+{
+    uacpi_status ret;
+
+    if (device == UACPI_NULL) {
+        uacpi_resource_cache_invalidate_all();
+        return;
+    }
+
+    ret = uacpi_namespace_read_lock();
+    if (uacpi_unlikely_error(ret))
+        return;
+
+    resource_cache_invalidate(device);
+    uacpi_namespace_read_unlock();
+}
+
+void uacpi_get_resource_cache_stats(uacpi_resource_cache_stats *out_stats)
+{
+    uacpi_cpu_flags flags;
+
+    if (resource_cache_lock == UACPI_NULL) {
+        uacpi_memzero(out_stats, sizeof(*out_stats));
+        return;
+    }
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+    *out_stats = resource_cache_stats;
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+}
+
+/*
+ * Indexed _PRT of a PCI root or bridge, one slot per device and pin. Routes
+ * through a link device hold a reference to the device object of the link,
+ * and are stale once the resource cache epoch of the link no longer matches
+ * the one they were resolved at. The entire index is stale once the resource
+ * cache generation or the epoch of the bridge changes.
+ */
+#define PCI_ROUTING_MAX_DEVICES 32
+#define PCI_ROUTING_MAX_PINS 4
+#define PCI_ROUTING_SLOTS (PCI_ROUTING_MAX_DEVICES * PCI_ROUTING_MAX_PINS)
+
+struct pci_route_slot {
+    uacpi_pci_interrupt_route route;
+    uacpi_object *link;
+    uacpi_u32 link_epoch;
+    uacpi_u32 source_index;
+    uacpi_bool present;
+};
+
+struct uacpi_pci_routing {
+    uacpi_u32 generation;
+    uacpi_u32 epoch;
+    struct pci_route_slot slots[PCI_ROUTING_SLOTS];
+};
+
+static void free_pci_routing(struct uacpi_pci_routing *routing)
+{
+    uacpi_size i;
+
+    if (routing == UACPI_NULL)
+        return;
+
+    for (i = 0; i < PCI_ROUTING_SLOTS; ++i)
+        uacpi_object_unref(routing->slots[i].link);
+
+    uacpi_free(routing, sizeof(*routing));
+}
+
+static uacpi_bool pci_route_is_stale(struct pci_route_slot *slot)
+{
+    return slot->link != UACPI_NULL &&
+           slot->link_epoch != slot->link->device->resource_cache.epoch;
+}
+
+/*
+ * Per the spec, the source index of a route through a link device is the
+ * index of the interrupt descriptor within the _CRS of the link.
+ */
+static void resolve_pci_link_route(struct pci_route_slot *slot)
+{
+    uacpi_status ret;
+    uacpi_resources *resources;
+    uacpi_resource *resource;
+    uacpi_pci_interrupt_route *route = &slot->route;
+    uacpi_u32 i;
+    uacpi_cpu_flags flags;
+
+    route->resolved = UACPI_FALSE;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+    slot->link_epoch = slot->link->device->resource_cache.epoch;
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+
+    ret = get_shared_device_resources(route->link, "_CRS", &resources);
+    if (uacpi_unlikely_error(ret)) {
+        uacpi_warn(
+            "unable to resolve PCI interrupt link %.4s: %s\n",
+            route->link->name.text, uacpi_status_to_string(ret)
+        );
+        return;
+    }
+
+    resource = resources->entries;
+    for (i = 0; i < slot->source_index; ++i) {
+        if (resource->type == UACPI_RESOURCE_TYPE_END_TAG)
+            break;
+
+        resource = UACPI_NEXT_RESOURCE(resource);
+    }
+
+    switch (resource->type) {
+    case UACPI_RESOURCE_TYPE_IRQ:
+        if (resource->irq.num_irqs == 0)
+            break;
+
+        route->gsi = resource->irq.irqs[0];
+        route->triggering = resource->irq.triggering;
+        route->polarity = resource->irq.polarity;
+        route->sharing = resource->irq.sharing;
+        route->resolved = UACPI_TRUE;
+        break;
+    case UACPI_RESOURCE_TYPE_EXTENDED_IRQ:
+        if (resource->extended_irq.num_irqs == 0)
+            break;
+
+        route->gsi = resource->extended_irq.irqs[0];
+        route->triggering = resource->extended_irq.triggering;
+        route->polarity = resource->extended_irq.polarity;
+        route->sharing = resource->extended_irq.sharing;
+        route->resolved = UACPI_TRUE;
+        break;
+    default:
+        uacpi_warn(
+            "PCI interrupt link %.4s has no interrupt at index %u\n",
+            route->link->name.text, slot->source_index
+        );
+        break;
+    }
+
+    uacpi_free_resources(resources);
+}
+
+static uacpi_status build_pci_routing(
+    uacpi_namespace_node *bridge, uacpi_u32 generation, uacpi_u32 epoch,
+    struct uacpi_pci_routing **out_routing
+)
+{
+    uacpi_status ret;
+    uacpi_pci_routing_table *table;
+    uacpi_pci_routing_table_entry *entry;
+    struct uacpi_pci_routing *routing;
+    struct pci_route_slot *slot;
+    uacpi_u32 device;
+    uacpi_size i;
+
+    ret = uacpi_get_pci_routing_table(bridge, &table);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    routing = uacpi_kernel_calloc(1, sizeof(*routing));
+    if (uacpi_unlikely(routing == UACPI_NULL)) {
+        uacpi_free_pci_routing_table(table);
+        return UACPI_STATUS_OUT_OF_MEMORY;
+    }
+    routing->generation = generation;
+    routing->epoch = epoch;
+
+    for (i = 0; i < table->num_entries; ++i) {
+        entry = &table->entries[i];
+        device = entry->address >> 16;
+
+        if (uacpi_unlikely(device >= PCI_ROUTING_MAX_DEVICES ||
+                           entry->pin >= PCI_ROUTING_MAX_PINS)) {
+            uacpi_warn(
+                "ignoring _PRT entry %zu with invalid address 0x%08X "
+                "or pin %u\n", i, entry->address, entry->pin
+            );
+            continue;
+        }
+
+        // Keep the first entry for a pin, same as a linear search would
+        slot = &routing->slots[device * PCI_ROUTING_MAX_PINS + entry->pin];
+        if (slot->present)
+            continue;
+        slot->present = UACPI_TRUE;
+
+        if (entry->source == UACPI_NULL) {
+            // Hardwired to a GSI, which is always level-triggered active-low
+            slot->route.gsi = entry->index;
+            slot->route.triggering = UACPI_TRIGGERING_LEVEL;
+            slot->route.polarity = UACPI_POLARITY_ACTIVE_LOW;
+            slot->route.sharing = UACPI_SHARED;
+            slot->route.resolved = UACPI_TRUE;
+            continue;
+        }
+
+        slot->route.link = entry->source;
+        slot->source_index = entry->index;
+
+        ret = uacpi_namespace_node_acquire_object_typed(
+            entry->source, UACPI_OBJECT_DEVICE_BIT, &slot->link
+        );
+        if (uacpi_unlikely_error(ret)) {
+            uacpi_warn(
+                "_PRT entry %zu source %.4s is not a device\n",
+                i, entry->source->name.text
+            );
+            slot->link = UACPI_NULL;
+            continue;
+        }
+
+        resolve_pci_link_route(slot);
+    }
+
+    uacpi_free_pci_routing_table(table);
+    *out_routing = routing;
+    return UACPI_STATUS_OK;
+}
+
+/*
+ * Resolve a stale route through a link device again. The caller copies the
+ * slot out and references its link in the same critical section that found it
+ * stale, so that this can be done without holding the lock. 'routing' might
+ * have been freed in the meantime, so it's only dereferenced if it's still
+ * installed, and the route is only written back if nobody else got there first.
+ */
+static void refresh_pci_link_route(
+    struct uacpi_resource_cache *cache, struct uacpi_pci_routing *routing,
+    uacpi_size idx, struct pci_route_slot *copy,
+    uacpi_pci_interrupt_route *out_route
+)
+{
+    struct pci_route_slot *slot;
+    uacpi_cpu_flags flags;
+
+    resolve_pci_link_route(copy);
+    *out_route = copy->route;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+    if (cache->pci_routing == routing) {
+        slot = &routing->slots[idx];
+
+        if (pci_route_is_stale(slot)) {
+            slot->route = copy->route;
+            slot->link_epoch = copy->link_epoch;
+        }
+    }
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+
+    uacpi_object_unref(copy->link);
+}
+
+uacpi_status uacpi_get_pci_interrupt_route(
+    uacpi_namespace_node *bridge, uacpi_u8 device, uacpi_u8 pin,
+    uacpi_pci_interrupt_route *out_route
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
+    struct uacpi_resource_cache *cache;
+    struct uacpi_pci_routing *routing, *stale = UACPI_NULL;
+    struct pci_route_slot *slot, copy;
+    uacpi_u32 generation, epoch;
+    uacpi_size idx;
+    uacpi_cpu_flags flags;
+    uacpi_bool refresh = UACPI_FALSE;
+
+    UACPI_ENSURE_INIT_LEVEL_AT_LEAST(UACPI_INIT_LEVEL_NAMESPACE_LOADED);
+
+    if (uacpi_unlikely(device >= PCI_ROUTING_MAX_DEVICES ||
+                       pin >= PCI_ROUTING_MAX_PINS))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+    idx = device * PCI_ROUTING_MAX_PINS + pin;
+
+    ret = uacpi_namespace_node_acquire_object_typed(
+        bridge, UACPI_OBJECT_DEVICE_BIT, &obj
+    );
+    if (uacpi_unlikely_error(ret))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+    cache = &obj->device->resource_cache;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+
+    routing = cache->pci_routing;
+    if (routing != UACPI_NULL &&
+        routing->generation == resource_cache_generation &&
+        routing->epoch == cache->epoch) {
+        slot = &routing->slots[idx];
+
+        if (!slot->present)
+            ret = UACPI_STATUS_NOT_FOUND;
+        else if (pci_route_is_stale(slot))
+            refresh = UACPI_TRUE;
+        else
+            *out_route = slot->route;
+
+        if (refresh) {
+            copy = *slot;
+            uacpi_object_ref(copy.link);
+        }
+
+        uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+
+        if (refresh)
+            refresh_pci_link_route(cache, routing, idx, &copy, out_route);
+        goto out;
+    }
+
+    generation = resource_cache_generation;
+    epoch = cache->epoch;
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+
+    ret = build_pci_routing(bridge, generation, epoch, &routing);
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    slot = &routing->slots[idx];
+    if (slot->present)
+        *out_route = slot->route;
+    else
+        ret = UACPI_STATUS_NOT_FOUND;
+
+    flags = uacpi_lock_native_spinlock(resource_cache_lock);
+
+    // Don't install anything if the cache was invalidated while we were busy
+    if (generation == resource_cache_generation && epoch == cache->epoch) {
+        stale = cache->pci_routing;
+        cache->pci_routing = routing;
+        routing = UACPI_NULL;
+    }
+
+    uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+
+    free_pci_routing(stale);
+    free_pci_routing(routing);
+out:
+    uacpi_object_unref(obj);
+    return ret;
 }
 
 uacpi_status uacpi_for_each_resource(
@@ -2067,53 +3030,517 @@ uacpi_status uacpi_for_each_resource(
             return UACPI_STATUS_INVALID_ARGUMENT;
         }
 
-        if (uacpi_unlikely(current->type > UACPI_RESOURCE_TYPE_MAX)) {
-            uacpi_error("invalid resource type %d\n", current->type);
-            return UACPI_STATUS_INVALID_ARGUMENT;
-        }
+        if (uacpi_unlikely(current->type > UACPI_RESOURCE_TYPE_MAX)) {
+            uacpi_error("invalid resource type %d\n", current->type);
+            return UACPI_STATUS_INVALID_ARGUMENT;
+        }
+
+        if (uacpi_unlikely(current->length > bytes_left)) {
+            uacpi_error("corrupted resource@%p length %u (%zu bytes left)\n",
+                        current, current->length, bytes_left);
+            return UACPI_STATUS_INVALID_ARGUMENT;
+        }
+
+        decision = cb(user, current);
+
+        if (decision == UACPI_ITERATION_DECISION_BREAK ||
+            current->type == UACPI_RESOURCE_TYPE_END_TAG)
+            return UACPI_STATUS_OK;
+
+        bytes_left -= current->length;
+        current = (uacpi_resource*)((uacpi_u8*)current + current->length);
+    }
+
+    return UACPI_STATUS_NO_RESOURCE_END_TAG;
+}
+
+uacpi_status uacpi_for_each_device_resource(
+    uacpi_namespace_node *device, const uacpi_char *method,
+    uacpi_resource_iteration_callback cb, void *user
+)
+{
+    uacpi_status ret;
+    uacpi_resources *resources;
+
+    ret = get_shared_device_resources(device, method, &resources);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    ret = uacpi_for_each_resource(resources, cb, user);
+    uacpi_free_resources(resources);
+
+    return ret;
+}
+
+struct resource_stream_ctx {
+    struct resource_conversion_ctx conv;
+    uacpi_u64 type_mask;
+    uacpi_resource_iteration_callback cb;
+    void *user;
+};
+
+static uacpi_iteration_decision stream_aml_resource(
+    void *opaque, uacpi_u8 *data, uacpi_u16 aml_size,
+    const struct uacpi_resource_spec *spec
+)
+{
+    struct resource_stream_ctx *ctx = opaque;
+    uacpi_resource_type type = spec->native_type;
+
+    if (spec->type == UACPI_AML_RESOURCE_SERIAL_CONNECTION) {
+        struct acpi_resource_serial *serial;
+
+        serial = (struct acpi_resource_serial*)data;
+        type = aml_serial_to_native_type(serial->type);
+    }
+
+    if (!(ctx->type_mask & UACPI_RESOURCE_TYPE_BIT(type)))
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+    // Every matching resource is converted to the start of the buffer
+    ctx->conv.byte_buf = ctx->conv.base;
+    do_aml_resource_to_native(&ctx->conv, data, aml_size, spec);
+    if (uacpi_unlikely_error(ctx->conv.st))
+        return UACPI_ITERATION_DECISION_BREAK;
+
+    return ctx->cb(ctx->user, (uacpi_resource*)ctx->conv.base);
+}
+
+static uacpi_iteration_decision stream_native_resource(
+    void *opaque, uacpi_resource *resource
+)
+{
+    struct resource_stream_ctx *ctx = opaque;
+
+    if (!(ctx->type_mask & UACPI_RESOURCE_TYPE_BIT(resource->type)))
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+    if (uacpi_unlikely(resource->length > ctx->conv.capacity)) {
+        uacpi_warn("resource doesn't fit into the buffer: %u > %zu\n",
+                   resource->length, ctx->conv.capacity);
+        ctx->conv.st = UACPI_STATUS_INVALID_ARGUMENT;
+        return UACPI_ITERATION_DECISION_BREAK;
+    }
+
+    uacpi_memcpy(ctx->conv.base, resource, resource->length);
+    rebase_native_resources(ctx->conv.base, resource->length, resource);
+
+    return ctx->cb(ctx->user, (uacpi_resource*)ctx->conv.base);
+}
+
+static uacpi_status peek_cached_device_resources(
+    uacpi_namespace_node *device, const uacpi_char *method,
+    uacpi_resources **out_resources
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
+    enum uacpi_resource_cache_slot slot;
+
+    *out_resources = UACPI_NULL;
+
+    if (!resource_cache_slot(method, &slot) || resource_cache_lock == UACPI_NULL)
+        return UACPI_STATUS_OK;
+
+    ret = uacpi_namespace_node_acquire_object_typed(
+        device, UACPI_OBJECT_DEVICE_BIT, &obj
+    );
+    if (uacpi_unlikely_error(ret))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    *out_resources = resource_cache_peek(&obj->device->resource_cache, slot);
+
+    uacpi_object_unref(obj);
+    return UACPI_STATUS_OK;
+}
+
+uacpi_status uacpi_for_each_device_resource_of_type(
+    uacpi_namespace_node *device, const uacpi_char *method,
+    uacpi_u64 type_mask, void *buffer, uacpi_size buffer_size,
+    uacpi_resource_iteration_callback cb, void *user
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
+    uacpi_resources *resources;
+    struct resource_stream_ctx ctx = {
+        .conv = {
+            .buf = buffer,
+            .base = buffer,
+            .capacity = buffer_size,
+        },
+        .type_mask = type_mask,
+        .cb = cb,
+        .user = user,
+    };
+
+    if (uacpi_unlikely(buffer == UACPI_NULL ||
+                       ((uacpi_uintptr)buffer & (sizeof(void*) - 1))))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    // Nothing to convert if the list is already cached
+    ret = peek_cached_device_resources(device, method, &resources);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    if (resources != UACPI_NULL) {
+        ret = uacpi_for_each_resource(
+            resources, stream_native_resource, &ctx
+        );
+        uacpi_free_resources(resources);
+    } else {
+        ret = eval_resource_helper(device, method, &obj);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+
+        ret = uacpi_for_each_aml_resource(
+            obj->buffer, stream_aml_resource, &ctx
+        );
+        uacpi_object_unref(obj);
+    }
+
+    if (ret == UACPI_STATUS_OK)
+        ret = ctx.conv.st;
+
+    return ret;
+}
+
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE(device_node_array, uacpi_namespace_node*, 16)
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE_IMPL(
+    device_node_array, uacpi_namespace_node*, static
+)
+
+struct bulk_collect_ctx {
+    const uacpi_char *const *hids;
+    struct device_node_array nodes;
+    uacpi_status st;
+};
+
+static uacpi_iteration_decision collect_bulk_device(
+    void *opaque, uacpi_namespace_node *node, uacpi_u32 depth
+)
+{
+    struct bulk_collect_ctx *ctx = opaque;
+    uacpi_namespace_node **slot, *crs;
+    uacpi_status ret;
+    uacpi_u32 flags;
+    UACPI_UNUSED(depth);
+
+    if (ctx->hids != UACPI_NULL &&
+        !uacpi_device_matches_pnp_id(node, ctx->hids))
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+    ret = uacpi_eval_sta(node, &flags);
+    if (uacpi_unlikely_error(ret))
+        return UACPI_ITERATION_DECISION_NEXT_PEER;
+
+    if (!(flags & ACPI_STA_RESULT_DEVICE_PRESENT) &&
+        !(flags & ACPI_STA_RESULT_DEVICE_FUNCTIONING))
+        return UACPI_ITERATION_DECISION_NEXT_PEER;
+
+    ret = uacpi_namespace_node_find(node, "_CRS", &crs);
+    if (ret != UACPI_STATUS_OK)
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+    slot = device_node_array_alloc(&ctx->nodes);
+    if (uacpi_unlikely(slot == UACPI_NULL)) {
+        ctx->st = UACPI_STATUS_OUT_OF_MEMORY;
+        return UACPI_ITERATION_DECISION_BREAK;
+    }
+
+    // Owned by the set, as it outlives the namespace lock
+    uacpi_shareable_ref(node);
+    *slot = node;
+    return UACPI_ITERATION_DECISION_CONTINUE;
+}
+
+/*
+ * Tracks the chunks handed off to the host. 'pending' is the number of chunks
+ * still being converted plus one, the extra reference is owned by the calling
+ * thread. 'done_event' is signaled once this drops to 0. This is used instead
+ * of uacpi_kernel_wait_for_work_completion so that it's safe to call from a
+ * work item, e.g. a notify handler.
+ */
+struct bulk_resources_sync {
+    uacpi_u32 pending;
+    uacpi_handle done_event;
+};
+
+/*
+ * A contiguous range of devices of a set, the resources of which are appended
+ * to a single arena. Resource lists are only sliced out of the arena once all
+ * of them are converted, as it may move while growing.
+ */
+struct bulk_resources_work {
+    uacpi_device_resources *devices;
+    uacpi_size count;
+    struct resource_conversion_ctx conv;
+    struct bulk_resources_sync *sync;
+};
+
+struct resource_set_storage {
+    uacpi_resource_set set;
+    uacpi_u32 num_works;
+    struct bulk_resources_work *works;
+};
+
+// Average size of a native resource list, only used for the initial capacity
+#define BULK_NATIVE_SIZE_ESTIMATE 256
+
+static uacpi_size resource_set_storage_size(
+    uacpi_size count, uacpi_u32 num_works
+)
+{
+    return sizeof(struct resource_set_storage) +
+           count * sizeof(uacpi_device_resources) +
+           num_works * sizeof(struct bulk_resources_work);
+}
+
+static void convert_bulk_device(
+    struct resource_conversion_ctx *conv, uacpi_device_resources *dev
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
+    uacpi_resources *cached;
+    uacpi_size start;
+
+    start = conv->byte_buf - conv->base;
+
+    ret = peek_cached_device_resources(dev->device, "_CRS", &cached);
+    if (ret == UACPI_STATUS_OK && cached != UACPI_NULL) {
+        if (reserve_native_output(conv, cached->length)) {
+            uacpi_memcpy(conv->byte_buf, cached->entries, cached->length);
+            rebase_native_resources(
+                conv->byte_buf, cached->length, cached->entries
+            );
+            conv->byte_buf += cached->length;
+        }
+
+        uacpi_free_resources(cached);
+        ret = conv->st;
+    } else if (ret == UACPI_STATUS_OK) {
+        ret = eval_resource_helper(dev->device, "_CRS", &obj);
+        if (ret == UACPI_STATUS_OK) {
+            ret = uacpi_for_each_aml_resource(
+                obj->buffer, do_aml_resource_to_native, conv
+            );
+            if (ret == UACPI_STATUS_OK)
+                ret = conv->st;
+
+            uacpi_object_unref(obj);
+        }
+    }
+
+    dev->status = ret;
+    if (uacpi_unlikely_error(ret)) {
+        // Drop whatever was converted before the failure
+        conv->byte_buf = conv->base + start;
+        conv->st = UACPI_STATUS_OK;
+        return;
+    }
+
+    dev->resources.length = (conv->byte_buf - conv->base) - start;
+}
+
+static void convert_bulk_devices(uacpi_handle opaque)
+{
+    struct bulk_resources_work *work = opaque;
+    uacpi_size i;
+
+    for (i = 0; i < work->count; ++i)
+        convert_bulk_device(&work->conv, &work->devices[i]);
+}
+
+static void convert_bulk_devices_work(uacpi_handle opaque)
+{
+    struct bulk_resources_work *work = opaque;
+    struct bulk_resources_sync *sync = work->sync;
+
+    convert_bulk_devices(work);
 
-        if (uacpi_unlikely(current->length > bytes_left)) {
-            uacpi_error("corrupted resource@%p length %u (%zu bytes left)\n",
-                        current, current->length, bytes_left);
-            return UACPI_STATUS_INVALID_ARGUMENT;
+    if (uacpi_atomic_dec32(&sync->pending) == 0)
+        uacpi_kernel_signal_event(sync->done_event);
+}
+
+static void finalize_bulk_work(struct bulk_resources_work *work)
+{
+    struct resource_conversion_ctx *conv = &work->conv;
+    uacpi_resources *resources = conv->resources;
+    uacpi_size i, used, offset = 0;
+
+    used = conv->byte_buf - conv->base;
+
+    if (conv->capacity - used >= NATIVE_SHRINK_THRESHOLD &&
+        conv->capacity - used > conv->capacity / 4) {
+        resources = move_native_resources(resources, used, used);
+        if (uacpi_unlikely(resources == UACPI_NULL)) {
+            // Not fatal, just keep the bigger buffer
+            resources = conv->resources;
         }
+    }
 
-        decision = cb(user, current);
+    resources->length = used;
+    conv->resources = resources;
+    conv->base = conv->byte_buf = (uacpi_u8*)resources->entries;
 
-        if (decision == UACPI_ITERATION_DECISION_BREAK ||
-            current->type == UACPI_RESOURCE_TYPE_END_TAG)
-            return UACPI_STATUS_OK;
+    for (i = 0; i < work->count; ++i) {
+        uacpi_device_resources *dev = &work->devices[i];
 
-        bytes_left -= current->length;
-        current = (uacpi_resource*)((uacpi_u8*)current + current->length);
-    }
+        if (dev->status != UACPI_STATUS_OK)
+            continue;
 
-    return UACPI_STATUS_NO_RESOURCE_END_TAG;
+        dev->resources.entries = PTR_AT(conv->base, offset);
+        offset += dev->resources.length;
+    }
 }
 
-uacpi_status uacpi_for_each_device_resource(
-    uacpi_namespace_node *device, const uacpi_char *method,
-    uacpi_resource_iteration_callback cb, void *user
+uacpi_status uacpi_get_current_resources_bulk(
+    uacpi_namespace_node *parent, const uacpi_char *const *hids,
+    uacpi_u32 num_workers, uacpi_resource_set **out_set
 )
 {
     uacpi_status ret;
-    uacpi_resources *resources;
+    struct bulk_collect_ctx ctx = {
+        .hids = hids,
+    };
+    struct resource_set_storage *storage;
+    struct bulk_resources_work *work;
+    struct bulk_resources_sync sync = {
+        .pending = 1,
+    };
+    uacpi_size i, count, chunk, capacity, next = 0;
+    uacpi_u32 num_works;
 
-    ret = extract_native_resources_from_method(device, method, &resources);
+    UACPI_ENSURE_INIT_LEVEL_AT_LEAST(UACPI_INIT_LEVEL_NAMESPACE_LOADED);
+
+    if (uacpi_unlikely(out_set == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    ret = uacpi_namespace_for_each_child(
+        parent, collect_bulk_device, UACPI_NULL, UACPI_OBJECT_DEVICE_BIT,
+        UACPI_MAX_DEPTH_ANY, &ctx
+    );
+    if (ret == UACPI_STATUS_OK)
+        ret = ctx.st;
     if (uacpi_unlikely_error(ret))
-        return ret;
+        goto out_unref_nodes;
 
-    ret = uacpi_for_each_resource(resources, cb, user);
-    uacpi_free_resources(resources);
+    count = device_node_array_size(&ctx.nodes);
+
+#ifdef UACPI_SINGLE_THREADED
+    num_workers = 1;
+#endif
+    num_works = UACPI_MAX(1, UACPI_MIN(num_workers, count));
+
+    if (num_works > 1) {
+        sync.done_event = uacpi_kernel_create_event();
+
+        // Convert everything on the calling thread instead
+        if (uacpi_unlikely(sync.done_event == UACPI_NULL))
+            num_works = 1;
+    }
+
+    storage = uacpi_kernel_calloc(
+        1, resource_set_storage_size(count, num_works)
+    );
+    if (uacpi_unlikely(storage == UACPI_NULL)) {
+        ret = UACPI_STATUS_OUT_OF_MEMORY;
+        goto out_unref_nodes;
+    }
+
+    storage->set.count = count;
+    storage->set.devices = PTR_AT(storage, sizeof(*storage));
+    storage->num_works = num_works;
+    storage->works = PTR_AT(
+        storage->set.devices, count * sizeof(uacpi_device_resources)
+    );
+
+    // The node references are transferred to the set
+    for (i = 0; i < count; ++i)
+        storage->set.devices[i].device = *device_node_array_at(&ctx.nodes, i);
+
+    for (i = 0; i < num_works; ++i) {
+        work = &storage->works[i];
+        work->sync = &sync;
+
+        chunk = count / num_works + (i < count % num_works);
+        work->devices = &storage->set.devices[next];
+        work->count = chunk;
+        next += chunk;
 
+        capacity = UACPI_MAX(chunk, 1) * BULK_NATIVE_SIZE_ESTIMATE;
+        capacity = UACPI_MIN(capacity, MAX_RESOURCE_BUFFER_SIZE);
+
+        work->conv.resources = resources_alloc(capacity);
+        if (uacpi_unlikely(work->conv.resources == UACPI_NULL)) {
+            uacpi_free_resource_set(&storage->set);
+            ret = UACPI_STATUS_OUT_OF_MEMORY;
+            goto out;
+        }
+
+        work->conv.base = work->conv.buf = work->conv.resources->entries;
+        work->conv.capacity = capacity;
+    }
+
+    /*
+     * The first chunk is always converted by the calling thread, so is any
+     * other chunk that we failed to hand off to the host.
+     */
+    for (i = 1; i < num_works; ++i) {
+        work = &storage->works[i];
+
+        uacpi_atomic_inc32(&sync.pending);
+        ret = uacpi_kernel_schedule_work(
+            UACPI_WORK_PARALLEL, convert_bulk_devices_work, work
+        );
+        if (uacpi_unlikely_error(ret))
+            convert_bulk_devices_work(work);
+    }
+    convert_bulk_devices(&storage->works[0]);
+
+    /*
+     * Wait for the signal rather than polling 'pending', as the last chunk
+     * may still be signaling the event after the counter has dropped to 0.
+     */
+    if (uacpi_atomic_dec32(&sync.pending) != 0)
+        uacpi_kernel_wait_for_event(sync.done_event, 0xFFFF);
+
+    for (i = 0; i < num_works; ++i)
+        finalize_bulk_work(&storage->works[i]);
+
+    *out_set = &storage->set;
+    ret = UACPI_STATUS_OK;
+    goto out;
+
+out_unref_nodes:
+    for (i = 0; i < device_node_array_size(&ctx.nodes); ++i)
+        uacpi_namespace_node_unref(*device_node_array_at(&ctx.nodes, i));
+out:
+    if (sync.done_event != UACPI_NULL)
+        uacpi_kernel_free_event(sync.done_event);
+    device_node_array_clear(&ctx.nodes);
     return ret;
 }
 
-static const struct uacpi_resource_spec *resource_spec_from_native(
-        uacpi_resource *resource
-)
+void uacpi_free_resource_set(uacpi_resource_set *set)
 {
-    return &aml_resources[native_resource_to_type[resource->type]];
+    struct resource_set_storage *storage;
+    uacpi_size i;
+
+    if (set == UACPI_NULL)
+        return;
+
+    storage = (struct resource_set_storage*)set;
+    for (i = 0; i < storage->num_works; ++i)
+        uacpi_free_resources(storage->works[i].conv.resources);
+
+    for (i = 0; i < set->count; ++i)
+        uacpi_namespace_node_unref(set->devices[i].device);
+
+    uacpi_free(
+        storage, resource_set_storage_size(set->count, storage->num_works)
+    );
 }
 
 static uacpi_size aml_size_for_native_resource(
@@ -2125,357 +3552,449 @@ static uacpi_size aml_size_for_native_resource(
            aml_size_with_header(spec);
 }
 
-static uacpi_iteration_decision do_native_resource_to_aml(
-    void *opaque, uacpi_resource *resource
+static uacpi_bool reserve_aml_output(
+    struct resource_conversion_ctx *ctx, uacpi_size size
 )
 {
-    struct resource_conversion_ctx *ctx = opaque;
-    const struct uacpi_resource_spec *spec;
-    const struct uacpi_resource_convert_instruction *insns, *insn;
-    uacpi_u8 pc = 0;
-    uacpi_u8 *dst_base, *src, *dst;
-    uacpi_u32 aml_size, base_aml_size_with_header, accumulator = 0;
-    void *resource_end;
-
-    spec = resource_spec_from_native(resource);
-    aml_size = aml_size_for_native_resource(resource, spec);
-    insns = spec->to_aml;
-
-    dst_base = ctx->byte_buf;
-    ctx->byte_buf += aml_size;
-    aml_size -= aml_resource_kind_to_header_size[spec->resource_kind];
+    uacpi_size used;
+    uacpi_buffer *buf = ctx->aml_buffer;
+
+    used = ctx->byte_buf - ctx->base;
+    if (uacpi_unlikely(size > ctx->capacity - used)) {
+        if (uacpi_unlikely(used + size > MAX_RESOURCE_BUFFER_SIZE)) {
+            uacpi_error("bug: bogus target aml resource buffer size %zu\n",
+                        used + size);
+            ctx->st = UACPI_STATUS_INTERNAL_ERROR;
+            return UACPI_FALSE;
+        }
 
-    base_aml_size_with_header = spec->aml_size;
-    base_aml_size_with_header += aml_resource_kind_to_header_size[
-        spec->resource_kind
-    ];
-    resource_end = PTR_AT(resource, spec->native_size);
+        buf->size = used;
+        ctx->base = uacpi_buffer_grow_data(buf, used + size);
+        if (uacpi_unlikely(ctx->base == UACPI_NULL)) {
+            ctx->st = UACPI_STATUS_OUT_OF_MEMORY;
+            return UACPI_FALSE;
+        }
 
-    if (spec->resource_kind == UACPI_AML_RESOURCE_KIND_LARGE) {
-        *dst_base = ACPI_LARGE_ITEM | type_to_aml_resource[spec->type];
-        uacpi_memcpy(dst_base + 1, &aml_size, sizeof(uacpi_u16));
-    } else {
-        *dst_base = type_to_aml_resource[spec->type] << ACPI_SMALL_ITEM_NAME_IDX;
-        *dst_base |= aml_size;
+        ctx->byte_buf = ctx->base + used;
+        ctx->capacity = buf->capacity;
     }
 
-    if (insns == UACPI_NULL)
-        return UACPI_ITERATION_DECISION_CONTINUE;
-
-    for (;;) {
-        insn = &insns[pc++];
-
-        src = NATIVE_OFFSET(resource, insn->native_offset);
-        dst = dst_base + insn->aml_offset;
-
-        switch (insn->code) {
-        case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_8:
-        case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16: {
-            uacpi_u8 i, *array_size, bytes = 1;
-            uacpi_u16 mask = 0;
+    // Conversion programs only write the fields that are present
+    uacpi_memzero(ctx->byte_buf, size);
+    return UACPI_TRUE;
+}
 
-            array_size = NATIVE_OFFSET(resource, insn->arg2);
-            for (i = 0; i < *array_size; ++i)
-                mask |= 1 << src[i];
+static UACPI_ALWAYS_INLINE uacpi_iteration_decision native_to_aml_step(
+    struct uacpi_resource_convert_state *state,
+    const struct uacpi_resource_convert_instruction *insn
+)
+{
+    struct resource_conversion_ctx *ctx = state->ctx;
+    const struct uacpi_resource_spec *spec = state->spec;
+    uacpi_resource *resource = state->resource;
+    uacpi_u8 *dst_base = state->aml;
+    uacpi_u32 aml_size = state->aml_size;
+    uacpi_u8 *src, *dst;
 
-            if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16)
-                bytes = 2;
+    src = NATIVE_OFFSET(resource, insn->native_offset);
+    dst = dst_base + insn->aml_offset;
 
-            uacpi_memcpy(dst, &mask, bytes);
-            break;
-        }
+    switch (insn->code) {
+    case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_8:
+    case UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16: {
+        uacpi_u8 i, *array_size, bytes = 1;
+        uacpi_u16 mask = 0;
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_1:
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_2:
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_3:
-        case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_6:
-            *dst |= *src << insn->imm;
-            break;
+        array_size = NATIVE_OFFSET(resource, insn->arg2);
+        for (i = 0; i < *array_size; ++i)
+            mask |= 1 << src[i];
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_AML_SIZE_32:
-            accumulator = aml_size;
-            break;
+        if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_PACKED_ARRAY_16)
+            bytes = 2;
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE:
-        case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE_NO_INDEX:
-        case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL: {
-            uacpi_size source_offset, length;
-            uacpi_u8 *dst_string;
-            const uacpi_char *src_string;
-            union {
-                void *ptr;
-                uacpi_resource_source *source;
-                uacpi_resource_label *label;
-            } src_name = { .ptr = src };
-
-            source_offset = base_aml_size_with_header + accumulator;
-            dst_string = dst_base + source_offset;
-
-            if (insn->aml_offset)
-                uacpi_memcpy(dst, &source_offset, sizeof(uacpi_u16));
-
-            if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE &&
-                src_name.source->index_present)
-                uacpi_memcpy(dst_string++, &src_name.source->index, 1);
-
-            if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL) {
-                length = src_name.label->length;
-                src_string = src_name.label->string;
-            } else {
-                length = src_name.source->length;
-                src_string = src_name.source->string;
-            }
+        uacpi_memcpy(dst, &mask, bytes);
+        break;
+    }
 
-            if (length == 0)
-                break;
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_1:
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_2:
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_3:
+    case UACPI_RESOURCE_CONVERT_OPCODE_BIT_FIELD_6:
+        *dst |= *src << insn->imm;
+        break;
 
-            if (uacpi_unlikely(src_string == UACPI_NULL)) {
-                uacpi_error(
-                    "source string length is %zu but the pointer is NULL\n",
-                    length
-                );
-                ctx->st = UACPI_STATUS_INVALID_ARGUMENT;
-                return UACPI_ITERATION_DECISION_BREAK;
-            }
+    case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_AML_SIZE_32:
+        state->accumulator = aml_size;
+        break;
 
-            uacpi_memcpy(dst_string, src_string, length);
-            break;
+    case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE:
+    case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE_NO_INDEX:
+    case UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL: {
+        uacpi_size source_offset, length;
+        uacpi_u8 *dst_string;
+        const uacpi_char *src_string;
+        union {
+            void *ptr;
+            uacpi_resource_source *source;
+            uacpi_resource_label *label;
+        } src_name = { .ptr = src };
+
+        source_offset = state->base_aml_size_with_header + state->accumulator;
+        dst_string = dst_base + source_offset;
+
+        if (insn->aml_offset)
+            uacpi_memcpy(dst, &source_offset, sizeof(uacpi_u16));
+
+        if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_SOURCE &&
+            src_name.source->index_present)
+            uacpi_memcpy(dst_string++, &src_name.source->index, 1);
+
+        if (insn->code == UACPI_RESOURCE_CONVERT_OPCODE_RESOURCE_LABEL) {
+            length = src_name.label->length;
+            src_string = src_name.label->string;
+        } else {
+            length = src_name.source->length;
+            src_string = src_name.source->string;
         }
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_PIN_TABLE_LENGTH:
-            uacpi_memcpy_zerout(&accumulator, src,
-                                sizeof(accumulator), sizeof(uacpi_u16));
-            accumulator *= sizeof(uacpi_u16);
+        if (length == 0)
             break;
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_PIN_TABLE:
-            /*
-             * The pin table resides right at the end of the base resource,
-             * set the offset to it in the AML we're encoding.
-             */
-            uacpi_memcpy(dst, &base_aml_size_with_header, sizeof(uacpi_u16));
-
-            /*
-             * Copy the actual data. It also resides right at the end of the
-             * native base resource.
-             */
-            uacpi_memcpy(
-                dst_base + base_aml_size_with_header,
-                resource_end,
-                accumulator
+        if (uacpi_unlikely(src_string == UACPI_NULL)) {
+            uacpi_error(
+                "source string length is %zu but the pointer is NULL\n",
+                length
             );
-            break;
-
-        case UACPI_RESOURCE_CONVERT_OPCODE_VENDOR_DATA: {
-            uacpi_u16 vendor_data_length, data_offset, vendor_data_offset;
-            uacpi_u8 *vendor_data;
-
-            // Read the vendor_data pointer
-            uacpi_memcpy(&vendor_data, NATIVE_OFFSET(resource, insn->arg2),
-                         sizeof(void*));
-            uacpi_memcpy(&vendor_data_length, src, sizeof(uacpi_u16));
-
-            if (vendor_data == UACPI_NULL) {
-                uacpi_size full_aml_size;
-
-                if (uacpi_unlikely(vendor_data_length != 0)) {
-                    uacpi_error(
-                        "vendor_data_length is %d, but pointer is NULL\n",
-                        vendor_data_length
-                    );
-                    ctx->st = UACPI_STATUS_INVALID_ARGUMENT;
-                    return UACPI_ITERATION_DECISION_BREAK;
-                }
-
-                /*
-                 * There's no vendor data. The specification still mandates
-                 * that we fill the vendor data offset field correctly, meaning
-                 * we set it to the total length of the resource.
-                 */
-                full_aml_size = aml_size;
-                full_aml_size += aml_resource_kind_to_header_size[
-                    spec->resource_kind
-                ];
-
-                uacpi_memcpy(dst, &full_aml_size, sizeof(uacpi_u16));
-                break;
-            }
+            ctx->st = UACPI_STATUS_INVALID_ARGUMENT;
+            return UACPI_ITERATION_DECISION_BREAK;
+        }
 
-            /*
-             * Calculate the offset of vendor data from the end of the native
-             * resource and use it since it matches the offset from the end of
-             * the AML resource.
-             *
-             * Non-zero value means there's a source string in between.
-             */
-            data_offset = vendor_data - (uacpi_u8*)resource_end;
-            vendor_data_offset = data_offset + base_aml_size_with_header;
+        uacpi_memcpy(dst_string, src_string, length);
+        break;
+    }
 
-            // Write vendor_data_offset
-            uacpi_memcpy(dst, &vendor_data_offset, sizeof(uacpi_u16));
+    case UACPI_RESOURCE_CONVERT_OPCODE_LOAD_PIN_TABLE_LENGTH:
+        state->accumulator = load_u32_zerout(src, sizeof(uacpi_u16));
+        state->accumulator *= sizeof(uacpi_u16);
+        break;
 
-            /*
-             * Write vendor_data_length, this field is right after
-             * vendor_data_offset, and is completely redundant, but it exists
-             * nonetheless.
-             */
-            uacpi_memcpy(
-                dst + sizeof(uacpi_u16),
-                &vendor_data_length,
-                sizeof(vendor_data_length)
-            );
+    case UACPI_RESOURCE_CONVERT_OPCODE_PIN_TABLE: {
+        uacpi_u16 pin_table_offset = state->base_aml_size_with_header;
+
+        /*
+         * The pin table resides right at the end of the base resource,
+         * set the offset to it in the AML we're encoding.
+         */
+        uacpi_memcpy(dst, &pin_table_offset, sizeof(pin_table_offset));
+
+        /*
+         * Copy the actual data. It also resides right at the end of the
+         * native base resource.
+         */
+        uacpi_memcpy(
+            dst_base + state->base_aml_size_with_header,
+            state->resource_end,
+            state->accumulator
+        );
+        break;
+    }
 
-            // Finally write the data itself
-            uacpi_memcpy(
-                dst_base + vendor_data_offset,
-                vendor_data,
-                vendor_data_length
-            );
-            break;
-        }
+    case UACPI_RESOURCE_CONVERT_OPCODE_VENDOR_DATA: {
+        uacpi_u16 vendor_data_length, data_offset, vendor_data_offset;
+        uacpi_u8 *vendor_data;
 
-        case UACPI_RESOURCE_CONVERT_OPCODE_SERIAL_TYPE_SPECIFIC: {
-            uacpi_u8 serial_type = *src;
-            *dst = serial_type;
+        // Read the vendor_data pointer
+        uacpi_memcpy(&vendor_data, NATIVE_OFFSET(resource, insn->arg2),
+                     sizeof(void*));
+        uacpi_memcpy(&vendor_data_length, src, sizeof(uacpi_u16));
 
-            ctx->st = validate_aml_serial_type(serial_type);
-            if (uacpi_unlikely_error(ctx->st))
-                return UACPI_ITERATION_DECISION_BREAK;
+        if (vendor_data == UACPI_NULL) {
+            uacpi_size full_aml_size;
 
-            if (uacpi_unlikely(resource->type !=
-                               aml_serial_to_native_type(serial_type))) {
+            if (uacpi_unlikely(vendor_data_length != 0)) {
                 uacpi_error(
-                    "native serial resource type %d doesn't match expected %d\n",
-                    resource->type, aml_serial_to_native_type(serial_type)
+                    "vendor_data_length is %d, but pointer is NULL\n",
+                    vendor_data_length
                 );
                 ctx->st = UACPI_STATUS_INVALID_ARGUMENT;
                 return UACPI_ITERATION_DECISION_BREAK;
             }
 
-            // Rebase the end pointer & size now that we know the serial type
-            resource_end = PTR_AT(
-                resource_end,
-                aml_serial_resource_to_extra_native_size[serial_type]
-            );
-            base_aml_size_with_header += aml_serial_resource_to_extra_aml_size[
-                serial_type
+            /*
+             * There's no vendor data. The specification still mandates
+             * that we fill the vendor data offset field correctly, meaning
+             * we set it to the total length of the resource.
+             */
+            full_aml_size = aml_size;
+            full_aml_size += aml_resource_kind_to_header_size[
+                spec->resource_kind
             ];
 
-            accumulator = resource->serial_bus_common.vendor_data_length;
-            if (accumulator == 0)
-                break;
-
-            // Copy vendor data
-            uacpi_memcpy(
-                dst_base + base_aml_size_with_header,
-                resource_end,
-                accumulator
-            );
+            uacpi_memcpy(dst, &full_aml_size, sizeof(uacpi_u16));
             break;
         }
 
-        CONVERSION_OPCODES_COMMON(src)
-        }
+        /*
+         * Calculate the offset of vendor data from the end of the native
+         * resource and use it since it matches the offset from the end of
+         * the AML resource.
+         *
+         * Non-zero value means there's a source string in between.
+         */
+        data_offset = vendor_data - (uacpi_u8*)state->resource_end;
+        vendor_data_offset = data_offset + state->base_aml_size_with_header;
+
+        // Write vendor_data_offset
+        uacpi_memcpy(dst, &vendor_data_offset, sizeof(uacpi_u16));
+
+        /*
+         * Write vendor_data_length, this field is right after
+         * vendor_data_offset, and is completely redundant, but it exists
+         * nonetheless.
+         */
+        uacpi_memcpy(
+            dst + sizeof(uacpi_u16),
+            &vendor_data_length,
+            sizeof(vendor_data_length)
+        );
+
+        // Finally write the data itself
+        uacpi_memcpy(
+            dst_base + vendor_data_offset,
+            vendor_data,
+            vendor_data_length
+        );
+        break;
     }
-}
 
-#define INLINE_END_TAG &(uacpi_resource) { .type = UACPI_RESOURCE_TYPE_END_TAG }
+    case UACPI_RESOURCE_CONVERT_OPCODE_SERIAL_TYPE_SPECIFIC: {
+        uacpi_u8 serial_type = *src;
+        *dst = serial_type;
 
-static uacpi_status native_resources_to_aml(
-    uacpi_resources *native_resources, void *aml_buffer
-)
-{
-    uacpi_status ret;
-    struct resource_conversion_ctx ctx = {
-        .buf = aml_buffer,
-    };
+        ctx->st = validate_aml_serial_type(serial_type);
+        if (uacpi_unlikely_error(ctx->st))
+            return UACPI_ITERATION_DECISION_BREAK;
 
-    ret = uacpi_for_each_resource(
-        native_resources, do_native_resource_to_aml, &ctx
-    );
-    if (ret == UACPI_STATUS_NO_RESOURCE_END_TAG) {
-        // An end tag is always included
-        do_native_resource_to_aml(&ctx, INLINE_END_TAG);
-        ret = UACPI_STATUS_OK;
+        if (uacpi_unlikely(resource->type !=
+                           aml_serial_to_native_type(serial_type))) {
+            uacpi_error(
+                "native serial resource type %d doesn't match expected %d\n",
+                resource->type, aml_serial_to_native_type(serial_type)
+            );
+            ctx->st = UACPI_STATUS_INVALID_ARGUMENT;
+            return UACPI_ITERATION_DECISION_BREAK;
+        }
+
+        // Rebase the end pointer & size now that we know the serial type
+        state->resource_end = PTR_AT(
+            state->resource_end,
+            aml_serial_resource_to_extra_native_size[serial_type]
+        );
+        state->base_aml_size_with_header +=
+            aml_serial_resource_to_extra_aml_size[serial_type];
+
+        state->accumulator = resource->serial_bus_common.vendor_data_length;
+        if (state->accumulator == 0)
+            break;
+
+        // Copy vendor data
+        uacpi_memcpy(
+            dst_base + state->base_aml_size_with_header,
+            state->resource_end,
+            state->accumulator
+        );
+        break;
+    }
+
+    CONVERSION_OPCODES_COMMON(src)
     }
-    if (uacpi_unlikely_error(ret))
-        return ret;
 
-    return ctx.st;
+    return UACPI_ITERATION_DECISION_CONTINUE;
 }
 
-static uacpi_iteration_decision accumulate_aml_buffer_size(
+static uacpi_iteration_decision do_native_resource_to_aml(
     void *opaque, uacpi_resource *resource
 )
 {
     struct resource_conversion_ctx *ctx = opaque;
+    struct uacpi_resource_convert_state state;
     const struct uacpi_resource_spec *spec;
-    uacpi_size size_for_this;
+    const struct uacpi_resource_convert_instruction *insns;
+    uacpi_iteration_decision decision;
+    uacpi_u8 *dst_base;
+    uacpi_u32 aml_size;
+    uacpi_u8 pc = 0;
 
-    // resource->type is sanitized to be valid here by the iteration function
     spec = resource_spec_from_native(resource);
+    aml_size = aml_size_for_native_resource(resource, spec);
+    insns = spec->to_aml;
 
-    size_for_this = aml_size_for_native_resource(resource, spec);
-    if (size_for_this == 0 || (ctx->size + size_for_this) < ctx->size) {
-        uacpi_error("invalid aml size for native resource: %zu\n",
-                    size_for_this);
+    if (uacpi_unlikely(aml_size == 0)) {
+        uacpi_error("invalid aml size for native resource: %u\n", aml_size);
         ctx->st = UACPI_STATUS_INVALID_ARGUMENT;
         return UACPI_ITERATION_DECISION_BREAK;
     }
 
-    ctx->size += size_for_this;
-    return UACPI_ITERATION_DECISION_CONTINUE;
+    if (!reserve_aml_output(ctx, aml_size))
+        return UACPI_ITERATION_DECISION_BREAK;
+
+    dst_base = ctx->byte_buf;
+    ctx->byte_buf += aml_size;
+    aml_size -= aml_resource_kind_to_header_size[spec->resource_kind];
+
+    if (spec->resource_kind == UACPI_AML_RESOURCE_KIND_LARGE) {
+        *dst_base = ACPI_LARGE_ITEM | type_to_aml_resource[spec->type];
+        uacpi_memcpy(dst_base + 1, &aml_size, sizeof(uacpi_u16));
+    } else {
+        *dst_base = type_to_aml_resource[spec->type] << ACPI_SMALL_ITEM_NAME_IDX;
+        *dst_base |= aml_size;
+    }
+
+    state.ctx = ctx;
+    state.spec = spec;
+    state.resource = resource;
+    state.aml = dst_base;
+    state.resource_end = PTR_AT(resource, spec->native_size);
+    state.aml_size = aml_size;
+    state.header_size = aml_resource_kind_to_header_size[spec->resource_kind];
+    state.base_aml_size = state.base_aml_size_with_header = spec->aml_size;
+    state.base_aml_size_with_header += state.header_size;
+    state.accumulator = 0;
+    state.skip = 0;
+    state.done = UACPI_FALSE;
+
+    if (insns == UACPI_NULL)
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+#ifdef UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+    if (!g_force_interpreter)
+        return spec->to_aml_specialized(&state);
+#endif
+
+    for (;;) {
+        decision = native_to_aml_step(&state, &insns[pc++]);
+        if (decision != UACPI_ITERATION_DECISION_CONTINUE || state.done)
+            return decision;
+
+        pc += state.skip;
+        state.skip = 0;
+    }
 }
 
-uacpi_status uacpi_native_resources_to_aml(
-    uacpi_resources *resources, uacpi_object **out_template
+#ifdef UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+/*
+ * Expand every conversion program into a chain of calls to the step function
+ * of the respective direction with a constant instruction. This lets the
+ * compiler fold each step down to the handful of loads and stores the
+ * instruction actually performs, leaving no dispatch at runtime.
+ */
+#undef OP
+#define OP(short_code, ...)                                                 \
+    (decision != UACPI_ITERATION_DECISION_CONTINUE || state->done ?         \
+        (void)0 :                                                           \
+     state->skip ?                                                          \
+        (void)state->skip-- :                                               \
+        (void)(decision = CONVERSION_STEP(                                  \
+            state, &(const struct uacpi_resource_convert_instruction) {     \
+                .code = UACPI_RESOURCE_CONVERT_OPCODE_##short_code,         \
+                __VA_ARGS__                                                 \
+            }                                                               \
+        )))
+
+#define DEFINE_SPECIALIZED_CONVERTER(fn_name, program)                     \
+    static UACPI_MAYBE_UNUSED uacpi_iteration_decision fn_name(             \
+        struct uacpi_resource_convert_state *initial_state                  \
+    )                                                                       \
+    {                                                                       \
+        struct uacpi_resource_convert_state local_state = *initial_state;   \
+        struct uacpi_resource_convert_state *state = &local_state;          \
+        uacpi_iteration_decision decision =                                 \
+            UACPI_ITERATION_DECISION_CONTINUE;                              \
+                                                                            \
+        local_state.skip = 0;                                               \
+        local_state.done = UACPI_FALSE;                                     \
+        (void)(CONVERT_##program##_PROGRAM);                                \
+        return decision;                                                    \
+    }
+
+#define CONVERSION_STEP aml_to_native_step
+#define CONVERSION_PROGRAM(name, program) \
+    DEFINE_SPECIALIZED_CONVERTER(convert_##name##_to_native, program)
+ENUMERATE_CONVERSION_PROGRAMS
+#undef CONVERSION_PROGRAM
+#undef CONVERSION_STEP
+
+#define CONVERSION_STEP native_to_aml_step
+#define CONVERSION_PROGRAM(name, program) \
+    DEFINE_SPECIALIZED_CONVERTER(convert_##name##_to_aml, program)
+ENUMERATE_CONVERSION_PROGRAMS
+#undef CONVERSION_PROGRAM
+#undef CONVERSION_STEP
+#endif
+
+#define INLINE_END_TAG &(uacpi_resource) { .type = UACPI_RESOURCE_TYPE_END_TAG }
+
+static uacpi_status native_resources_to_aml_buffer(
+    uacpi_resources *resources, uacpi_buffer *buffer
 )
 {
     uacpi_status ret;
-    uacpi_object *obj;
-    void *buffer;
+    uacpi_size capacity;
     struct resource_conversion_ctx ctx = { 0 };
 
+    /*
+     * AML resources are never bigger than their native counterparts, so the
+     * length of the native list plus an end tag is enough in practice. The
+     * template is short lived, no point in trimming it afterwards.
+     */
+    capacity = UACPI_MIN(resources->length, MAX_RESOURCE_BUFFER_SIZE);
+    capacity += sizeof(struct acpi_resource_end_tag);
+
+    // Whatever the buffer contains is overwritten, only its storage is reused
+    buffer->size = 0;
+
+    ctx.aml_buffer = buffer;
+    ctx.base = uacpi_buffer_grow_data(buffer, capacity);
+    if (uacpi_unlikely(ctx.base == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+    ctx.buf = ctx.base;
+    ctx.capacity = UACPI_MAX(buffer->capacity, capacity);
+
     ret = uacpi_for_each_resource(
-        resources, accumulate_aml_buffer_size, &ctx
+        resources, do_native_resource_to_aml, &ctx
     );
     if (ret == UACPI_STATUS_NO_RESOURCE_END_TAG) {
         // An end tag is always included
-        accumulate_aml_buffer_size(&ctx, INLINE_END_TAG);
+        do_native_resource_to_aml(&ctx, INLINE_END_TAG);
         ret = UACPI_STATUS_OK;
     }
+    if (ret == UACPI_STATUS_OK)
+        ret = ctx.st;
     if (uacpi_unlikely_error(ret))
         return ret;
-    if (uacpi_unlikely_error(ctx.st))
-        return ctx.st;
 
-    // Same reasoning as native_resource_from_aml
-    if (uacpi_unlikely(ctx.size > (5 * 1024u * 1024u))) {
-        uacpi_error("bug: bogus target aml resource buffer size %zu\n",
-                    ctx.size);
-        return UACPI_STATUS_INTERNAL_ERROR;
-    }
+    buffer->size = ctx.byte_buf - ctx.base;
+    return ret;
+}
 
-    buffer = uacpi_kernel_calloc(ctx.size, 1);
-    if (uacpi_unlikely(buffer == UACPI_NULL))
-        return UACPI_STATUS_OUT_OF_MEMORY;
+uacpi_status uacpi_native_resources_to_aml(
+    uacpi_resources *resources, uacpi_object **out_template
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
 
     obj = uacpi_create_object(UACPI_OBJECT_BUFFER);
-    if (uacpi_unlikely(obj == UACPI_NULL)) {
-        uacpi_free(buffer, ctx.size);
+    if (uacpi_unlikely(obj == UACPI_NULL))
         return UACPI_STATUS_OUT_OF_MEMORY;
-    }
-
-    obj->buffer->data = buffer;
-    obj->buffer->size = ctx.size;
 
-    ret = native_resources_to_aml(resources, buffer);
-    if (uacpi_unlikely_error(ret))
+    ret = native_resources_to_aml_buffer(resources, obj->buffer);
+    if (uacpi_unlikely_error(ret)) {
         uacpi_object_unref(obj);
+        return ret;
+    }
 
-    if (ret == UACPI_STATUS_OK)
-        *out_template = obj;
-
+    *out_template = obj;
     return ret;
 }
 
@@ -2484,17 +4003,64 @@ uacpi_status uacpi_set_resources(
 )
 {
     uacpi_status ret;
-    uacpi_object *res_template;
+    uacpi_object *obj = UACPI_NULL, *res_template = UACPI_NULL;
+    uacpi_buffer *buffer;
     uacpi_object_array args;
+    struct uacpi_resource_cache *cache = UACPI_NULL;
+    uacpi_cpu_flags flags;
 
-    ret = uacpi_native_resources_to_aml(resources, &res_template);
+    // Not fatal, the template just isn't kept around for non-devices
+    ret = uacpi_namespace_node_acquire_object_typed(
+        device, UACPI_OBJECT_DEVICE_BIT, &obj
+    );
     if (uacpi_unlikely_error(ret))
-        return ret;
+        obj = UACPI_NULL;
+
+    if (obj != UACPI_NULL && resource_cache_lock != UACPI_NULL) {
+        cache = &obj->device->resource_cache;
+
+        flags = uacpi_lock_native_spinlock(resource_cache_lock);
+        res_template = cache->srs_template;
+        cache->srs_template = UACPI_NULL;
+        uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+    }
+
+    if (res_template == UACPI_NULL) {
+        res_template = uacpi_create_object(UACPI_OBJECT_BUFFER);
+        if (uacpi_unlikely(res_template == UACPI_NULL)) {
+            ret = UACPI_STATUS_OUT_OF_MEMORY;
+            goto out;
+        }
+    }
+
+    buffer = res_template->buffer;
+    ret = native_resources_to_aml_buffer(resources, buffer);
+    if (uacpi_unlikely_error(ret))
+        goto out;
 
     args.objects = &res_template;
     args.count = 1;
     ret = uacpi_eval(device, "_SRS", &args, UACPI_NULL);
 
+    /*
+     * Keep the template around for the next _SRS of this device, unless AML
+     * replaced its buffer or managed to keep a reference to either of them.
+     */
+    if (cache != UACPI_NULL &&
+        res_template->type == UACPI_OBJECT_BUFFER &&
+        res_template->buffer == buffer &&
+        uacpi_shareable_refcount(res_template) == 1 &&
+        uacpi_shareable_refcount(buffer) == 1) {
+        flags = uacpi_lock_native_spinlock(resource_cache_lock);
+        if (cache->srs_template == UACPI_NULL) {
+            cache->srs_template = res_template;
+            res_template = UACPI_NULL;
+        }
+        uacpi_unlock_native_spinlock(resource_cache_lock, flags);
+    }
+
+out:
     uacpi_object_unref(res_template);
+    uacpi_object_unref(obj);
     return ret;
 }
@@ -1,7 +1,19 @@
 #include <uacpi/internal/shareable.h>
 #include <uacpi/platform/atomic.h>
 
-#define BUGGED_REFCOUNT 0xFFFFFFFF
+#define BUGGED_REFCOUNT UACPI_SHAREABLE_BUGGED_REFCOUNT
+
+#ifdef UACPI_SINGLE_THREADED
+#define REFCOUNT_LOAD(ptr) (*(ptr))
+#define REFCOUNT_STORE(ptr, value) (*(ptr) = (value))
+#define REFCOUNT_INC(ptr) (++*(ptr))
+#define REFCOUNT_DEC(ptr) (--*(ptr))
+#else
+#define REFCOUNT_LOAD(ptr) uacpi_atomic_load32(ptr)
+#define REFCOUNT_STORE(ptr, value) uacpi_atomic_store32(ptr, value)
+#define REFCOUNT_INC(ptr) uacpi_atomic_inc32(ptr)
+#define REFCOUNT_DEC(ptr) uacpi_atomic_dec32(ptr)
+#endif
 
 void uacpi_shareable_init(uacpi_handle handle)
 {
@@ -16,13 +28,13 @@ uacpi_bool uacpi_bugged_shareable(uacpi_handle handle)
     if (uacpi_unlikely(shareable->reference_count == 0))
         uacpi_make_shareable_bugged(shareable);
 
-    return uacpi_atomic_load32(&shareable->reference_count) == BUGGED_REFCOUNT;
+    return REFCOUNT_LOAD(&shareable->reference_count) == BUGGED_REFCOUNT;
 }
 
 void uacpi_make_shareable_bugged(uacpi_handle handle)
 {
     struct uacpi_shareable *shareable = handle;
-    uacpi_atomic_store32(&shareable->reference_count, BUGGED_REFCOUNT);
+    REFCOUNT_STORE(&shareable->reference_count, BUGGED_REFCOUNT);
 }
 
 uacpi_u32 uacpi_shareable_ref(uacpi_handle handle)
@@ -32,7 +44,7 @@ uacpi_u32 uacpi_shareable_ref(uacpi_handle handle)
     if (uacpi_unlikely(uacpi_bugged_shareable(shareable)))
         return BUGGED_REFCOUNT;
 
-    return uacpi_atomic_inc32(&shareable->reference_count) - 1;
+    return REFCOUNT_INC(&shareable->reference_count) - 1;
 }
 
 uacpi_u32 uacpi_shareable_unref(uacpi_handle handle)
@@ -42,7 +54,7 @@ uacpi_u32 uacpi_shareable_unref(uacpi_handle handle)
     if (uacpi_unlikely(uacpi_bugged_shareable(shareable)))
         return BUGGED_REFCOUNT;
 
-    return uacpi_atomic_dec32(&shareable->reference_count) + 1;
+    return REFCOUNT_DEC(&shareable->reference_count) + 1;
 }
 
 void uacpi_shareable_unref_and_delete_if_last(
@@ -62,5 +74,5 @@ void uacpi_shareable_unref_and_delete_if_last(
 uacpi_u32 uacpi_shareable_refcount(uacpi_handle handle)
 {
     struct uacpi_shareable *shareable = handle;
-    return uacpi_atomic_load32(&shareable->reference_count);
+    return REFCOUNT_LOAD(&shareable->reference_count);
 }
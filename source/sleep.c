@@ -212,6 +212,10 @@ static uacpi_status get_slp_type_for_state(
         goto out;
     }
 
+    ret = uacpi_object_expand_package(ret_obj);
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
     switch (ret_obj->package->count) {
     case 0:
         uacpi_error("empty package while evaluating %s!\n", path);
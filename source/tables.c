@@ -4,6 +4,7 @@
 #include <uacpi/internal/interpreter.h>
 #include <uacpi/platform/config.h>
 #include <uacpi/internal/mutex.h>
+#include <uacpi/internal/timeline.h>
 
 DYNAMIC_ARRAY_WITH_INLINE_STORAGE(
     table_array, struct uacpi_installed_table, UACPI_STATIC_TABLE_ARRAY_LEN
@@ -17,6 +18,13 @@ static uacpi_bool early_table_access;
 static uacpi_table_installation_handler installation_handler;
 static uacpi_handle table_mutex;
 
+/*
+ * The RSDP and RSDT/XSDT might be parsed before uacpi_initialize, at which
+ * point there's no timeline to submit these to yet.
+ */
+static uacpi_timeline_record rsdp_record;
+static uacpi_timeline_record rxsdt_record;
+
 static uacpi_status table_install_physical_with_origin_unlocked(
     uacpi_phys_addr phys, enum uacpi_table_origin origin,
     const uacpi_char *expected_signature, uacpi_table *out_table
@@ -70,11 +78,19 @@ static uacpi_status initialize_from_rxsdt(uacpi_phys_addr rxsdt_addr,
     uacpi_phys_addr entry_addr;
     uacpi_status ret;
 
+    uacpi_memzero(&rxsdt_record, sizeof(rxsdt_record));
+    rxsdt_record.event = UACPI_TIMELINE_EVENT_RXSDT_PARSE;
+    rxsdt_record.begin_ns = uacpi_kernel_get_nanoseconds_since_boot();
+
     rxsdt = uacpi_kernel_map(rxsdt_addr, map_len);
     if (rxsdt == UACPI_NULL)
         return UACPI_STATUS_MAPPING_FAILED;
 
     dump_table_header(rxsdt_addr, rxsdt);
+    uacpi_memcpy(
+        rxsdt_record.signature.text, rxsdt->hdr.signature,
+        sizeof(rxsdt->hdr.signature)
+    );
 
     ret = uacpi_check_table_signature(rxsdt,
         entry_size == 8 ? ACPI_XSDT_SIGNATURE : ACPI_RSDT_SIGNATURE);
@@ -113,12 +129,18 @@ static uacpi_status initialize_from_rxsdt(uacpi_phys_addr rxsdt_addr,
         if (uacpi_unlikely(ret != UACPI_STATUS_OK &&
                            ret != UACPI_STATUS_OVERRIDDEN))
             goto error_out;
+
+        rxsdt_record.count++;
     }
 
     ret = UACPI_STATUS_OK;
 
 error_out:
     uacpi_kernel_unmap(rxsdt, map_len);
+
+    rxsdt_record.end_ns = uacpi_kernel_get_nanoseconds_since_boot();
+    rxsdt_record.status = ret;
+    uacpi_timeline_submit(&rxsdt_record);
     return ret;
 }
 
@@ -132,6 +154,10 @@ static uacpi_status initialize_from_rsdp(void)
 
     g_uacpi_rt_ctx.is_rev1 = UACPI_TRUE;
 
+    uacpi_memzero(&rsdp_record, sizeof(rsdp_record));
+    rsdp_record.event = UACPI_TIMELINE_EVENT_RSDP_PARSE;
+    rsdp_record.begin_ns = uacpi_kernel_get_nanoseconds_since_boot();
+
     ret = uacpi_kernel_get_rsdp(&rsdp_phys);
     if (uacpi_unlikely_error(ret))
         return ret;
@@ -154,6 +180,9 @@ static uacpi_status initialize_from_rsdp(void)
 
     uacpi_kernel_unmap(rsdp, sizeof(struct acpi_rsdp));
 
+    rsdp_record.end_ns = uacpi_kernel_get_nanoseconds_since_boot();
+    uacpi_timeline_submit(&rsdp_record);
+
     if (!rxsdt) {
         uacpi_error("both RSDT & XSDT tables are NULL!\n");
         return UACPI_STATUS_INVALID_ARGUMENT;
@@ -239,6 +268,9 @@ uacpi_status uacpi_initialize_tables(void)
         }
 
         early_table_access = UACPI_FALSE;
+
+        uacpi_timeline_submit(&rsdp_record);
+        uacpi_timeline_submit(&rxsdt_record);
     } else {
         uacpi_status ret;
 
@@ -266,7 +298,7 @@ uacpi_status uacpi_initialize_tables(void)
         }
     }
 
-    table_mutex = uacpi_kernel_create_mutex();
+    table_mutex = uacpi_create_native_mutex();
     if (uacpi_unlikely(table_mutex == UACPI_NULL))
         return UACPI_STATUS_OUT_OF_MEMORY;
 
@@ -302,7 +334,7 @@ void uacpi_deinitialize_tables(void)
     }
 
     if (table_mutex)
-        uacpi_kernel_free_mutex(table_mutex);
+        uacpi_free_native_mutex(table_mutex);
 
     installation_handler = UACPI_NULL;
     table_mutex = UACPI_NULL;
@@ -508,7 +540,7 @@ static uacpi_status table_unref_unlocked(struct uacpi_installed_table *tbl)
     return UACPI_STATUS_OK;
 }
 
-static uacpi_status verify_and_install_table(
+static uacpi_status do_verify_and_install_table(
     struct acpi_sdt_hdr *hdr, uacpi_phys_addr phys_addr, void *virt_addr,
     enum uacpi_table_origin origin, uacpi_table *out_table
 )
@@ -575,6 +607,25 @@ static uacpi_status verify_and_install_table(
     return UACPI_STATUS_OK;
 }
 
+static uacpi_status verify_and_install_table(
+    struct acpi_sdt_hdr *hdr, uacpi_phys_addr phys_addr, void *virt_addr,
+    enum uacpi_table_origin origin, uacpi_table *out_table
+)
+{
+    uacpi_status ret;
+    uacpi_timeline_record rec;
+
+    uacpi_timeline_begin(&rec, UACPI_TIMELINE_EVENT_TABLE_INSTALL);
+    uacpi_memcpy(rec.signature.text, hdr->signature, sizeof(hdr->signature));
+
+    ret = do_verify_and_install_table(
+        hdr, phys_addr, virt_addr, origin, out_table
+    );
+
+    uacpi_timeline_end(&rec, ret);
+    return ret;
+}
+
 static uacpi_status handle_table_override(
     uacpi_table_installation_disposition disposition, uacpi_u64 address,
     uacpi_table *out_table
@@ -1071,6 +1122,8 @@ uacpi_status uacpi_table_load_with_cause(
 )
 {
     uacpi_status ret;
+    uacpi_timeline_record rec;
+    struct acpi_sdt_hdr *hdr;
     struct table_ctl_request req = {
         .type = TABLE_CTL_SET_FLAGS | TABLE_CTL_VALIDATE_CLEAR_FLAGS |
                 TABLE_CTL_GET,
@@ -1082,7 +1135,12 @@ uacpi_status uacpi_table_load_with_cause(
     if (uacpi_unlikely_error(ret))
         return ret;
 
+    hdr = req.out_tbl;
+    uacpi_timeline_begin(&rec, UACPI_TIMELINE_EVENT_TABLE_LOAD);
+    uacpi_memcpy(rec.signature.text, hdr->signature, sizeof(hdr->signature));
+
     ret = uacpi_execute_table(req.out_tbl, cause);
+    uacpi_timeline_end(&rec, ret);
 
     req.type = TABLE_CTL_PUT;
     table_ctl(idx, &req);
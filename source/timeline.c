@@ -0,0 +1,191 @@
+#include <uacpi/internal/timeline.h>
+#include <uacpi/internal/namespace.h>
+#include <uacpi/internal/dynamic_array.h>
+#include <uacpi/internal/stdlib.h>
+#include <uacpi/internal/mutex.h>
+#include <uacpi/internal/log.h>
+#include <uacpi/kernel_api.h>
+
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE(record_array, uacpi_timeline_record, 8)
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE_IMPL(
+    record_array, uacpi_timeline_record, static
+)
+
+static struct record_array records;
+static uacpi_handle timeline_mutex;
+static uacpi_bool timeline_oom;
+
+const uacpi_char *uacpi_timeline_event_to_string(uacpi_timeline_event event)
+{
+    switch (event) {
+    case UACPI_TIMELINE_EVENT_RSDP_PARSE:
+        return "RSDP parse";
+    case UACPI_TIMELINE_EVENT_RXSDT_PARSE:
+        return "RSDT/XSDT parse";
+    case UACPI_TIMELINE_EVENT_TABLE_INSTALL:
+        return "table install";
+    case UACPI_TIMELINE_EVENT_TABLE_LOAD:
+        return "table load";
+    case UACPI_TIMELINE_EVENT_REG:
+        return "_REG";
+    case UACPI_TIMELINE_EVENT_STA:
+        return "_STA";
+    case UACPI_TIMELINE_EVENT_INI:
+        return "_INI";
+    case UACPI_TIMELINE_EVENT_GPE_MATCH:
+        return "GPE match";
+    default:
+        return "<invalid>";
+    }
+}
+
+uacpi_status uacpi_initialize_timeline(void)
+{
+    if (!uacpi_check_flag(UACPI_FLAG_BOOT_TIMELINE))
+        return UACPI_STATUS_OK;
+
+    timeline_mutex = uacpi_create_native_mutex();
+    if (uacpi_unlikely(timeline_mutex == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    return UACPI_STATUS_OK;
+}
+
+void uacpi_deinitialize_timeline(void)
+{
+    uacpi_size i;
+
+    for (i = 0; i < record_array_size(&records); ++i) {
+        uacpi_timeline_record *rec = record_array_at(&records, i);
+
+        if (rec->node != UACPI_NULL)
+            uacpi_namespace_node_unref(rec->node);
+    }
+    record_array_clear(&records);
+
+    if (timeline_mutex != UACPI_NULL)
+        uacpi_free_native_mutex(timeline_mutex);
+
+    timeline_mutex = UACPI_NULL;
+    timeline_oom = UACPI_FALSE;
+}
+
+void uacpi_timeline_submit(const uacpi_timeline_record *rec)
+{
+    uacpi_timeline_record *new_rec;
+
+    if (!uacpi_timeline_is_active() || timeline_mutex == UACPI_NULL)
+        return;
+
+    if (uacpi_unlikely_error(uacpi_acquire_native_mutex(timeline_mutex)))
+        return;
+
+    new_rec = record_array_alloc(&records);
+    if (uacpi_unlikely(new_rec == UACPI_NULL)) {
+        // Don't spam the log for every record that follows
+        if (!timeline_oom)
+            uacpi_warn("unable to grow the boot timeline, dropping records\n");
+        timeline_oom = UACPI_TRUE;
+        goto out;
+    }
+
+    *new_rec = *rec;
+    if (new_rec->node != UACPI_NULL)
+        uacpi_shareable_ref(new_rec->node);
+
+out:
+    uacpi_release_native_mutex(timeline_mutex);
+}
+
+void uacpi_timeline_begin(
+    uacpi_timeline_record *rec, uacpi_timeline_event event
+)
+{
+    uacpi_memzero(rec, sizeof(*rec));
+
+    if (!uacpi_timeline_is_active())
+        return;
+
+    rec->event = event;
+
+    // Snapshots of the counters, turned into deltas by uacpi_timeline_end
+    rec->ops = g_uacpi_rt_ctx.opcodes_executed;
+    rec->allocations = uacpi_atomic_load64(&g_uacpi_rt_ctx.objects_allocated);
+    rec->begin_ns = uacpi_kernel_get_nanoseconds_since_boot();
+}
+
+void uacpi_timeline_end(uacpi_timeline_record *rec, uacpi_status status)
+{
+    if (!uacpi_timeline_is_active())
+        return;
+
+    rec->end_ns = uacpi_kernel_get_nanoseconds_since_boot();
+    rec->ops = g_uacpi_rt_ctx.opcodes_executed - rec->ops;
+    rec->allocations =
+        uacpi_atomic_load64(&g_uacpi_rt_ctx.objects_allocated) -
+        rec->allocations;
+    rec->status = status;
+
+    uacpi_timeline_submit(rec);
+}
+
+uacpi_status uacpi_get_boot_timeline(uacpi_boot_timeline **out_timeline)
+{
+    uacpi_boot_timeline *timeline;
+    uacpi_size i, count;
+    uacpi_status ret;
+
+    if (uacpi_unlikely(!uacpi_check_flag(UACPI_FLAG_BOOT_TIMELINE)))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    ret = uacpi_acquire_native_mutex_may_be_null(timeline_mutex);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    count = record_array_size(&records);
+
+    // The records are stored right after the header
+    timeline = uacpi_kernel_alloc(
+        sizeof(*timeline) + count * sizeof(uacpi_timeline_record)
+    );
+    if (uacpi_unlikely(timeline == UACPI_NULL)) {
+        ret = UACPI_STATUS_OUT_OF_MEMORY;
+        goto out;
+    }
+
+    timeline->count = count;
+    timeline->records = (uacpi_timeline_record*)(timeline + 1);
+
+    for (i = 0; i < count; ++i) {
+        uacpi_timeline_record *rec = &timeline->records[i];
+
+        *rec = *record_array_at(&records, i);
+        if (rec->node != UACPI_NULL)
+            uacpi_shareable_ref(rec->node);
+    }
+
+    *out_timeline = timeline;
+out:
+    uacpi_release_native_mutex_may_be_null(timeline_mutex);
+    return ret;
+}
+
+void uacpi_free_boot_timeline(uacpi_boot_timeline *timeline)
+{
+    uacpi_size i;
+
+    if (timeline == UACPI_NULL)
+        return;
+
+    for (i = 0; i < timeline->count; ++i) {
+        uacpi_namespace_node *node = timeline->records[i].node;
+
+        if (node != UACPI_NULL)
+            uacpi_namespace_node_unref(node);
+    }
+
+    uacpi_free(
+        timeline,
+        sizeof(*timeline) + timeline->count * sizeof(uacpi_timeline_record)
+    );
+}
@@ -6,6 +6,10 @@
 #include <uacpi/internal/log.h>
 #include <uacpi/internal/namespace.h>
 #include <uacpi/internal/tables.h>
+#include <uacpi/internal/context.h>
+#include <uacpi/internal/mutex.h>
+#include <uacpi/internal/resources.h>
+#include <uacpi/internal/timeline.h>
 #include <uacpi/kernel_api.h>
 
 const uacpi_char *uacpi_object_type_to_string(uacpi_object_type type)
@@ -90,6 +94,88 @@ const uacpi_char *uacpi_address_space_to_string(
     }
 }
 
+static uacpi_bool buffer_data_fits_inline(uacpi_size size)
+{
+#if UACPI_BUFFER_INLINE_STORAGE_SIZE
+    return size <= UACPI_BUFFER_INLINE_STORAGE_SIZE;
+#else
+    UACPI_UNUSED(size);
+    return UACPI_FALSE;
+#endif
+}
+
+void *uacpi_buffer_alloc_data(uacpi_buffer *buf, uacpi_size size)
+{
+#if UACPI_BUFFER_INLINE_STORAGE_SIZE
+    if (buffer_data_fits_inline(size)) {
+        buf->data = buf->inline_data;
+        return buf->data;
+    }
+#endif
+
+    buf->capacity = 0;
+    buf->data = uacpi_kernel_alloc(size);
+    return buf->data;
+}
+
+static uacpi_size buffer_data_capacity(uacpi_buffer *buf)
+{
+    if (buf->data == UACPI_NULL)
+        return 0;
+
+#if UACPI_BUFFER_INLINE_STORAGE_SIZE
+    if (buf->data == buf->inline_data)
+        return UACPI_BUFFER_INLINE_STORAGE_SIZE;
+#endif
+
+    if (buf->capacity)
+        return buf->capacity;
+
+    /*
+     * If buffer has a size of 0 but a valid data pointer it's probably an
+     * "empty" buffer allocated by the interpreter in make_null_buffer
+     * and its real size is actually 1.
+     */
+    return UACPI_MAX(buf->size, 1);
+}
+
+void *uacpi_buffer_grow_data(uacpi_buffer *buf, uacpi_size size)
+{
+    uacpi_size capacity;
+    void *new_data;
+
+    capacity = buffer_data_capacity(buf);
+    if (size <= capacity)
+        return buf->data;
+
+    capacity = UACPI_MAX(size, capacity * 2);
+
+    new_data = uacpi_kernel_alloc(capacity);
+    if (uacpi_unlikely(new_data == UACPI_NULL))
+        return UACPI_NULL;
+
+    uacpi_memcpy(new_data, buf->data, buf->size);
+    uacpi_buffer_free_data(buf);
+
+    buf->data = new_data;
+    buf->capacity = capacity;
+    return buf->data;
+}
+
+void uacpi_buffer_free_data(uacpi_buffer *buf)
+{
+    if (buf->data == UACPI_NULL)
+        return;
+
+#if UACPI_BUFFER_INLINE_STORAGE_SIZE
+    if (buf->data != buf->inline_data)
+#endif
+        uacpi_free(buf->data, buffer_data_capacity(buf));
+
+    buf->data = UACPI_NULL;
+    buf->capacity = 0;
+}
+
 static uacpi_bool buffer_alloc(uacpi_object *obj, uacpi_size initial_size)
 {
     uacpi_buffer *buf;
@@ -101,8 +187,7 @@ static uacpi_bool buffer_alloc(uacpi_object *obj, uacpi_size initial_size)
     uacpi_shareable_init(buf);
 
     if (initial_size) {
-        buf->data = uacpi_kernel_alloc(initial_size);
-        if (uacpi_unlikely(buf->data == UACPI_NULL)) {
+        if (uacpi_unlikely(!uacpi_buffer_alloc_data(buf, initial_size))) {
             uacpi_free(buf, sizeof(*buf));
             return UACPI_FALSE;
         }
@@ -147,6 +232,79 @@ uacpi_bool uacpi_package_fill(
     return UACPI_TRUE;
 }
 
+uacpi_bool uacpi_package_fill_integers(
+    uacpi_package *pkg, uacpi_size num_elements
+)
+{
+    if (uacpi_unlikely(num_elements == 0))
+        return UACPI_TRUE;
+
+    pkg->integers = uacpi_kernel_alloc(num_elements * sizeof(*pkg->integers));
+    if (uacpi_unlikely(pkg->integers == UACPI_NULL))
+        return UACPI_FALSE;
+
+    pkg->count = num_elements;
+    pkg->flags |= UACPI_STORAGE_INTEGER_ARRAY;
+    return UACPI_TRUE;
+}
+
+uacpi_status uacpi_package_expand(uacpi_package *pkg)
+{
+    uacpi_object **objects;
+    uacpi_size i;
+
+    if (!(pkg->flags & UACPI_STORAGE_INTEGER_ARRAY))
+        return UACPI_STATUS_OK;
+
+    objects = uacpi_kernel_calloc(pkg->count, sizeof(*objects));
+    if (uacpi_unlikely(objects == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    for (i = 0; i < pkg->count; ++i) {
+        objects[i] = uacpi_create_object(UACPI_OBJECT_INTEGER);
+        if (uacpi_unlikely(objects[i] == UACPI_NULL)) {
+            while (i-- > 0)
+                uacpi_object_unref(objects[i]);
+
+            uacpi_free(objects, pkg->count * sizeof(*objects));
+            return UACPI_STATUS_OUT_OF_MEMORY;
+        }
+
+        objects[i]->integer = pkg->integers[i];
+    }
+
+    uacpi_free(pkg->integers, pkg->count * sizeof(*pkg->integers));
+    pkg->objects = objects;
+    pkg->flags &= ~UACPI_STORAGE_INTEGER_ARRAY;
+    return UACPI_STATUS_OK;
+}
+
+uacpi_status uacpi_object_expand_package(uacpi_object *obj)
+{
+    uacpi_status ret;
+
+    if (!(obj->package->flags & UACPI_STORAGE_INTEGER_ARRAY))
+        return UACPI_STATUS_OK;
+
+    ret = uacpi_object_unshare(obj, UACPI_STORAGE_ACCESS_WRITE);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    return uacpi_package_expand(obj->package);
+}
+
+uacpi_object *uacpi_package_element(
+    uacpi_package *pkg, uacpi_size idx, uacpi_object *scratch
+)
+{
+    if (!(pkg->flags & UACPI_STORAGE_INTEGER_ARRAY))
+        return pkg->objects[idx];
+
+    scratch->type = UACPI_OBJECT_INTEGER;
+    scratch->integer = pkg->integers[idx];
+    return scratch;
+}
+
 static uacpi_bool package_alloc(
     uacpi_object *obj, uacpi_size initial_size,
     enum uacpi_prealloc_objects prealloc
@@ -184,7 +342,7 @@ uacpi_mutex *uacpi_create_mutex(void)
 
     mutex->owner = UACPI_THREAD_ID_NONE;
 
-    mutex->handle = uacpi_kernel_create_mutex();
+    mutex->handle = uacpi_create_native_mutex();
     if (mutex->handle == UACPI_NULL) {
         uacpi_free(mutex, sizeof(*mutex));
         return UACPI_NULL;
@@ -329,6 +487,7 @@ uacpi_object *uacpi_create_object(uacpi_object_type type)
     if (uacpi_unlikely(ret == UACPI_NULL))
         return ret;
 
+    uacpi_timeline_count_allocation();
     uacpi_shareable_init(ret);
     ret->type = type;
 
@@ -344,21 +503,110 @@ uacpi_object *uacpi_create_object(uacpi_object_type type)
     return ret;
 }
 
+/*
+ * A packed allocation consists of this header followed by members, each of
+ * which is a package (along with its object array), an object, or a buffer
+ * (along with its payload). Every member is prefixed with a pointer back to
+ * the header, which counts the members that are still alive. See
+ * PACKED_MEMBER_ALIGNMENT for the layout.
+ */
+struct packed_block {
+    struct uacpi_shareable shareable;
+    uacpi_size size;
+};
+
+static void packed_block_unref(struct packed_block *block)
+{
+    if (uacpi_shareable_unref(block) > 1)
+        return;
+
+    uacpi_free(block, block->size);
+}
+
+static void packed_member_release(void *member)
+{
+    packed_block_unref(((struct packed_block**)member)[-1]);
+}
+
+static void free_object_memory(uacpi_object *obj)
+{
+    if (obj->packed) {
+        packed_member_release(obj);
+        return;
+    }
+
+    uacpi_free(obj, sizeof(*obj));
+}
+
 static void free_buffer(uacpi_handle handle)
 {
     uacpi_buffer *buf = handle;
 
-    if (buf->data != UACPI_NULL)
-        /*
-         * If buffer has a size of 0 but a valid data pointer it's probably an
-         * "empty" buffer allocated by the interpreter in make_null_buffer
-         * and its real size is actually 1.
-         */
-        uacpi_free(buf->data, UACPI_MAX(buf->size, 1));
+    if (buf->flags & UACPI_STORAGE_PACKED) {
+        packed_member_release(buf);
+        return;
+    }
 
+    uacpi_buffer_free_data(buf);
     uacpi_free(buf, sizeof(*buf));
 }
 
+static uacpi_object shared_constants[] = {
+    [UACPI_SHARED_CONSTANT_ZERO] = {
+        .shareable = UACPI_SHAREABLE_PERMANENT,
+        .type = UACPI_OBJECT_INTEGER,
+        .integer = 0,
+    },
+    [UACPI_SHARED_CONSTANT_ONE] = {
+        .shareable = UACPI_SHAREABLE_PERMANENT,
+        .type = UACPI_OBJECT_INTEGER,
+        .integer = 1,
+    },
+    [UACPI_SHARED_CONSTANT_ONES] = {
+        .shareable = UACPI_SHAREABLE_PERMANENT,
+        .type = UACPI_OBJECT_INTEGER,
+        .integer = 0xFFFFFFFFFFFFFFFF,
+    },
+};
+
+static uacpi_object shared_ones_32 = {
+    .shareable = UACPI_SHAREABLE_PERMANENT,
+    .type = UACPI_OBJECT_INTEGER,
+    .integer = 0xFFFFFFFF,
+};
+
+uacpi_object *uacpi_shared_constant(enum uacpi_shared_constant constant)
+{
+    if (constant == UACPI_SHARED_CONSTANT_ONES && g_uacpi_rt_ctx.is_rev1)
+        return &shared_ones_32;
+
+    return &shared_constants[constant];
+}
+
+static uacpi_char shared_empty_data[1];
+
+static uacpi_buffer shared_empty_string = {
+    .shareable = UACPI_SHAREABLE_PERMANENT,
+    .text = shared_empty_data,
+    .size = sizeof(uacpi_char),
+};
+
+static uacpi_buffer shared_empty_buffer = {
+    .shareable = UACPI_SHAREABLE_PERMANENT,
+    .data = shared_empty_data,
+    .size = 0,
+};
+
+void uacpi_object_share_empty_storage(uacpi_object *obj)
+{
+    uacpi_shareable_unref_and_delete_if_last(obj->buffer, free_buffer);
+
+    if (obj->type == UACPI_OBJECT_STRING)
+        obj->buffer = &shared_empty_string;
+    else
+        obj->buffer = &shared_empty_buffer;
+}
+
 DYNAMIC_ARRAY_WITH_INLINE_STORAGE(free_queue, uacpi_package*, 4)
 DYNAMIC_ARRAY_WITH_INLINE_STORAGE_IMPL(free_queue, uacpi_package*, static)
 
@@ -381,11 +629,8 @@ static void free_plain_no_recurse(uacpi_object *obj, struct free_queue *queue)
 {
     switch (obj->type) {
     case UACPI_OBJECT_PACKAGE:
-        if (uacpi_shareable_unref(obj->package) > 1)
-            break;
-
-        if (uacpi_unlikely(!free_queue_push(queue,
-                                            obj->package))) {
+        if (uacpi_shareable_unref(obj->package) <= 1 &&
+            uacpi_unlikely(!free_queue_push(queue, obj->package))) {
             uacpi_warn(
                 "unable to free nested package @%p: not enough memory\n",
                 obj->package
@@ -393,7 +638,7 @@ static void free_plain_no_recurse(uacpi_object *obj, struct free_queue *queue)
         }
 
         // Don't call free_object here as that will recurse
-        uacpi_free(obj, sizeof(*obj));
+        free_object_memory(obj);
         break;
     default:
         /*
@@ -458,6 +703,12 @@ static void free_package(uacpi_handle handle)
         pkg = *free_queue_last(&queue);
         free_queue_pop(&queue);
 
+        if (pkg->flags & UACPI_STORAGE_INTEGER_ARRAY) {
+            uacpi_free(pkg->integers, sizeof(*pkg->integers) * pkg->count);
+            uacpi_free(pkg, sizeof(*pkg));
+            continue;
+        }
+
         /*
          * 1. Unref/free every object in the package. Note that this might add
          *    even more packages into the free queue.
@@ -467,6 +718,12 @@ static void free_package(uacpi_handle handle)
             unref_object_no_recurse(obj, &queue);
         }
 
+        // The object array is part of the same packed member
+        if (pkg->flags & UACPI_STORAGE_PACKED) {
+            packed_member_release(pkg);
+            continue;
+        }
+
         // 2. Release the object array
         uacpi_free(pkg->objects, sizeof(*pkg->objects) * pkg->count);
 
@@ -481,7 +738,7 @@ static void free_mutex(uacpi_handle handle)
 {
     uacpi_mutex *mutex = handle;
 
-    uacpi_kernel_free_mutex(mutex->handle);
+    uacpi_free_native_mutex(mutex->handle);
     uacpi_free(mutex, sizeof(*mutex));
 }
 
@@ -568,6 +825,7 @@ static void free_device(uacpi_handle handle)
 {
     uacpi_device *device = handle;
     free_handlers(device);
+    uacpi_resource_cache_release(&device->resource_cache);
     uacpi_free(device, sizeof(*device));
 }
 
@@ -692,7 +950,7 @@ static void free_object_storage(uacpi_object *obj)
 static void free_object(uacpi_object *obj)
 {
     free_object_storage(obj);
-    uacpi_free(obj, sizeof(*obj));
+    free_object_memory(obj);
 }
 
 static void make_chain_bugged(uacpi_object *obj)
@@ -777,13 +1035,19 @@ static uacpi_status assign_buffer(uacpi_object *dst, uacpi_object *src,
                                   enum uacpi_assign_behavior behavior)
 {
     if (behavior == UACPI_ASSIGN_BEHAVIOR_SHALLOW_COPY) {
-        dst->buffer = src->buffer;
-        uacpi_shareable_ref(dst->buffer);
-        return UACPI_STATUS_OK;
+        uacpi_status ret;
+
+        ret = uacpi_object_unshare(src, UACPI_STORAGE_ACCESS_ALIAS);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    } else if (src->buffer->flags & UACPI_STORAGE_ALIASED) {
+        return buffer_alloc_and_store(dst, src->buffer->size,
+                                      src->buffer->data, src->buffer->size);
     }
 
-    return buffer_alloc_and_store(dst, src->buffer->size,
-                                  src->buffer->data, src->buffer->size);
+    dst->buffer = src->buffer;
+    uacpi_shareable_ref(dst->buffer);
+    return UACPI_STATUS_OK;
 }
 
 struct pkg_copy_req {
@@ -821,6 +1085,22 @@ static uacpi_status deep_copy_package_no_recurse(
     uacpi_size i;
     uacpi_package *dst_package;
 
+    if (src->flags & UACPI_STORAGE_INTEGER_ARRAY) {
+        if (uacpi_unlikely(!package_alloc(dst, 0, UACPI_PREALLOC_OBJECTS_NO)))
+            return UACPI_STATUS_OUT_OF_MEMORY;
+
+        dst->type = UACPI_OBJECT_PACKAGE;
+        dst_package = dst->package;
+
+        if (uacpi_unlikely(!uacpi_package_fill_integers(dst_package,
+                                                        src->count)))
+            return UACPI_STATUS_OUT_OF_MEMORY;
+
+        uacpi_memcpy(dst_package->integers, src->integers,
+                     src->count * sizeof(*src->integers));
+        return UACPI_STATUS_OK;
+    }
+
     if (uacpi_unlikely(!package_alloc(dst, src->count,
                                       UACPI_PREALLOC_OBJECTS_YES)))
         return UACPI_STATUS_OUT_OF_MEMORY;
@@ -838,7 +1118,12 @@ static uacpi_status deep_copy_package_no_recurse(
             src_obj->flags == UACPI_REFERENCE_KIND_PKG_INDEX)
             src_obj = src_obj->inner_object;
 
-        if (src_obj->type == UACPI_OBJECT_PACKAGE) {
+        /*
+         * Nested packages that can be shared are handled by the assign below,
+         * only the aliased ones have to be copied right away.
+         */
+        if (src_obj->type == UACPI_OBJECT_PACKAGE &&
+            (src_obj->package->flags & UACPI_STORAGE_ALIASED)) {
             uacpi_bool ret;
 
             ret = pkg_copy_reqs_push(reqs, dst_obj, src_obj->package);
@@ -917,12 +1202,396 @@ static uacpi_status assign_package(uacpi_object *dst, uacpi_object *src,
                                    enum uacpi_assign_behavior behavior)
 {
     if (behavior == UACPI_ASSIGN_BEHAVIOR_SHALLOW_COPY) {
-        dst->package = src->package;
-        uacpi_shareable_ref(dst->package);
-        return UACPI_STATUS_OK;
+        uacpi_status ret;
+
+        ret = uacpi_object_unshare(src, UACPI_STORAGE_ACCESS_ALIAS);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    } else if (src->package->flags & UACPI_STORAGE_ALIASED) {
+        return deep_copy_package(dst, src);
+    }
+
+    dst->package = src->package;
+    uacpi_shareable_ref(dst->package);
+    return UACPI_STATUS_OK;
+}
+
+static uacpi_status unshare_buffer(uacpi_object *obj)
+{
+    uacpi_status ret;
+    uacpi_buffer *buf = obj->buffer;
+
+    ret = buffer_alloc_and_store(obj, buf->size, buf->data, buf->size);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    uacpi_shareable_unref_and_delete_if_last(buf, free_buffer);
+    return ret;
+}
+
+static uacpi_status unshare_package(uacpi_object *obj)
+{
+    uacpi_status ret;
+    uacpi_object tmp_obj = {
+        .type = UACPI_OBJECT_PACKAGE,
+    };
+
+    ret = deep_copy_package(&tmp_obj, obj);
+    if (uacpi_unlikely_error(ret)) {
+        if (tmp_obj.package != UACPI_NULL) {
+            uacpi_shareable_unref_and_delete_if_last(
+                tmp_obj.package, free_package
+            );
+        }
+        return ret;
     }
 
-    return deep_copy_package(dst, src);
+    uacpi_shareable_unref_and_delete_if_last(obj->package, free_package);
+    obj->package = tmp_obj.package;
+    return ret;
+}
+
+/*
+ * Members may contain 64-bit integers, which some 32-bit ABIs (e.g. ARM EABI)
+ * require to be 8-byte aligned, so every member starts at a multiple of this
+ * from the beginning of the block. The back pointer to the header occupies
+ * the end of a prefix of the same size.
+ */
+#define PACKED_MEMBER_ALIGNMENT UACPI_MAX(sizeof(uacpi_u64), sizeof(void*))
+
+#define PACKED_HEADER_SIZE \
+    UACPI_ALIGN_UP(sizeof(struct packed_block), PACKED_MEMBER_ALIGNMENT, \
+                   uacpi_size)
+
+static uacpi_size packed_member_size(uacpi_size size)
+{
+    return PACKED_MEMBER_ALIGNMENT + UACPI_ALIGN_UP(
+        size, PACKED_MEMBER_ALIGNMENT, uacpi_size
+    );
+}
+
+static uacpi_size packed_payload_size(uacpi_buffer *buf)
+{
+    uacpi_size size;
+
+    if (buf->data == UACPI_NULL)
+        return 0;
+
+    // See uacpi_buffer_free_data for why this is at least 1
+    size = UACPI_MAX(buf->size, 1);
+
+    // Small payloads go into the inline storage of the packed buffer
+    if (buffer_data_fits_inline(size))
+        return 0;
+
+    return size;
+}
+
+static void *packed_member_carve(
+    struct packed_block *block, uacpi_u8 **cursor, uacpi_size size
+)
+{
+    uacpi_u8 *member;
+
+    member = *cursor + PACKED_MEMBER_ALIGNMENT;
+    ((struct packed_block**)member)[-1] = block;
+    *cursor += packed_member_size(size);
+
+    uacpi_shareable_ref(block);
+    return member;
+}
+
+static uacpi_bool packed_size_of(uacpi_package *pkg, uacpi_size *out_size)
+{
+    struct pkg_copy_reqs reqs = { 0 };
+    uacpi_bool ret = UACPI_FALSE;
+    uacpi_size i, size = PACKED_HEADER_SIZE;
+
+    if (uacpi_unlikely(!pkg_copy_reqs_push(&reqs, UACPI_NULL, pkg)))
+        goto out;
+
+    while (pkg_copy_reqs_size(&reqs) != 0) {
+        pkg = pkg_copy_reqs_last(&reqs)->src;
+        pkg_copy_reqs_pop(&reqs);
+
+        size += packed_member_size(
+            sizeof(*pkg) + pkg->count * sizeof(*pkg->objects)
+        );
+
+        // Integer arrays are expanded into separate objects in the block
+        if (pkg->flags & UACPI_STORAGE_INTEGER_ARRAY) {
+            size += pkg->count * packed_member_size(sizeof(uacpi_object));
+            continue;
+        }
+
+        for (i = 0; i < pkg->count; ++i) {
+            uacpi_object *obj = pkg->objects[i];
+
+            switch (obj->type) {
+            case UACPI_OBJECT_UNINITIALIZED:
+            case UACPI_OBJECT_INTEGER:
+                break;
+            case UACPI_OBJECT_STRING:
+            case UACPI_OBJECT_BUFFER:
+                if (obj->buffer->flags & UACPI_STORAGE_ALIASED)
+                    goto out;
+
+                size += packed_member_size(
+                    sizeof(*obj->buffer) + packed_payload_size(obj->buffer)
+                );
+                break;
+            case UACPI_OBJECT_PACKAGE:
+                if (obj->package->flags & UACPI_STORAGE_ALIASED)
+                    goto out;
+
+                if (uacpi_unlikely(!pkg_copy_reqs_push(
+                        &reqs, UACPI_NULL, obj->package)))
+                    goto out;
+                break;
+            default:
+                goto out;
+            }
+
+            size += packed_member_size(sizeof(*obj));
+        }
+    }
+
+    *out_size = size;
+    ret = UACPI_TRUE;
+
+out:
+    pkg_copy_reqs_clear(&reqs);
+    return ret;
+}
+
+static void packed_copy_buffer(
+    struct packed_block *block, uacpi_u8 **cursor,
+    uacpi_object *dst, uacpi_buffer *src
+)
+{
+    uacpi_buffer *buf;
+    uacpi_size payload_size;
+
+    payload_size = packed_payload_size(src);
+    buf = packed_member_carve(block, cursor, sizeof(*buf) + payload_size);
+
+    uacpi_shareable_init(buf);
+    buf->flags = UACPI_STORAGE_PACKED;
+    buf->size = src->size;
+    buf->data = UACPI_NULL;
+    buf->capacity = 0;
+
+    if (payload_size) {
+        buf->data = buf + 1;
+        uacpi_memcpy(buf->data, src->data, payload_size);
+    } else if (src->data != UACPI_NULL) {
+        uacpi_buffer_alloc_data(buf, UACPI_MAX(src->size, 1));
+        uacpi_memcpy(buf->data, src->data, UACPI_MAX(src->size, 1));
+    }
+
+    dst->buffer = buf;
+}
+
+void uacpi_object_try_pack(uacpi_object *obj)
+{
+    struct pkg_copy_reqs reqs = { 0 };
+    struct packed_block *block;
+    uacpi_package *src_pkg, *dst_pkg;
+    uacpi_object root = { 0 };
+    uacpi_u8 *cursor;
+    uacpi_size i, size;
+
+    if (obj->type != UACPI_OBJECT_PACKAGE)
+        return;
+
+    src_pkg = obj->package;
+    if (src_pkg->flags & (UACPI_STORAGE_ALIASED | UACPI_STORAGE_PACKED) ||
+        uacpi_shareable_refcount(src_pkg) != 1)
+        return;
+
+    if (!packed_size_of(src_pkg, &size))
+        return;
+
+    block = uacpi_kernel_alloc(size);
+    if (uacpi_unlikely(block == UACPI_NULL))
+        return;
+
+    // The extra reference is dropped once we're done populating the block
+    uacpi_shareable_init(block);
+    block->size = size;
+    cursor = (uacpi_u8*)block + PACKED_HEADER_SIZE;
+
+    if (uacpi_unlikely(!pkg_copy_reqs_push(&reqs, &root, src_pkg)))
+        goto out_failed;
+
+    while (pkg_copy_reqs_size(&reqs) != 0) {
+        struct pkg_copy_req req;
+
+        req = *pkg_copy_reqs_last(&reqs);
+        pkg_copy_reqs_pop(&reqs);
+        src_pkg = req.src;
+
+        dst_pkg = packed_member_carve(
+            block, &cursor,
+            sizeof(*dst_pkg) + src_pkg->count * sizeof(*dst_pkg->objects)
+        );
+        uacpi_shareable_init(dst_pkg);
+        dst_pkg->flags = UACPI_STORAGE_PACKED;
+        dst_pkg->count = src_pkg->count;
+        dst_pkg->objects = UACPI_NULL;
+        if (dst_pkg->count)
+            dst_pkg->objects = (uacpi_object**)(dst_pkg + 1);
+        req.dst->package = dst_pkg;
+
+        for (i = 0; i < src_pkg->count; ++i) {
+            uacpi_object *src_obj;
+            uacpi_object *dst_obj;
+
+            dst_obj = packed_member_carve(block, &cursor, sizeof(*dst_obj));
+            uacpi_memzero(dst_obj, sizeof(*dst_obj));
+            uacpi_shareable_init(dst_obj);
+            dst_obj->packed = UACPI_TRUE;
+            dst_pkg->objects[i] = dst_obj;
+
+            if (src_pkg->flags & UACPI_STORAGE_INTEGER_ARRAY) {
+                dst_obj->type = UACPI_OBJECT_INTEGER;
+                dst_obj->integer = src_pkg->integers[i];
+                continue;
+            }
+
+            src_obj = src_pkg->objects[i];
+            dst_obj->type = src_obj->type;
+            dst_obj->flags = src_obj->flags;
+
+            switch (src_obj->type) {
+            case UACPI_OBJECT_INTEGER:
+                dst_obj->integer = src_obj->integer;
+                break;
+            case UACPI_OBJECT_STRING:
+            case UACPI_OBJECT_BUFFER:
+                packed_copy_buffer(block, &cursor, dst_obj, src_obj->buffer);
+                break;
+            case UACPI_OBJECT_PACKAGE:
+                if (uacpi_unlikely(!pkg_copy_reqs_push(
+                        &reqs, dst_obj, src_obj->package)))
+                    goto out_failed;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    pkg_copy_reqs_clear(&reqs);
+
+    src_pkg = obj->package;
+    obj->package = root.package;
+    uacpi_shareable_unref_and_delete_if_last(src_pkg, free_package);
+    packed_block_unref(block);
+    return;
+
+out_failed:
+    // Nothing outside of the block references it yet
+    pkg_copy_reqs_clear(&reqs);
+    uacpi_free(block, size);
+}
+
+uacpi_status uacpi_object_unshare(uacpi_object *obj,
+                                  enum uacpi_storage_access access)
+{
+    uacpi_status ret = UACPI_STATUS_OK;
+    uacpi_u8 *flags;
+
+    switch (obj->type) {
+    case UACPI_OBJECT_STRING:
+    case UACPI_OBJECT_BUFFER:
+        if (!(obj->buffer->flags & UACPI_STORAGE_ALIASED) &&
+            uacpi_shareable_refcount(obj->buffer) > 1)
+            ret = unshare_buffer(obj);
+
+        flags = &obj->buffer->flags;
+        break;
+    case UACPI_OBJECT_PACKAGE:
+        if (!(obj->package->flags & UACPI_STORAGE_ALIASED) &&
+            uacpi_shareable_refcount(obj->package) > 1)
+            ret = unshare_package(obj);
+
+        flags = &obj->package->flags;
+        break;
+    default:
+        return ret;
+    }
+
+    if (uacpi_likely_success(ret) && access == UACPI_STORAGE_ACCESS_ALIAS)
+        *flags |= UACPI_STORAGE_ALIASED;
+
+    return ret;
+}
+
+static uacpi_bool buffer_is_exclusive(uacpi_buffer *buf)
+{
+    return !(buf->flags & UACPI_STORAGE_ALIASED) ||
+           uacpi_shareable_refcount(buf) == 1;
+}
+
+static uacpi_bool package_is_exclusive(uacpi_package *pkg)
+{
+    uacpi_size i;
+
+    if (uacpi_shareable_refcount(pkg) != 1)
+        return UACPI_FALSE;
+    if (pkg->flags & UACPI_STORAGE_INTEGER_ARRAY)
+        return UACPI_TRUE;
+
+    for (i = 0; i < pkg->count; ++i) {
+        uacpi_object *obj = pkg->objects[i];
+
+        if (uacpi_shareable_refcount(obj) != 1)
+            return UACPI_FALSE;
+
+        // Index objects hold a reference to the element itself
+        if (obj->type == UACPI_OBJECT_REFERENCE &&
+            obj->flags == UACPI_REFERENCE_KIND_PKG_INDEX) {
+            obj = obj->inner_object;
+
+            if (uacpi_shareable_refcount(obj) != 1)
+                return UACPI_FALSE;
+        }
+
+        switch (obj->type) {
+        case UACPI_OBJECT_STRING:
+        case UACPI_OBJECT_BUFFER:
+            if (!buffer_is_exclusive(obj->buffer))
+                return UACPI_FALSE;
+            break;
+        case UACPI_OBJECT_PACKAGE:
+            // Don't bother walking nested packages that have been aliased
+            if (obj->package->flags & UACPI_STORAGE_ALIASED)
+                return UACPI_FALSE;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return UACPI_TRUE;
+}
+
+void uacpi_object_reclaim_storage(uacpi_object *obj)
+{
+    switch (obj->type) {
+    case UACPI_OBJECT_STRING:
+    case UACPI_OBJECT_BUFFER:
+        if (uacpi_shareable_refcount(obj->buffer) == 1)
+            obj->buffer->flags &= ~UACPI_STORAGE_ALIASED;
+        break;
+    case UACPI_OBJECT_PACKAGE:
+        if (package_is_exclusive(obj->package))
+            obj->package->flags &= ~UACPI_STORAGE_ALIASED;
+        break;
+    default:
+        break;
+    }
 }
 
 void uacpi_object_attach_child(uacpi_object *parent, uacpi_object *child)
@@ -1020,8 +1689,15 @@ uacpi_status uacpi_object_do_get_string_or_buffer(
     uacpi_object *obj, uacpi_data_view *out, uacpi_u32 mask
 )
 {
+    uacpi_status ret;
+
     TYPE_CHECK_USER_OBJ(obj, mask);
 
+    // The returned view is writable, so the storage can no longer be shared
+    ret = uacpi_object_unshare(obj, UACPI_STORAGE_ACCESS_ALIAS);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
     out->bytes = obj->buffer->data;
     out->length = obj->buffer->size;
     return UACPI_STATUS_OK;
@@ -1098,7 +1774,7 @@ static uacpi_status uacpi_object_do_assign_buffer(
         return ret;
 
     ret = uacpi_object_assign(
-        obj, &tmp_obj, UACPI_ASSIGN_BEHAVIOR_SHALLOW_COPY
+        obj, &tmp_obj, UACPI_ASSIGN_BEHAVIOR_DEEP_COPY
     );
     uacpi_shareable_unref_and_delete_if_last(tmp_obj.buffer, free_buffer);
 
@@ -1208,8 +1884,22 @@ uacpi_status uacpi_object_get_package(
     uacpi_object *obj, uacpi_object_array *out
 )
 {
+    uacpi_status ret;
+
     TYPE_CHECK_USER_OBJ(obj, UACPI_OBJECT_PACKAGE_BIT);
 
+    /*
+     * The caller is free to modify the returned objects, which means the
+     * package must stop being shared with anyone else.
+     */
+    ret = uacpi_object_unshare(obj, UACPI_STORAGE_ACCESS_ALIAS);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    ret = uacpi_package_expand(obj->package);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
     out->objects = obj->package->objects;
     out->count = obj->package->count;
     return UACPI_STATUS_OK;
@@ -1313,6 +2003,10 @@ uacpi_status uacpi_object_assign_package(
         uacpi_object_ref(tmp_obj.package->objects[i]);
     }
 
+    /*
+     * The caller retains pointers to the objects stored inside, so use a
+     * shallow copy to mark the package as aliased and never share it.
+     */
     ret = uacpi_object_assign(obj, &tmp_obj, UACPI_ASSIGN_BEHAVIOR_SHALLOW_COPY);
     uacpi_shareable_unref_and_delete_if_last(tmp_obj.package, free_package);
 
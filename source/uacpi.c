@@ -12,27 +12,80 @@
 #include <uacpi/internal/registers.h>
 #include <uacpi/internal/event.h>
 #include <uacpi/internal/notify.h>
+#include <uacpi/internal/resources.h>
 #include <uacpi/internal/osi.h>
+#include <uacpi/internal/mutex.h>
+#include <uacpi/internal/timeline.h>
+#include <uacpi/internal/dynamic_array.h>
+#include <uacpi/platform/atomic.h>
 
 struct uacpi_runtime_context g_uacpi_rt_ctx = { 0 };
 
+/*
+ * State of the staged namespace initialization, see
+ * uacpi_namespace_initialize_async(). This is deliberately not a part of
+ * g_uacpi_rt_ctx, as a failed initialization step resets the runtime context
+ * and the waiters must still be woken up with the error afterwards.
+ */
+static struct {
+    uacpi_handle event;
+    uacpi_u32 stage;
+    uacpi_u32 num_waiters;
+    uacpi_u32 status;
+    uacpi_u32 running;
+} g_init_stage;
+
+static void init_stage_signal_waiters(void)
+{
+    uacpi_u32 waiters;
+
+    if (g_init_stage.event == UACPI_NULL)
+        return;
+
+    waiters = uacpi_atomic_load32(&g_init_stage.num_waiters);
+    while (waiters--)
+        uacpi_kernel_signal_event(g_init_stage.event);
+}
+
+static void init_stage_advance(uacpi_init_stage stage)
+{
+    uacpi_atomic_store32(&g_init_stage.stage, stage);
+    init_stage_signal_waiters();
+}
+
 void uacpi_state_reset(void)
 {
+    // Drops node references, so must be done before the namespace is gone
+    uacpi_deinitialize_timeline();
+
+    // Methods run during teardown must not connect any regions
+    g_uacpi_rt_ctx.lazy_reg_active = UACPI_FALSE;
     uacpi_deinitialize_namespace();
     uacpi_deinitialize_interfaces();
     uacpi_deinitialize_events();
     uacpi_deinitialize_notify();
+    uacpi_deinitialize_resources();
     uacpi_deinitialize_tables();
 
+    if (g_uacpi_rt_ctx.lazy_init_mutex)
+        uacpi_free_native_mutex(g_uacpi_rt_ctx.lazy_init_mutex);
+
 #ifndef UACPI_REDUCED_HARDWARE
     if (g_uacpi_rt_ctx.global_lock_event)
         uacpi_kernel_free_event(g_uacpi_rt_ctx.global_lock_event);
     if (g_uacpi_rt_ctx.global_lock_spinlock)
-        uacpi_kernel_free_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
+        uacpi_free_native_spinlock(g_uacpi_rt_ctx.global_lock_spinlock);
 #endif
 
     uacpi_memzero(&g_uacpi_rt_ctx, sizeof(g_uacpi_rt_ctx));
 
+    uacpi_atomic_store32(&g_init_stage.stage, UACPI_INIT_STAGE_NONE);
+    if (!uacpi_atomic_load32(&g_init_stage.running) &&
+        g_init_stage.event != UACPI_NULL) {
+        uacpi_kernel_free_event(g_init_stage.event);
+        g_init_stage.event = UACPI_NULL;
+    }
+
 #ifdef UACPI_KERNEL_INITIALIZATION
     uacpi_kernel_deinitialize();
 #endif
@@ -284,6 +337,10 @@ uacpi_status uacpi_initialize(uacpi_u64 flags)
     if (g_uacpi_rt_ctx.max_call_stack_depth == 0)
         uacpi_context_set_max_call_stack_depth(UACPI_DEFAULT_MAX_CALL_STACK_DEPTH);
 
+    ret = uacpi_initialize_timeline();
+    if (uacpi_unlikely_error(ret))
+        goto out_fatal_error;
+
     ret = uacpi_initialize_tables();
     if (uacpi_unlikely_error(ret))
         goto out_fatal_error;
@@ -300,6 +357,10 @@ uacpi_status uacpi_initialize(uacpi_u64 flags)
     if (uacpi_unlikely_error(ret))
         goto out_fatal_error;
 
+    ret = uacpi_initialize_resources();
+    if (uacpi_unlikely_error(ret))
+        goto out_fatal_error;
+
     uacpi_install_default_address_space_handlers();
 
     if (!uacpi_check_flag(UACPI_FLAG_NO_ACPI_MODE)) {
@@ -426,6 +487,7 @@ uacpi_status uacpi_namespace_load(void)
     }
 
     g_uacpi_rt_ctx.init_level = UACPI_INIT_LEVEL_NAMESPACE_LOADED;
+    init_stage_advance(UACPI_INIT_STAGE_TABLES_LOADED);
     return UACPI_STATUS_OK;
 
 out_fatal_error:
@@ -433,6 +495,8 @@ out_fatal_error:
     return ret;
 }
 
+struct ns_init_parallel;
+
 struct ns_init_context {
     uacpi_size ini_executed;
     uacpi_size ini_errors;
@@ -440,32 +504,76 @@ struct ns_init_context {
     uacpi_size sta_errors;
     uacpi_size devices;
     uacpi_size thermal_zones;
+
+    // Only set for the main walk, see UACPI_FLAG_PARALLEL_NAMESPACE_INIT
+    struct ns_init_parallel *parallel;
+
+    /*
+     * Remember the _STA/_INI outcome for every node so that lazy
+     * initialization never runs them twice, see
+     * UACPI_FLAG_LAZY_NAMESPACE_INIT.
+     */
+    uacpi_bool lazy;
+
+    /*
+     * Flag every subtree as initialized once it's done. Only needed if
+     * someone might observe the initialization while it's in progress, i.e.
+     * lazily or asynchronously, uacpi_is_subtree_initialized relies on the
+     * init stage otherwise.
+     */
+    uacpi_bool mark_initialized;
 };
 
 static void ini_eval(struct ns_init_context *ctx, uacpi_namespace_node *node)
 {
     uacpi_status ret;
+    uacpi_timeline_record rec;
+
+    uacpi_timeline_begin(&rec, UACPI_TIMELINE_EVENT_INI);
+    rec.node = node;
 
     ret = uacpi_eval(node, "_INI", UACPI_NULL, UACPI_NULL);
     if (ret == UACPI_STATUS_NOT_FOUND)
         return;
 
+    uacpi_timeline_end(&rec, ret);
     ctx->ini_executed++;
     if (uacpi_unlikely_error(ret))
         ctx->ini_errors++;
 }
 
+// Seeds the state that uacpi_rescan_devices diffs against
+static void cache_device_presence(uacpi_namespace_node *node, uacpi_u32 sta)
+{
+    uacpi_object *obj;
+
+    obj = uacpi_namespace_node_get_object_typed(node, UACPI_OBJECT_DEVICE_BIT);
+    if (obj == UACPI_NULL)
+        return;
+
+    obj->device->presence.sta = sta;
+    obj->device->presence.flags |= UACPI_DEVICE_PRESENCE_STA_VALID;
+}
+
 static uacpi_status sta_eval(
     struct ns_init_context *ctx, uacpi_namespace_node *node,
     uacpi_u32 *value
 )
 {
     uacpi_status ret;
+    uacpi_timeline_record rec;
+
+    uacpi_timeline_begin(&rec, UACPI_TIMELINE_EVENT_STA);
+    rec.node = node;
 
     ret = uacpi_eval_sta(node, value);
+    if (uacpi_likely_success(ret))
+        cache_device_presence(node, *value);
     if (*value == 0xFFFFFFFF)
         return ret;
 
+    rec.count = *value;
+    uacpi_timeline_end(&rec, ret);
     ctx->sta_executed++;
     if (uacpi_unlikely_error(ret))
         ctx->sta_errors++;
@@ -473,14 +581,67 @@ static uacpi_status sta_eval(
     return ret;
 }
 
+#ifndef UACPI_SINGLE_THREADED
+static uacpi_bool ns_init_try_dispatch(
+    struct ns_init_parallel *parallel, uacpi_namespace_node *node
+);
+static uacpi_bool ns_init_was_dispatched(
+    struct ns_init_parallel *parallel, uacpi_namespace_node *node
+);
+#endif
+
+static void node_set_flags(uacpi_namespace_node *node, uacpi_u32 flags)
+{
+    uacpi_status ret;
+
+    ret = uacpi_namespace_write_lock();
+    if (uacpi_unlikely_error(ret))
+        return;
+
+    node->flags |= flags;
+    uacpi_namespace_write_unlock();
+}
+
+static uacpi_iteration_decision sta_ini_eval(
+    struct ns_init_context *ctx, uacpi_namespace_node *node
+)
+{
+    uacpi_status ret;
+    uacpi_u32 sta_ret;
+
+    ret = sta_eval(ctx, node, &sta_ret);
+    if (uacpi_unlikely_error(ret))
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+    if (!(sta_ret & ACPI_STA_RESULT_DEVICE_PRESENT)) {
+        if (!(sta_ret & ACPI_STA_RESULT_DEVICE_FUNCTIONING))
+            return UACPI_ITERATION_DECISION_NEXT_PEER;
+
+        /*
+         * ACPI 6.5 specification:
+         * _STA may return bit 0 clear (not present) with bit [3] set (device
+         * is functional). This case is used to indicate a valid device for
+         * which no device driver should be loaded (for example, a bridge
+         * device.) Children of this device may be present and valid. OSPM
+         * should continue enumeration below a device whose _STA returns this
+         * bit combination.
+         */
+        return UACPI_ITERATION_DECISION_CONTINUE;
+    }
+
+    ini_eval(ctx, node);
+
+    return UACPI_ITERATION_DECISION_CONTINUE;
+}
+
 static uacpi_iteration_decision do_sta_ini(
     void *opaque, uacpi_namespace_node *node, uacpi_u32 depth
 )
 {
     struct ns_init_context *ctx = opaque;
-    uacpi_status ret;
     uacpi_object_type type = UACPI_OBJECT_UNINITIALIZED;
-    uacpi_u32 sta_ret;
+    uacpi_iteration_decision decision;
+    uacpi_u32 flags;
 
     UACPI_UNUSED(depth);
 
@@ -488,7 +649,15 @@ static uacpi_iteration_decision do_sta_ini(
     if (uacpi_namespace_node_is_alias(node))
         return UACPI_ITERATION_DECISION_NEXT_PEER;
 
-    ret = uacpi_namespace_node_type(node, &type);
+    uacpi_namespace_node_type(node, &type);
+
+#ifndef UACPI_SINGLE_THREADED
+    // The entire subtree is initialized by a worker instead
+    if (ctx->parallel != UACPI_NULL && type == UACPI_OBJECT_DEVICE &&
+        ns_init_try_dispatch(ctx->parallel, node))
+        return UACPI_ITERATION_DECISION_NEXT_PEER;
+#endif
+
     switch (type) {
     case UACPI_OBJECT_DEVICE:
     case UACPI_OBJECT_PROCESSOR:
@@ -502,35 +671,315 @@ static uacpi_iteration_decision do_sta_ini(
             return UACPI_ITERATION_DECISION_CONTINUE;
     }
 
-    ret = sta_eval(ctx, node, &sta_ret);
-    if (uacpi_unlikely_error(ret))
-        return UACPI_ITERATION_DECISION_CONTINUE;
+    if (!ctx->lazy)
+        return sta_ini_eval(ctx, node);
 
-    if (!(sta_ret & ACPI_STA_RESULT_DEVICE_PRESENT)) {
-        if (!(sta_ret & ACPI_STA_RESULT_DEVICE_FUNCTIONING))
+    flags = node->flags;
+    if (flags & UACPI_NAMESPACE_NODE_FLAG_STA_INI_DONE) {
+        if (flags & UACPI_NAMESPACE_NODE_FLAG_NOT_PRESENT)
             return UACPI_ITERATION_DECISION_NEXT_PEER;
 
-        /*
-         * ACPI 6.5 specification:
-         * _STA may return bit 0 clear (not present) with bit [3] set (device
-         * is functional). This case is used to indicate a valid device for
-         * which no device driver should be loaded (for example, a bridge
-         * device.) Children of this device may be present and valid. OSPM
-         * should continue enumeration below a device whose _STA returns this
-         * bit combination.
-         */
         return UACPI_ITERATION_DECISION_CONTINUE;
     }
 
-    ini_eval(ctx, node);
+    decision = sta_ini_eval(ctx, node);
+
+    flags = UACPI_NAMESPACE_NODE_FLAG_STA_INI_DONE;
+    if (decision == UACPI_ITERATION_DECISION_NEXT_PEER)
+        flags |= UACPI_NAMESPACE_NODE_FLAG_NOT_PRESENT;
+    node_set_flags(node, flags);
+
+    return decision;
+}
+
+static void mark_subtree_initialized(uacpi_namespace_node *node)
+{
+    node_set_flags(node, UACPI_NAMESPACE_NODE_FLAG_INITIALIZED);
+    init_stage_signal_waiters();
+}
+
+static uacpi_iteration_decision do_sta_ini_done(
+    void *opaque, uacpi_namespace_node *node, uacpi_u32 depth
+)
+{
+    struct ns_init_context *ctx = opaque;
+    uacpi_bool is_device = UACPI_FALSE;
+
+    UACPI_UNUSED(depth);
+
+    if (uacpi_namespace_node_is_alias(node))
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+#ifndef UACPI_SINGLE_THREADED
+    // Marked by the worker once the subtree is actually initialized
+    if (ctx->parallel != UACPI_NULL &&
+        ns_init_was_dispatched(ctx->parallel, node))
+        return UACPI_ITERATION_DECISION_CONTINUE;
+#else
+    UACPI_UNUSED(ctx);
+#endif
+
+    uacpi_namespace_node_is_one_of(
+        node, UACPI_OBJECT_DEVICE_BIT | UACPI_OBJECT_PROCESSOR_BIT |
+              UACPI_OBJECT_THERMAL_ZONE_BIT, &is_device
+    );
+    if (is_device)
+        mark_subtree_initialized(node);
 
     return UACPI_ITERATION_DECISION_CONTINUE;
 }
 
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE(ns_init_node_array, uacpi_namespace_node*, 4)
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE_IMPL(
+    ns_init_node_array, uacpi_namespace_node*, static
+)
+
+#ifndef UACPI_SINGLE_THREADED
+/*
+ * Parallel namespace initialization, see UACPI_FLAG_PARALLEL_NAMESPACE_INIT.
+ *
+ * Every device directly under \_SB is the root of a partition, the subtree of
+ * which is initialized by a single work item in the usual depth-first order,
+ * so parents are always initialized before their children. \_SB itself is
+ * initialized before any partition is dispatched, and a partition is never
+ * dispatched if \_SB turns out to be absent.
+ *
+ * AML only ever runs with the namespace write lock held, but the lock is
+ * dropped at Sleep(), while waiting for an event or mutex, and around every
+ * region handler call. Methods from different partitions may therefore
+ * interleave at any operation region access, regardless of which scope the
+ * region is declared in. To keep multi-access sequences like IndexField or
+ * BankField accesses intact, every field access is done with an init-wide
+ * region mutex held until all partitions are done, see
+ * 'parallel_init_region_mutex'.
+ */
+struct ns_init_work {
+    struct ns_init_work *next;
+    struct ns_init_parallel *parallel;
+    struct ns_init_node_array partitions;
+    struct ns_init_context ctx;
+    uacpi_u64 elapsed_ns;
+    uacpi_thread_id thread;
+};
+
+struct ns_init_parallel {
+    uacpi_namespace_node *sb;
+    uacpi_namespace_node *last_dispatched;
+    uacpi_thread_id thread;
+    struct ns_init_work *works;
+    uacpi_u32 num_partitions;
+    uacpi_bool mark_initialized;
+
+    /*
+     * Number of work items still running plus one, the extra reference is
+     * owned by the main walk. 'done_event' is signaled once this drops to 0.
+     * This is used instead of uacpi_kernel_wait_for_work_completion so that
+     * it's safe to do this from a work item, e.g. during asynchronous
+     * initialization.
+     */
+    uacpi_u32 pending;
+    uacpi_handle done_event;
+};
+
+static void ns_init_partition(
+    struct ns_init_context *ctx, uacpi_namespace_node *node
+)
+{
+    uacpi_iteration_decision decision;
+    uacpi_iteration_callback ascending_cb = UACPI_NULL;
+
+    if (ctx->mark_initialized)
+        ascending_cb = do_sta_ini_done;
+
+    decision = do_sta_ini(ctx, node, 1);
+    if (decision == UACPI_ITERATION_DECISION_CONTINUE) {
+        uacpi_namespace_for_each_child(
+            node, do_sta_ini, ascending_cb,
+            UACPI_OBJECT_ANY_BIT, UACPI_MAX_DEPTH_ANY, ctx
+        );
+    }
+
+    if (ctx->mark_initialized)
+        mark_subtree_initialized(node);
+}
+
+static void do_ns_init_work(uacpi_handle opaque)
+{
+    struct ns_init_work *work = opaque;
+    uacpi_u64 begin_ts;
+    uacpi_size i;
+
+    begin_ts = uacpi_kernel_get_nanoseconds_since_boot();
+    work->thread = uacpi_kernel_get_thread_id();
+
+    for (i = 0; i < ns_init_node_array_size(&work->partitions); ++i) {
+        ns_init_partition(
+            &work->ctx, *ns_init_node_array_at(&work->partitions, i)
+        );
+    }
+
+    work->elapsed_ns = uacpi_kernel_get_nanoseconds_since_boot() - begin_ts;
+
+    if (uacpi_atomic_dec32(&work->parallel->pending) == 0)
+        uacpi_kernel_signal_event(work->parallel->done_event);
+}
+
+static struct ns_init_work *ns_init_work_alloc(
+    struct ns_init_parallel *parallel
+)
+{
+    struct ns_init_work *work;
+
+    work = uacpi_kernel_calloc(1, sizeof(*work));
+    if (uacpi_unlikely(work == UACPI_NULL))
+        return UACPI_NULL;
+
+    work->next = parallel->works;
+    work->parallel = parallel;
+    work->ctx.mark_initialized = parallel->mark_initialized;
+    parallel->works = work;
+    return work;
+}
+
+static void ns_init_work_dispatch(struct ns_init_work *work)
+{
+    uacpi_status ret;
+
+    uacpi_atomic_inc32(&work->parallel->pending);
+
+    ret = uacpi_kernel_schedule_work(
+        UACPI_WORK_PARALLEL, do_ns_init_work, work
+    );
+    if (uacpi_unlikely_error(ret))
+        do_ns_init_work(work);
+}
+
+static uacpi_bool ns_init_try_dispatch(
+    struct ns_init_parallel *parallel, uacpi_namespace_node *node
+)
+{
+    struct ns_init_work *work;
+    uacpi_namespace_node **slot;
+
+    if (node->parent != parallel->sb)
+        return UACPI_FALSE;
+
+    work = ns_init_work_alloc(parallel);
+
+    // Initialize it as part of the main walk instead
+    if (uacpi_unlikely(work == UACPI_NULL))
+        return UACPI_FALSE;
+
+    slot = ns_init_node_array_alloc(&work->partitions);
+    if (uacpi_unlikely(slot == UACPI_NULL))
+        return UACPI_FALSE;
+    *slot = node;
+    parallel->num_partitions++;
+    parallel->last_dispatched = node;
+
+    ns_init_work_dispatch(work);
+    return UACPI_TRUE;
+}
+
+static uacpi_bool ns_init_was_dispatched(
+    struct ns_init_parallel *parallel, uacpi_namespace_node *node
+)
+{
+    /*
+     * The ascending callback for a node immediately follows the descending
+     * one if the latter returned NEXT_PEER, which is what dispatching does.
+     */
+    return node == parallel->last_dispatched;
+}
+
+static void ns_init_context_add(
+    struct ns_init_context *dst, const struct ns_init_context *src
+)
+{
+    dst->ini_executed += src->ini_executed;
+    dst->ini_errors += src->ini_errors;
+    dst->sta_executed += src->sta_executed;
+    dst->sta_errors += src->sta_errors;
+    dst->devices += src->devices;
+    dst->thermal_zones += src->thermal_zones;
+}
+
+static uacpi_bool ns_init_parallel_start(
+    struct ns_init_parallel *parallel, const struct ns_init_context *ctx
+)
+{
+    parallel->done_event = uacpi_kernel_create_event();
+    if (uacpi_unlikely(parallel->done_event == UACPI_NULL))
+        return UACPI_FALSE;
+
+    g_uacpi_rt_ctx.parallel_init_region_mutex = uacpi_create_mutex();
+    if (uacpi_unlikely(g_uacpi_rt_ctx.parallel_init_region_mutex ==
+                       UACPI_NULL)) {
+        uacpi_kernel_free_event(parallel->done_event);
+        return UACPI_FALSE;
+    }
+
+    parallel->sb = uacpi_namespace_get_predefined(
+        UACPI_PREDEFINED_NAMESPACE_SB
+    );
+    parallel->thread = uacpi_kernel_get_thread_id();
+    parallel->pending = 1;
+    parallel->mark_initialized = ctx->mark_initialized;
+    return UACPI_TRUE;
+}
+
+/*
+ * Wait for all partitions and merge their results into 'ctx'. Returns the
+ * total time spent initializing the namespace across all threads, from which
+ * the speedup over a serial initialization is derived.
+ */
+static uacpi_u64 ns_init_parallel_finish(
+    struct ns_init_parallel *parallel, struct ns_init_context *ctx,
+    uacpi_u64 begin_ts
+)
+{
+    struct ns_init_work *work, *next;
+    uacpi_u64 busy_ns;
+
+    busy_ns = uacpi_kernel_get_nanoseconds_since_boot() - begin_ts;
+
+    /*
+     * Wait for the signal rather than polling 'pending', as the last work item
+     * may still be signaling the event after the counter has dropped to 0.
+     */
+    if (uacpi_atomic_dec32(&parallel->pending) != 0)
+        uacpi_kernel_wait_for_event(parallel->done_event, 0xFFFF);
+    uacpi_kernel_free_event(parallel->done_event);
+
+    uacpi_mutex_unref(g_uacpi_rt_ctx.parallel_init_region_mutex);
+    g_uacpi_rt_ctx.parallel_init_region_mutex = UACPI_NULL;
+
+    for (work = parallel->works; work != UACPI_NULL; work = next) {
+        next = work->next;
+
+        ns_init_context_add(ctx, &work->ctx);
+
+        // Work done inline is already accounted for
+        if (work->thread != parallel->thread)
+            busy_ns += work->elapsed_ns;
+
+        ns_init_node_array_clear(&work->partitions);
+        uacpi_free(work, sizeof(*work));
+    }
+
+    return busy_ns;
+}
+#endif
+
 uacpi_status uacpi_namespace_initialize(void)
 {
     struct ns_init_context ctx = { 0 };
+#ifndef UACPI_SINGLE_THREADED
+    struct ns_init_parallel parallel = { 0 };
+    uacpi_u64 busy_ns = 0;
+#endif
     uacpi_namespace_node *root;
+    uacpi_iteration_callback ascending_cb = UACPI_NULL;
     uacpi_u64 begin_ts, end_ts;
     uacpi_address_space_handlers *handlers;
     uacpi_address_space_handler *handler;
@@ -561,29 +1010,93 @@ uacpi_status uacpi_namespace_initialize(void)
     ini_eval(
         &ctx, uacpi_namespace_get_predefined(UACPI_PREDEFINED_NAMESPACE_SB)
     );
+    init_stage_advance(UACPI_INIT_STAGE_ROOT_INI_DONE);
 
     /*
      * Step 3 - Run _REG methods for all globally installed
      *          address space handlers.
      */
     handlers = uacpi_node_get_address_space_handlers(root);
-    if (handlers) {
+    if (uacpi_check_flag(UACPI_FLAG_LAZY_REG)) {
+        // Deferred until first use, see uacpi_opregion_lazy_reg_scope
+        g_uacpi_rt_ctx.lazy_reg_active = UACPI_TRUE;
+    } else if (handlers) {
+        uacpi_timeline_record rec;
+        uacpi_status reg_ret;
+
         handler = handlers->head;
 
         while (handler) {
-            uacpi_reg_all_opregions(root, handler->space);
+            uacpi_timeline_begin(&rec, UACPI_TIMELINE_EVENT_REG);
+            rec.space = handler->space;
+
+            reg_ret = uacpi_reg_all_opregions(root, handler->space);
+            uacpi_timeline_end(&rec, reg_ret);
+
             handler = handler->next;
         }
     }
+    init_stage_advance(UACPI_INIT_STAGE_REG_DONE);
+
+    if (uacpi_check_flag(UACPI_FLAG_LAZY_NAMESPACE_INIT)) {
+        g_uacpi_rt_ctx.lazy_init_mutex = uacpi_create_native_mutex();
+
+        // Step 4 is deferred, see uacpi_namespace_initialize_subtree
+        if (uacpi_likely(g_uacpi_rt_ctx.lazy_init_mutex != UACPI_NULL)) {
+            end_ts = uacpi_kernel_get_nanoseconds_since_boot();
+
+            uacpi_info(
+                "namespace initialization done in %"UACPI_PRIu64"ms, "
+                "device initialization deferred until first use\n",
+                UACPI_FMT64(elapsed_ms(begin_ts, end_ts))
+            );
+            goto out_initialized;
+        }
+
+        uacpi_warn("unable to allocate a mutex, initializing eagerly\n");
+    }
+
+    // Progress can only be observed by waiters of asynchronous initialization
+    ctx.mark_initialized = uacpi_atomic_load32(&g_init_stage.running);
+    if (ctx.mark_initialized)
+        ascending_cb = do_sta_ini_done;
+
+#ifndef UACPI_SINGLE_THREADED
+    if (uacpi_check_flag(UACPI_FLAG_PARALLEL_NAMESPACE_INIT) &&
+        ns_init_parallel_start(&parallel, &ctx))
+        ctx.parallel = &parallel;
+#endif
 
     // Step 4 - Run all other _STA and _INI methods
     uacpi_namespace_for_each_child(
-        root, do_sta_ini, UACPI_NULL,
+        root, do_sta_ini, ascending_cb,
         UACPI_OBJECT_ANY_BIT, UACPI_MAX_DEPTH_ANY, &ctx
     );
 
+#ifndef UACPI_SINGLE_THREADED
+    if (ctx.parallel != UACPI_NULL)
+        busy_ns = ns_init_parallel_finish(&parallel, &ctx, begin_ts);
+#endif
+
     end_ts = uacpi_kernel_get_nanoseconds_since_boot();
 
+#ifndef UACPI_SINGLE_THREADED
+    if (ctx.parallel != UACPI_NULL) {
+        uacpi_u64 speedup = busy_ns * 100;
+
+        if (uacpi_likely(end_ts > begin_ts))
+            speedup /= end_ts - begin_ts;
+
+        uacpi_info(
+            "namespace initialization done in %"UACPI_PRIu64"ms "
+            "(%u partitions, %"UACPI_PRIu64".%02"UACPI_PRIu64"x speedup): "
+            "%zu devices, %zu thermal zones\n",
+            UACPI_FMT64(elapsed_ms(begin_ts, end_ts)), parallel.num_partitions,
+            UACPI_FMT64(speedup / 100), UACPI_FMT64(speedup % 100),
+            ctx.devices, ctx.thermal_zones
+        );
+    } else
+#endif
     uacpi_info(
         "namespace initialization done in %"UACPI_PRIu64"ms: "
         "%zu devices, %zu thermal zones\n",
@@ -597,16 +1110,347 @@ uacpi_status uacpi_namespace_initialize(void)
         ctx.ini_errors
     );
 
+out_initialized:
     g_uacpi_rt_ctx.init_level = UACPI_INIT_LEVEL_NAMESPACE_INITIALIZED;
+    g_uacpi_rt_ctx.lazy_init_active =
+        g_uacpi_rt_ctx.lazy_init_mutex != UACPI_NULL;
 #ifdef UACPI_KERNEL_INITIALIZATION
     ret = uacpi_kernel_initialize(UACPI_INIT_LEVEL_NAMESPACE_INITIALIZED);
 out:
     if (uacpi_unlikely_error(ret))
         uacpi_state_reset();
 #endif
+    if (uacpi_likely_success(ret))
+        init_stage_advance(UACPI_INIT_STAGE_DEVICES_INITIALIZED);
+    return ret;
+}
+
+static void do_namespace_initialize_async(uacpi_handle opaque)
+{
+    uacpi_status ret = UACPI_STATUS_OK;
+
+    UACPI_UNUSED(opaque);
+
+    if (g_uacpi_rt_ctx.init_level == UACPI_INIT_LEVEL_SUBSYSTEM_INITIALIZED)
+        ret = uacpi_namespace_load();
+    if (uacpi_likely_success(ret))
+        ret = uacpi_namespace_initialize();
+
+    uacpi_atomic_store32(&g_init_stage.status, ret);
+    uacpi_atomic_store32(&g_init_stage.running, UACPI_FALSE);
+    init_stage_signal_waiters();
+}
+
+uacpi_status uacpi_namespace_initialize_async(void)
+{
+    uacpi_status ret;
+
+    UACPI_ENSURE_INIT_LEVEL_AT_LEAST(UACPI_INIT_LEVEL_SUBSYSTEM_INITIALIZED);
+
+    if (uacpi_unlikely(g_uacpi_rt_ctx.init_level ==
+                       UACPI_INIT_LEVEL_NAMESPACE_INITIALIZED))
+        return UACPI_STATUS_INIT_LEVEL_MISMATCH;
+
+    if (uacpi_unlikely(uacpi_atomic_load32(&g_init_stage.running)))
+        return UACPI_STATUS_ALREADY_EXISTS;
+
+    if (g_init_stage.event == UACPI_NULL) {
+        g_init_stage.event = uacpi_kernel_create_event();
+        if (uacpi_unlikely(g_init_stage.event == UACPI_NULL))
+            return UACPI_STATUS_OUT_OF_MEMORY;
+    }
+
+    uacpi_atomic_store32(&g_init_stage.status, UACPI_STATUS_OK);
+    uacpi_atomic_store32(&g_init_stage.running, UACPI_TRUE);
+
+    ret = uacpi_kernel_schedule_work(
+        UACPI_WORK_NAMESPACE_INITIALIZATION, do_namespace_initialize_async,
+        UACPI_NULL
+    );
+    if (uacpi_unlikely_error(ret))
+        uacpi_atomic_store32(&g_init_stage.running, UACPI_FALSE);
+
+    return ret;
+}
+
+uacpi_init_stage uacpi_get_current_init_stage(void)
+{
+    return uacpi_atomic_load32(&g_init_stage.stage);
+}
+
+uacpi_bool uacpi_is_subtree_initialized(uacpi_namespace_node *node)
+{
+    uacpi_bool ret;
+
+    if (!g_uacpi_rt_ctx.lazy_init_active &&
+        uacpi_get_current_init_stage() >= UACPI_INIT_STAGE_DEVICES_INITIALIZED)
+        return UACPI_TRUE;
+    if (uacpi_unlikely(node == UACPI_NULL))
+        return UACPI_FALSE;
+
+    if (uacpi_unlikely_error(uacpi_namespace_read_lock()))
+        return UACPI_FALSE;
+
+    ret = (node->flags & UACPI_NAMESPACE_NODE_FLAG_INITIALIZED) != 0;
+    uacpi_namespace_read_unlock();
+
+    return ret;
+}
+
+typedef uacpi_bool (*init_stage_predicate)(void *ctx);
+
+static uacpi_bool init_stage_reached(void *ctx)
+{
+    uacpi_init_stage *stage = ctx;
+
+    return uacpi_get_current_init_stage() >= *stage;
+}
+
+static uacpi_bool subtree_initialized(void *ctx)
+{
+    return uacpi_is_subtree_initialized(ctx);
+}
+
+static uacpi_status wait_for_init_stage(
+    init_stage_predicate pred, void *ctx, uacpi_u16 timeout
+)
+{
+    uacpi_status ret;
+    uacpi_u64 now, deadline = 0;
+    uacpi_u16 wait_ms = timeout;
+
+    if (timeout != 0xFFFF) {
+        deadline = uacpi_kernel_get_nanoseconds_since_boot();
+        deadline += timeout * (1000ull * 1000ull);
+    }
+
+    for (;;) {
+        if (pred(ctx))
+            return UACPI_STATUS_OK;
+
+        ret = uacpi_atomic_load32(&g_init_stage.status);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+
+        // Nothing is going to advance the initialization anymore
+        if (!uacpi_atomic_load32(&g_init_stage.running))
+            return pred(ctx) ? UACPI_STATUS_OK :
+                               UACPI_STATUS_INIT_LEVEL_MISMATCH;
+
+        if (timeout != 0xFFFF) {
+            now = uacpi_kernel_get_nanoseconds_since_boot();
+            if (now >= deadline)
+                return UACPI_STATUS_TIMEOUT;
+
+            wait_ms = UACPI_MIN(
+                (deadline - now + (1000ull * 1000ull) - 1) / (1000ull * 1000ull),
+                0xFFFE
+            );
+        }
+
+        /*
+         * Re-check after registering as a waiter, the stage might have been
+         * advanced after the check above but before the signaling side saw
+         * this waiter.
+         */
+        uacpi_atomic_inc32(&g_init_stage.num_waiters);
+        if (!pred(ctx) && uacpi_atomic_load32(&g_init_stage.running))
+            uacpi_kernel_wait_for_event(g_init_stage.event, wait_ms);
+        uacpi_atomic_dec32(&g_init_stage.num_waiters);
+    }
+}
+
+uacpi_status uacpi_wait_for_init_stage(
+    uacpi_init_stage stage, uacpi_u16 timeout
+)
+{
+    return wait_for_init_stage(init_stage_reached, &stage, timeout);
+}
+
+uacpi_status uacpi_wait_for_subtree_initialization(
+    uacpi_namespace_node *node, uacpi_u16 timeout
+)
+{
+    if (uacpi_unlikely(node == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    return wait_for_init_stage(subtree_initialized, node, timeout);
+}
+
+uacpi_status uacpi_namespace_initialize_subtree(uacpi_namespace_node *node)
+{
+    struct ns_init_context ctx = { 0 };
+    struct ns_init_node_array parents = { 0 };
+    uacpi_namespace_node *parent, **slot;
+    uacpi_thread_id this_id;
+    uacpi_size i;
+    uacpi_status ret;
+
+    UACPI_ENSURE_INIT_LEVEL_AT_LEAST(UACPI_INIT_LEVEL_NAMESPACE_INITIALIZED);
+
+    if (uacpi_unlikely(node == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    // Everything has already been initialized eagerly
+    if (!g_uacpi_rt_ctx.lazy_init_active)
+        return UACPI_STATUS_OK;
+
+    if (uacpi_is_subtree_initialized(node))
+        return UACPI_STATUS_OK;
+
+    /*
+     * Evaluating _STA/_INI ends up calling back into here via uacpi_eval,
+     * the initialization is already in progress in that case.
+     */
+    this_id = uacpi_current_thread_id();
+    if (UACPI_ATOMIC_LOAD_THREAD_ID(&g_uacpi_rt_ctx.lazy_init_owner) == this_id)
+        return UACPI_STATUS_OK;
+
+    ret = uacpi_acquire_native_mutex(g_uacpi_rt_ctx.lazy_init_mutex);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+    UACPI_ATOMIC_STORE_THREAD_ID(&g_uacpi_rt_ctx.lazy_init_owner, this_id);
+
+    // Might have been done by someone else while we were waiting
+    if (uacpi_is_subtree_initialized(node))
+        goto out;
+
+    ctx.lazy = UACPI_TRUE;
+    ctx.mark_initialized = UACPI_TRUE;
+
+    // The root itself is covered by step 1 & 2 of uacpi_namespace_initialize
+    for (parent = node->parent; parent != UACPI_NULL &&
+                                parent->parent != UACPI_NULL;
+         parent = parent->parent) {
+        slot = ns_init_node_array_alloc(&parents);
+        if (uacpi_unlikely(slot == UACPI_NULL)) {
+            ret = UACPI_STATUS_OUT_OF_MEMORY;
+            goto out;
+        }
+        *slot = parent;
+    }
+
+    // Parents must be initialized first, starting from the topmost one
+    for (i = ns_init_node_array_size(&parents); i-- > 0;) {
+        parent = *ns_init_node_array_at(&parents, i);
+
+        // Not present, so nothing below it may be initialized either
+        if (do_sta_ini(&ctx, parent, 0) == UACPI_ITERATION_DECISION_NEXT_PEER)
+            goto out_initialized;
+    }
+
+    if (node->parent == UACPI_NULL ||
+        do_sta_ini(&ctx, node, 0) == UACPI_ITERATION_DECISION_CONTINUE) {
+        uacpi_namespace_for_each_child(
+            node, do_sta_ini, do_sta_ini_done,
+            UACPI_OBJECT_ANY_BIT, UACPI_MAX_DEPTH_ANY, &ctx
+        );
+    }
+
+    uacpi_trace(
+        "initialized subtree %.4s: _STA calls: %zu (%zu errors), "
+        "_INI calls: %zu (%zu errors)\n", node->name.text,
+        ctx.sta_executed, ctx.sta_errors, ctx.ini_executed, ctx.ini_errors
+    );
+
+out_initialized:
+    mark_subtree_initialized(node);
+out:
+    UACPI_ATOMIC_STORE_THREAD_ID(
+        &g_uacpi_rt_ctx.lazy_init_owner, UACPI_THREAD_ID_NONE
+    );
+    uacpi_release_native_mutex(g_uacpi_rt_ctx.lazy_init_mutex);
+    ns_init_node_array_clear(&parents);
     return ret;
 }
 
+/*
+ * Returns the closest device at or above 'node' that hasn't been lazily
+ * initialized yet, if any. Must be called with the namespace lock held.
+ */
+static uacpi_namespace_node *lazy_init_target(uacpi_namespace_node *node)
+{
+    uacpi_object *obj;
+
+    for (; node != UACPI_NULL && node->parent != UACPI_NULL;
+         node = node->parent) {
+        obj = uacpi_namespace_node_get_object(node);
+        if (obj == UACPI_NULL)
+            continue;
+
+        switch (obj->type) {
+        case UACPI_OBJECT_DEVICE:
+        case UACPI_OBJECT_PROCESSOR:
+        case UACPI_OBJECT_THERMAL_ZONE:
+            if (node->flags & UACPI_NAMESPACE_NODE_FLAG_INITIALIZED)
+                return UACPI_NULL;
+            return node;
+        default:
+            break;
+        }
+    }
+
+    return UACPI_NULL;
+}
+
+/*
+ * Initialize the device containing 'node' before evaluating anything inside
+ * of it. Called & returns with the namespace read lock held.
+ */
+static uacpi_status lazy_init_before_eval(uacpi_namespace_node *node)
+{
+    uacpi_namespace_node *target;
+    uacpi_bool dangling;
+    uacpi_status ret;
+
+    target = lazy_init_target(node);
+    if (target == UACPI_NULL)
+        return UACPI_STATUS_OK;
+
+    uacpi_shareable_ref(node);
+    uacpi_shareable_ref(target);
+    uacpi_namespace_read_unlock();
+
+    uacpi_namespace_initialize_subtree(target);
+
+    ret = uacpi_namespace_read_lock();
+    uacpi_namespace_node_unref(target);
+    if (uacpi_unlikely_error(ret)) {
+        uacpi_namespace_node_unref(node);
+        return ret;
+    }
+
+    dangling = uacpi_namespace_node_is_dangling(node);
+    uacpi_namespace_node_unref(node);
+
+    // Lost a race with an unload, 'node' is no longer valid
+    if (uacpi_unlikely(dangling))
+        return UACPI_STATUS_NAMESPACE_NODE_DANGLING;
+
+    return UACPI_STATUS_OK;
+}
+
+static uacpi_status copy_evaluated_object(
+    uacpi_object *obj, uacpi_object **out_obj
+)
+{
+    uacpi_status ret;
+    uacpi_object *new_obj;
+
+    new_obj = uacpi_create_object(UACPI_OBJECT_UNINITIALIZED);
+    if (uacpi_unlikely(new_obj == UACPI_NULL))
+        return UACPI_STATUS_OUT_OF_MEMORY;
+
+    ret = uacpi_object_assign(new_obj, obj, UACPI_ASSIGN_BEHAVIOR_DEEP_COPY);
+    if (uacpi_unlikely_error(ret)) {
+        uacpi_object_unref(new_obj);
+        return ret;
+    }
+
+    *out_obj = new_obj;
+    return UACPI_STATUS_OK;
+}
+
 uacpi_status uacpi_eval(
     uacpi_namespace_node *parent, const uacpi_char *path,
     const uacpi_object_array *args, uacpi_object **out_obj
@@ -636,6 +1480,16 @@ uacpi_status uacpi_eval(
         node = parent;
     }
 
+    if (uacpi_unlikely(g_uacpi_rt_ctx.lazy_init_active)) {
+        ret = lazy_init_before_eval(node);
+        if (uacpi_unlikely_error(ret)) {
+            // The read lock is only lost if re-acquiring it has failed
+            if (ret != UACPI_STATUS_NAMESPACE_NODE_DANGLING)
+                return ret;
+            goto out_read_unlock;
+        }
+    }
+
     obj = uacpi_namespace_node_get_object(node);
     if (uacpi_unlikely(obj == UACPI_NULL)) {
         ret = UACPI_STATUS_INVALID_ARGUMENT;
@@ -643,25 +1497,8 @@ uacpi_status uacpi_eval(
     }
 
     if (obj->type != UACPI_OBJECT_METHOD) {
-        uacpi_object *new_obj;
-
-        if (uacpi_unlikely(out_obj == UACPI_NULL))
-            goto out_read_unlock;
-
-        new_obj = uacpi_create_object(UACPI_OBJECT_UNINITIALIZED);
-        if (uacpi_unlikely(new_obj == UACPI_NULL)) {
-            ret = UACPI_STATUS_OUT_OF_MEMORY;
-            goto out_read_unlock;
-        }
-
-        ret = uacpi_object_assign(
-            new_obj, obj, UACPI_ASSIGN_BEHAVIOR_DEEP_COPY
-        );
-        if (uacpi_unlikely_error(ret)) {
-            uacpi_object_unref(new_obj);
-            goto out_read_unlock;
-        }
-        *out_obj = new_obj;
+        if (uacpi_likely(out_obj != UACPI_NULL))
+            ret = copy_evaluated_object(obj, out_obj);
 
     out_read_unlock:
         uacpi_namespace_read_unlock();
@@ -752,6 +1589,35 @@ static void trace_invalid_return_type(
         uacpi_free_dynamic_string(abs_path);
 }
 
+static uacpi_status check_typed_result(
+    uacpi_namespace_node *parent, const uacpi_char *path,
+    uacpi_object_type_bits ret_mask, uacpi_object *obj,
+    uacpi_object **out_obj
+)
+{
+    uacpi_object_type returned_type = UACPI_OBJECT_UNINITIALIZED;
+
+    if (obj != UACPI_NULL)
+        returned_type = obj->type;
+
+    if (ret_mask && (ret_mask & (1 << returned_type)) == 0) {
+        trace_invalid_return_type(parent, path, ret_mask, returned_type);
+        uacpi_object_unref(obj);
+        return UACPI_STATUS_TYPE_MISMATCH;
+    }
+
+    /*
+     * Packages built on the fly by a method consist of lots of tiny
+     * allocations, move them into a single block if the caller is explicitly
+     * asking for one, as it's probably going to be kept around for a while.
+     */
+    if (ret_mask == UACPI_OBJECT_PACKAGE_BIT)
+        uacpi_object_try_pack(obj);
+
+    *out_obj = obj;
+    return UACPI_STATUS_OK;
+}
+
 uacpi_status uacpi_eval_typed(
     uacpi_namespace_node *parent, const uacpi_char *path,
     const uacpi_object_array *args, uacpi_object_type_bits ret_mask,
@@ -760,7 +1626,6 @@ uacpi_status uacpi_eval_typed(
 {
     uacpi_status ret;
     uacpi_object *obj;
-    uacpi_object_type returned_type = UACPI_OBJECT_UNINITIALIZED;
 
     if (uacpi_unlikely(out_obj == UACPI_NULL))
         return UACPI_STATUS_INVALID_ARGUMENT;
@@ -769,17 +1634,47 @@ uacpi_status uacpi_eval_typed(
     if (uacpi_unlikely_error(ret))
         return ret;
 
-    if (obj != UACPI_NULL)
-        returned_type = obj->type;
+    return check_typed_result(parent, path, ret_mask, obj, out_obj);
+}
 
-    if (ret_mask && (ret_mask & (1 << returned_type)) == 0) {
-        trace_invalid_return_type(parent, path, ret_mask, returned_type);
-        uacpi_object_unref(obj);
-        return UACPI_STATUS_TYPE_MISMATCH;
+uacpi_status uacpi_eval_typed_locked(
+    uacpi_namespace_node *parent, const uacpi_char *path,
+    const uacpi_object_array *args, uacpi_object_type_bits ret_mask,
+    uacpi_object **out_obj
+)
+{
+    uacpi_status ret;
+    uacpi_namespace_node *node;
+    uacpi_control_method *method;
+    uacpi_object *obj;
+
+    if (uacpi_unlikely(out_obj == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    ret = uacpi_namespace_node_resolve(
+        parent, path, UACPI_SHOULD_LOCK_NO, UACPI_MAY_SEARCH_ABOVE_PARENT_NO,
+        UACPI_PERMANENT_ONLY_YES, &node
+    );
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    obj = uacpi_namespace_node_get_object(node);
+    if (uacpi_unlikely(obj == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    if (obj->type != UACPI_OBJECT_METHOD) {
+        ret = copy_evaluated_object(obj, &obj);
+    } else {
+        // The interpreter might drop the lock while the method is sleeping
+        method = obj->method;
+        uacpi_shareable_ref(method);
+        ret = uacpi_execute_control_method(node, method, args, &obj);
+        uacpi_method_unref(method);
     }
+    if (uacpi_unlikely_error(ret))
+        return ret;
 
-    *out_obj = obj;
-    return UACPI_STATUS_OK;
+    return check_typed_result(parent, path, ret_mask, obj, out_obj);
 }
 
 uacpi_status uacpi_eval_simple_typed(
@@ -6,6 +6,8 @@
 #include <uacpi/internal/utilities.h>
 #include <uacpi/internal/log.h>
 #include <uacpi/internal/namespace.h>
+#include <uacpi/internal/interpreter.h>
+#include <uacpi/internal/dynamic_array.h>
 
 void uacpi_eisa_id_to_string(uacpi_u32 id, uacpi_char *out_string)
 {
@@ -366,15 +368,53 @@ out:
 
 #define PNP_ID_LENGTH 8
 
-uacpi_status uacpi_eval_hid(uacpi_namespace_node *node, uacpi_id_string **out_id)
+/*
+ * All of the helpers below can either take the namespace lock themselves, or
+ * run with the write lock already held by the caller if 'locked' is set, which
+ * is what uacpi_get_device_info_snapshot does.
+ */
+static uacpi_status eval_typed(
+    uacpi_namespace_node *node, const uacpi_char *path, uacpi_bool locked,
+    uacpi_object_type_bits ret_mask, uacpi_object **out_obj
+)
+{
+    if (locked) {
+        return uacpi_eval_typed_locked(
+            node, path, UACPI_NULL, ret_mask, out_obj
+        );
+    }
+
+    return uacpi_eval_typed(node, path, UACPI_NULL, ret_mask, out_obj);
+}
+
+static uacpi_status eval_integer(
+    uacpi_namespace_node *node, const uacpi_char *path, uacpi_bool locked,
+    uacpi_u64 *out_value
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
+
+    ret = eval_typed(node, path, locked, UACPI_OBJECT_INTEGER_BIT, &obj);
+    if (ret != UACPI_STATUS_OK)
+        return ret;
+
+    *out_value = obj->integer;
+    uacpi_object_unref(obj);
+    return UACPI_STATUS_OK;
+}
+
+static uacpi_status eval_hid(
+    uacpi_namespace_node *node, uacpi_bool locked, uacpi_id_string **out_id
+)
 {
     uacpi_status ret;
     uacpi_object *hid_ret;
     uacpi_id_string *id = UACPI_NULL;
     uacpi_u32 size;
 
-    ret = uacpi_eval_typed(
-        node, "_HID", UACPI_NULL,
+    ret = eval_typed(
+        node, "_HID", locked,
         UACPI_OBJECT_INTEGER_BIT | UACPI_OBJECT_STRING_BIT,
         &hid_ret
     );
@@ -431,6 +471,11 @@ uacpi_status uacpi_eval_hid(uacpi_namespace_node *node, uacpi_id_string **out_id
     return ret;
 }
 
+uacpi_status uacpi_eval_hid(uacpi_namespace_node *node, uacpi_id_string **out_id)
+{
+    return eval_hid(node, UACPI_FALSE, out_id);
+}
+
 void uacpi_free_id_string(uacpi_id_string *id)
 {
     if (id == UACPI_NULL)
@@ -439,8 +484,9 @@ void uacpi_free_id_string(uacpi_id_string *id)
     uacpi_free(id, sizeof(uacpi_id_string) + id->size);
 }
 
-uacpi_status uacpi_eval_cid(
-    uacpi_namespace_node *node, uacpi_pnp_id_list **out_list
+static uacpi_status eval_cid(
+    uacpi_namespace_node *node, uacpi_bool locked,
+    uacpi_pnp_id_list **out_list
 )
 {
     uacpi_status ret;
@@ -452,8 +498,8 @@ uacpi_status uacpi_eval_cid(
     uacpi_char *id_buffer;
     uacpi_pnp_id_list *list;
 
-    ret = uacpi_eval_typed(
-        node, "_CID", UACPI_NULL,
+    ret = eval_typed(
+        node, "_CID", locked,
         UACPI_OBJECT_INTEGER_BIT | UACPI_OBJECT_STRING_BIT |
         UACPI_OBJECT_PACKAGE_BIT,
         &cid_ret
@@ -463,6 +509,12 @@ uacpi_status uacpi_eval_cid(
 
     switch (cid_ret->type) {
     case UACPI_OBJECT_PACKAGE:
+        ret = uacpi_object_expand_package(cid_ret);
+        if (uacpi_unlikely_error(ret)) {
+            uacpi_object_unref(cid_ret);
+            return ret;
+        }
+
         objects = cid_ret->package->objects;
         num_ids = cid_ret->package->count;
         break;
@@ -555,6 +607,13 @@ uacpi_status uacpi_eval_cid(
     return ret;
 }
 
+uacpi_status uacpi_eval_cid(
+    uacpi_namespace_node *node, uacpi_pnp_id_list **out_list
+)
+{
+    return eval_cid(node, UACPI_FALSE, out_list);
+}
+
 void uacpi_free_pnp_id_list(uacpi_pnp_id_list *list)
 {
     if (list == UACPI_NULL)
@@ -563,12 +622,14 @@ void uacpi_free_pnp_id_list(uacpi_pnp_id_list *list)
     uacpi_free(list, sizeof(uacpi_pnp_id_list) + list->size);
 }
 
-uacpi_status uacpi_eval_sta(uacpi_namespace_node *node, uacpi_u32 *flags)
+static uacpi_status eval_sta(
+    uacpi_namespace_node *node, uacpi_bool locked, uacpi_u32 *flags
+)
 {
     uacpi_status ret;
     uacpi_u64 value = 0;
 
-    ret = uacpi_eval_integer(node, "_STA", UACPI_NULL, &value);
+    ret = eval_integer(node, "_STA", locked, &value);
 
     /*
      * ACPI 6.5 specification:
@@ -586,9 +647,14 @@ uacpi_status uacpi_eval_sta(uacpi_namespace_node *node, uacpi_u32 *flags)
     return ret;
 }
 
+uacpi_status uacpi_eval_sta(uacpi_namespace_node *node, uacpi_u32 *flags)
+{
+    return eval_sta(node, UACPI_FALSE, flags);
+}
+
 uacpi_status uacpi_eval_adr(uacpi_namespace_node *node, uacpi_u64 *out)
 {
-    return uacpi_eval_integer(node, "_ADR", UACPI_NULL, out);
+    return eval_integer(node, "_ADR", UACPI_FALSE, out);
 }
 
 #define CLS_REPR_SIZE 7
@@ -600,6 +666,9 @@ static uacpi_u8 extract_package_byte_or_zero(uacpi_package *pkg, uacpi_size i)
     if (uacpi_unlikely(pkg->count <= i))
         return 0;
 
+    if (pkg->flags & UACPI_STORAGE_INTEGER_ARRAY)
+        return pkg->integers[i];
+
     obj = pkg->objects[i];
     if (uacpi_unlikely(obj->type != UACPI_OBJECT_INTEGER))
         return 0;
@@ -607,8 +676,8 @@ static uacpi_u8 extract_package_byte_or_zero(uacpi_package *pkg, uacpi_size i)
     return obj->integer;
 }
 
-uacpi_status uacpi_eval_cls(
-    uacpi_namespace_node *node, uacpi_id_string **out_id
+static uacpi_status eval_cls(
+    uacpi_namespace_node *node, uacpi_bool locked, uacpi_id_string **out_id
 )
 {
     uacpi_status ret;
@@ -617,9 +686,7 @@ uacpi_status uacpi_eval_cls(
     uacpi_u8 class_codes[3];
     uacpi_id_string *id_string;
 
-    ret = uacpi_eval_typed(
-        node, "_CLS", UACPI_NULL, UACPI_OBJECT_PACKAGE_BIT, &obj
-    );
+    ret = eval_typed(node, "_CLS", locked, UACPI_OBJECT_PACKAGE_BIT, &obj);
     if (ret != UACPI_STATUS_OK)
         return ret;
 
@@ -650,8 +717,15 @@ out:
     return ret;
 }
 
-uacpi_status uacpi_eval_uid(
-    uacpi_namespace_node *node, uacpi_id_string **out_uid
+uacpi_status uacpi_eval_cls(
+    uacpi_namespace_node *node, uacpi_id_string **out_id
+)
+{
+    return eval_cls(node, UACPI_FALSE, out_id);
+}
+
+static uacpi_status eval_uid(
+    uacpi_namespace_node *node, uacpi_bool locked, uacpi_id_string **out_uid
 )
 {
     uacpi_status ret;
@@ -659,8 +733,8 @@ uacpi_status uacpi_eval_uid(
     uacpi_id_string *id_string;
     uacpi_u32 size;
 
-    ret = uacpi_eval_typed(
-        node, "_UID", UACPI_NULL,
+    ret = eval_typed(
+        node, "_UID", locked,
         UACPI_OBJECT_INTEGER_BIT | UACPI_OBJECT_STRING_BIT,
         &obj
     );
@@ -710,6 +784,13 @@ out:
     return ret;
 }
 
+uacpi_status uacpi_eval_uid(
+    uacpi_namespace_node *node, uacpi_id_string **out_uid
+)
+{
+    return eval_uid(node, UACPI_FALSE, out_uid);
+}
+
 static uacpi_bool matches_any(
     uacpi_id_string *id, const uacpi_char *const *ids
 )
@@ -725,8 +806,8 @@ static uacpi_bool matches_any(
 }
 
 static uacpi_status uacpi_eval_dstate_method_template(
-    uacpi_namespace_node *parent, uacpi_char *template, uacpi_u8 num_methods,
-    uacpi_u8 *out_values
+    uacpi_namespace_node *parent, uacpi_bool locked, uacpi_char *template,
+    uacpi_u8 num_methods, uacpi_u8 *out_values
 )
 {
     uacpi_u8 i;
@@ -735,8 +816,8 @@ static uacpi_status uacpi_eval_dstate_method_template(
 
     // We expect either _SxD or _SxW, so increment template[2]
     for (i = 0; i < num_methods; ++i, template[2]++) {
-        eval_ret = uacpi_eval_typed(
-            parent, template, UACPI_NULL, UACPI_OBJECT_INTEGER_BIT, &obj
+        eval_ret = eval_typed(
+            parent, template, locked, UACPI_OBJECT_INTEGER_BIT, &obj
         );
         if (eval_ret == UACPI_STATUS_OK) {
             ret = UACPI_STATUS_OK;
@@ -761,90 +842,110 @@ static uacpi_status uacpi_eval_dstate_method_template(
     return ret;
 }
 
-#define NODE_INFO_EVAL_ADD_ID(name)                          \
-    if (uacpi_eval_##name(node, &name) == UACPI_STATUS_OK) { \
-        size += name->size;                                  \
-        if (uacpi_unlikely(size < name->size)) {             \
-            ret = UACPI_STATUS_AML_BAD_ENCODING;             \
-            goto out;                                        \
-        }                                                    \
-    }
+struct node_info_parts {
+    uacpi_u32 size;
+    uacpi_object_type type;
+    uacpi_u8 num_params;
+    uacpi_u8 flags;
+    uacpi_u8 sxd[4], sxw[5];
+    uacpi_u64 adr;
+    uacpi_id_string *hid, *uid, *cls;
+    uacpi_pnp_id_list *cid;
+};
 
-#define NODE_INFO_COPY_ID(name, flag)                  \
-    if (name != UACPI_NULL) {                          \
-        flags |= UACPI_NS_NODE_INFO_HAS_##flag;        \
-        info->name.value = cursor;                     \
-        info->name.size = name->size;                  \
-        uacpi_memcpy(cursor, name->value, name->size); \
-        cursor += name->size;                          \
-    } else {                                           \
-        uacpi_memzero(&info->name, sizeof(*name));     \
-    }                                                  \
+#define NODE_INFO_EVAL_ADD_ID(name)                                   \
+    if (eval_##name(node, locked, &parts->name) == UACPI_STATUS_OK) { \
+        parts->size += parts->name->size;                             \
+        if (uacpi_unlikely(parts->size < parts->name->size))          \
+            return UACPI_STATUS_AML_BAD_ENCODING;                     \
+    }
 
-uacpi_status uacpi_get_namespace_node_info(
-    uacpi_namespace_node *node, uacpi_namespace_node_info **out_info
+static uacpi_status gather_node_info(
+    uacpi_namespace_node *node, uacpi_object *obj, uacpi_bool locked,
+    struct node_info_parts *parts
 )
 {
-    uacpi_status ret = UACPI_STATUS_OK;
-    uacpi_u32 size = sizeof(uacpi_namespace_node_info);
-    uacpi_object *obj;
-    uacpi_namespace_node_info *info;
-    uacpi_id_string *hid = UACPI_NULL, *uid = UACPI_NULL, *cls = UACPI_NULL;
-    uacpi_pnp_id_list *cid = UACPI_NULL;
-    uacpi_char *cursor;
-    uacpi_u64 adr = 0;
-    uacpi_u8 flags = 0;
-    uacpi_u8 sxd[4], sxw[5];
+    char dstate_method_template[5] = { '_', 'S', '1', 'D', '\0' };
 
-    obj = uacpi_namespace_node_get_object(node);
-    if (uacpi_unlikely(obj == UACPI_NULL))
-        return UACPI_STATUS_INVALID_ARGUMENT;
+    uacpi_memzero(parts, sizeof(*parts));
+    parts->size = sizeof(uacpi_namespace_node_info);
+    parts->type = obj->type;
+    if (parts->type == UACPI_OBJECT_METHOD)
+        parts->num_params = obj->method->args;
 
-    if (obj->type == UACPI_OBJECT_DEVICE ||
-        obj->type == UACPI_OBJECT_PROCESSOR) {
-        char dstate_method_template[5] = { '_', 'S', '1', 'D', '\0' };
+    if (parts->type != UACPI_OBJECT_DEVICE &&
+        parts->type != UACPI_OBJECT_PROCESSOR)
+        return UACPI_STATUS_OK;
 
-        NODE_INFO_EVAL_ADD_ID(hid)
-        NODE_INFO_EVAL_ADD_ID(uid)
-        NODE_INFO_EVAL_ADD_ID(cls)
-        NODE_INFO_EVAL_ADD_ID(cid)
+    NODE_INFO_EVAL_ADD_ID(hid)
+    NODE_INFO_EVAL_ADD_ID(uid)
+    NODE_INFO_EVAL_ADD_ID(cls)
+    NODE_INFO_EVAL_ADD_ID(cid)
 
-        if (uacpi_eval_adr(node, &adr) == UACPI_STATUS_OK)
-            flags |= UACPI_NS_NODE_INFO_HAS_ADR;
+    if (eval_integer(node, "_ADR", locked, &parts->adr) == UACPI_STATUS_OK)
+        parts->flags |= UACPI_NS_NODE_INFO_HAS_ADR;
 
-        if (uacpi_eval_dstate_method_template(
-                node, dstate_method_template, sizeof(sxd), sxd
-            ) == UACPI_STATUS_OK)
-            flags |= UACPI_NS_NODE_INFO_HAS_SXD;
+    if (uacpi_eval_dstate_method_template(
+            node, locked, dstate_method_template, sizeof(parts->sxd),
+            parts->sxd
+        ) == UACPI_STATUS_OK)
+        parts->flags |= UACPI_NS_NODE_INFO_HAS_SXD;
 
-        dstate_method_template[2] = '0';
-        dstate_method_template[3] = 'W';
+    dstate_method_template[2] = '0';
+    dstate_method_template[3] = 'W';
 
-        if (uacpi_eval_dstate_method_template(
-                node, dstate_method_template, sizeof(sxw), sxw
-            ) == UACPI_STATUS_OK)
-            flags |= UACPI_NS_NODE_INFO_HAS_SXW;
-    }
+    if (uacpi_eval_dstate_method_template(
+            node, locked, dstate_method_template, sizeof(parts->sxw),
+            parts->sxw
+        ) == UACPI_STATUS_OK)
+        parts->flags |= UACPI_NS_NODE_INFO_HAS_SXW;
 
-    info = uacpi_kernel_alloc(size);
-    if (uacpi_unlikely(info == UACPI_NULL)) {
-        ret = UACPI_STATUS_OUT_OF_MEMORY;
-        goto out;
-    }
-    info->size = size;
+    return UACPI_STATUS_OK;
+}
+
+static void free_node_info_parts(struct node_info_parts *parts)
+{
+    uacpi_free_id_string(parts->hid);
+    uacpi_free_id_string(parts->uid);
+    uacpi_free_id_string(parts->cls);
+    uacpi_free_pnp_id_list(parts->cid);
+}
+
+#define NODE_INFO_COPY_ID(name, flag)                                \
+    if (parts->name != UACPI_NULL) {                                 \
+        flags |= UACPI_NS_NODE_INFO_HAS_##flag;                      \
+        info->name.value = cursor;                                   \
+        info->name.size = parts->name->size;                         \
+        uacpi_memcpy(cursor, parts->name->value, parts->name->size); \
+        cursor += parts->name->size;                                 \
+    } else {                                                         \
+        uacpi_memzero(&info->name, sizeof(info->name));              \
+    }                                                                \
+
+// 'info' must be at least parts->size bytes large
+static void fill_node_info(
+    uacpi_namespace_node *node, const struct node_info_parts *parts,
+    uacpi_namespace_node_info *info
+)
+{
+    uacpi_char *cursor;
+    uacpi_u8 flags = parts->flags;
+    uacpi_pnp_id_list *cid = parts->cid;
+
+    info->size = parts->size;
     cursor = UACPI_PTR_ADD(info, sizeof(uacpi_namespace_node_info));
     info->name = uacpi_namespace_node_name(node);
-    info->type = obj->type;
-    info->num_params = info->type == UACPI_OBJECT_METHOD ? obj->method->args : 0;
+    info->type = parts->type;
+    info->num_params = parts->num_params;
 
-    info->adr = adr;
+    info->adr = parts->adr;
     if (flags & UACPI_NS_NODE_INFO_HAS_SXD)
-        uacpi_memcpy(info->sxd, sxd, sizeof(sxd));
+        uacpi_memcpy(info->sxd, parts->sxd, sizeof(parts->sxd));
     else
         uacpi_memzero(info->sxd, sizeof(info->sxd));
 
     if (flags & UACPI_NS_NODE_INFO_HAS_SXW)
-        uacpi_memcpy(info->sxw, sxw, sizeof(sxw));
+        uacpi_memcpy(info->sxw, parts->sxw, sizeof(parts->sxw));
     else
         uacpi_memzero(info->sxw, sizeof(info->sxw));
 
@@ -868,16 +969,37 @@ uacpi_status uacpi_get_namespace_node_info(
     NODE_INFO_COPY_ID(uid, UID)
     NODE_INFO_COPY_ID(cls, CLS)
 
-out:
-    if (uacpi_likely_success(ret)) {
-        info->flags = flags;
-        *out_info = info;
+    info->flags = flags;
+}
+
+uacpi_status uacpi_get_namespace_node_info(
+    uacpi_namespace_node *node, uacpi_namespace_node_info **out_info
+)
+{
+    uacpi_status ret;
+    uacpi_object *obj;
+    uacpi_namespace_node_info *info;
+    struct node_info_parts parts;
+
+    obj = uacpi_namespace_node_get_object(node);
+    if (uacpi_unlikely(obj == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    ret = gather_node_info(node, obj, UACPI_FALSE, &parts);
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    info = uacpi_kernel_alloc(parts.size);
+    if (uacpi_unlikely(info == UACPI_NULL)) {
+        ret = UACPI_STATUS_OUT_OF_MEMORY;
+        goto out;
     }
 
-    uacpi_free_id_string(hid);
-    uacpi_free_id_string(uid);
-    uacpi_free_id_string(cls);
-    uacpi_free_pnp_id_list(cid);
+    fill_node_info(node, &parts, info);
+    *out_info = info;
+
+out:
+    free_node_info_parts(&parts);
     return ret;
 }
 
@@ -889,6 +1011,204 @@ void uacpi_free_namespace_node_info(uacpi_namespace_node_info *info)
     uacpi_free(info, info->size);
 }
 
+struct snapshot_item {
+    uacpi_namespace_node *node;
+    uacpi_u32 sta;
+    struct node_info_parts parts;
+};
+
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE(snapshot_item_array, struct snapshot_item, 16)
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE_IMPL(
+    snapshot_item_array, struct snapshot_item, static
+)
+
+struct snapshot_collect_ctx {
+    uacpi_u32 since_generation;
+    struct snapshot_item_array items;
+    uacpi_status st;
+};
+
+static uacpi_iteration_decision collect_snapshot_node(
+    void *opaque, uacpi_namespace_node *node, uacpi_u32 depth
+)
+{
+    struct snapshot_collect_ctx *ctx = opaque;
+    struct snapshot_item *item;
+    UACPI_UNUSED(depth);
+
+    if (node->generation <= ctx->since_generation)
+        return UACPI_ITERATION_DECISION_CONTINUE;
+
+    item = snapshot_item_array_alloc(&ctx->items);
+    if (uacpi_unlikely(item == UACPI_NULL)) {
+        ctx->st = UACPI_STATUS_OUT_OF_MEMORY;
+        return UACPI_ITERATION_DECISION_BREAK;
+    }
+
+    uacpi_memzero(item, sizeof(*item));
+    item->node = node;
+    uacpi_shareable_ref(node);
+    return UACPI_ITERATION_DECISION_CONTINUE;
+}
+
+/*
+ * Evaluate everything for the collected nodes with the write lock held by the
+ * caller. Nodes that got unloaded in the meantime are dropped from the array.
+ */
+static uacpi_status snapshot_evaluate_locked(
+    struct snapshot_item_array *items, uacpi_size *out_info_size
+)
+{
+    uacpi_status ret;
+    struct snapshot_item *item;
+    uacpi_object *obj;
+    uacpi_size i;
+
+    *out_info_size = 0;
+
+    for (i = 0; i < snapshot_item_array_size(items); ++i) {
+        item = snapshot_item_array_at(items, i);
+
+        obj = uacpi_namespace_node_get_object(item->node);
+        if (uacpi_unlikely(obj == UACPI_NULL)) {
+            uacpi_namespace_node_unref(item->node);
+            item->node = UACPI_NULL;
+            continue;
+        }
+
+        item->sta = 0xFFFFFFFF;
+        if (obj->type == UACPI_OBJECT_DEVICE ||
+            obj->type == UACPI_OBJECT_PROCESSOR) {
+            ret = eval_sta(item->node, UACPI_TRUE, &item->sta);
+            if (uacpi_unlikely_error(ret))
+                item->sta = 0;
+        }
+
+        ret = gather_node_info(item->node, obj, UACPI_TRUE, &item->parts);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+
+        *out_info_size += UACPI_ALIGN_UP(item->parts.size, 8, uacpi_size);
+    }
+
+    return UACPI_STATUS_OK;
+}
+
+uacpi_status uacpi_get_device_info_snapshot(
+    uacpi_namespace_node *parent, uacpi_object_type_bits type_mask,
+    uacpi_u32 since_generation, uacpi_device_info_snapshot **out_snapshot
+)
+{
+    uacpi_status ret;
+    struct snapshot_collect_ctx ctx = {
+        .since_generation = since_generation,
+    };
+    struct snapshot_item *item;
+    uacpi_device_info_snapshot *snapshot;
+    uacpi_device_info_snapshot_entry *entry;
+    uacpi_size i, count = 0, entries_size, info_size;
+    uacpi_u32 generation;
+    void *cursor;
+
+    UACPI_ENSURE_INIT_LEVEL_AT_LEAST(UACPI_INIT_LEVEL_NAMESPACE_LOADED);
+
+    if (uacpi_unlikely(out_snapshot == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    if (g_uacpi_rt_ctx.lazy_init_active) {
+        ret = uacpi_namespace_initialize_subtree(parent);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    }
+
+    /*
+     * Grab the generation before looking at any of the nodes, so that anything
+     * changing while we're collecting is picked up by the next snapshot.
+     */
+    generation = uacpi_namespace_generation();
+
+    ret = uacpi_namespace_for_each_child(
+        parent, collect_snapshot_node, UACPI_NULL, type_mask,
+        UACPI_MAX_DEPTH_ANY, &ctx
+    );
+    if (ret == UACPI_STATUS_OK)
+        ret = ctx.st;
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    ret = uacpi_namespace_write_lock();
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    ret = snapshot_evaluate_locked(&ctx.items, &info_size);
+    uacpi_namespace_write_unlock();
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    for (i = 0; i < snapshot_item_array_size(&ctx.items); ++i)
+        count += snapshot_item_array_at(&ctx.items, i)->node != UACPI_NULL;
+
+    entries_size = UACPI_ALIGN_UP(
+        sizeof(*snapshot) + count * sizeof(*entry), 8, uacpi_size
+    );
+
+    snapshot = uacpi_kernel_alloc(entries_size + info_size);
+    if (uacpi_unlikely(snapshot == UACPI_NULL)) {
+        ret = UACPI_STATUS_OUT_OF_MEMORY;
+        goto out;
+    }
+
+    snapshot->generation = generation;
+    snapshot->count = count;
+    snapshot->entries = UACPI_PTR_ADD(snapshot, sizeof(*snapshot));
+    snapshot->size = entries_size + info_size;
+    cursor = UACPI_PTR_ADD(snapshot, entries_size);
+
+    entry = snapshot->entries;
+    for (i = 0; i < snapshot_item_array_size(&ctx.items); ++i) {
+        item = snapshot_item_array_at(&ctx.items, i);
+        if (item->node == UACPI_NULL)
+            continue;
+
+        entry->node = item->node;
+        uacpi_shareable_ref(entry->node);
+        entry->sta = item->sta;
+        entry->info = cursor;
+        fill_node_info(item->node, &item->parts, entry->info);
+
+        cursor = UACPI_PTR_ADD(
+            cursor, UACPI_ALIGN_UP(item->parts.size, 8, uacpi_size)
+        );
+        entry++;
+    }
+
+    *out_snapshot = snapshot;
+
+out:
+    for (i = 0; i < snapshot_item_array_size(&ctx.items); ++i) {
+        item = snapshot_item_array_at(&ctx.items, i);
+
+        if (item->node != UACPI_NULL)
+            uacpi_namespace_node_unref(item->node);
+        free_node_info_parts(&item->parts);
+    }
+    snapshot_item_array_clear(&ctx.items);
+    return ret;
+}
+
+void uacpi_free_device_info_snapshot(uacpi_device_info_snapshot *snapshot)
+{
+    uacpi_size i;
+
+    if (snapshot == UACPI_NULL)
+        return;
+
+    for (i = 0; i < snapshot->count; ++i)
+        uacpi_namespace_node_unref(snapshot->entries[i].node);
+
+    uacpi_free(snapshot, snapshot->size);
+}
+
 uacpi_bool uacpi_device_matches_pnp_id(
     uacpi_namespace_node *node, const uacpi_char *const *ids
 )
@@ -964,6 +1284,14 @@ uacpi_status uacpi_find_devices_at(
         .cb = cb,
     };
 
+    if (g_uacpi_rt_ctx.lazy_init_active) {
+        uacpi_status ret;
+
+        ret = uacpi_namespace_initialize_subtree(parent);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    }
+
     return uacpi_namespace_for_each_child(
         parent, find_one_device, UACPI_NULL, UACPI_OBJECT_DEVICE_BIT,
         UACPI_MAX_DEPTH_ANY, &ctx
@@ -1011,7 +1339,7 @@ uacpi_status uacpi_get_pci_routing_table(
 )
 {
     uacpi_status ret;
-    uacpi_object *obj, *entry_obj, *elem_obj;
+    uacpi_object *obj, *entry_obj, *elem_obj, scratch;
     uacpi_package *table_pkg, *entry_pkg;
     uacpi_pci_routing_table_entry *entry;
     uacpi_pci_routing_table *table;
@@ -1029,6 +1357,11 @@ uacpi_status uacpi_get_pci_routing_table(
     if (uacpi_unlikely_error(ret))
         return ret;
 
+    /*
+     * The returned package might share its storage with a named _PRT, the
+     * entries of which are owned by the namespace and may be accessed by AML
+     * at any time. Read them in place instead of expanding them.
+     */
     table_pkg = obj->package;
     if (uacpi_unlikely(table_pkg->count == 0 || table_pkg->count > 1024)) {
         uacpi_error("invalid number of _PRT entries: %zu\n", table_pkg->count);
@@ -1045,7 +1378,7 @@ uacpi_status uacpi_get_pci_routing_table(
     table->num_entries = table_pkg->count;
 
     for (i = 0; i < table_pkg->count; ++i) {
-        entry_obj = table_pkg->objects[i];
+        entry_obj = uacpi_package_element(table_pkg, i, &scratch);
 
         if (uacpi_unlikely(entry_obj->type != UACPI_OBJECT_PACKAGE)) {
             uacpi_error("_PRT sub-object %zu is not a package: %s\n",
@@ -1062,7 +1395,7 @@ uacpi_status uacpi_get_pci_routing_table(
 
         entry = &table->entries[i];
 
-        elem_obj = entry_pkg->objects[0];
+        elem_obj = uacpi_package_element(entry_pkg, 0, &scratch);
         if (uacpi_unlikely(elem_obj->type != UACPI_OBJECT_INTEGER)) {
             uacpi_error("invalid _PRT sub-package %zu address type: %s\n",
                         i, uacpi_object_type_to_string(elem_obj->type));
@@ -1070,7 +1403,7 @@ uacpi_status uacpi_get_pci_routing_table(
         }
         entry->address = elem_obj->integer;
 
-        elem_obj = entry_pkg->objects[1];
+        elem_obj = uacpi_package_element(entry_pkg, 1, &scratch);
         if (uacpi_unlikely(elem_obj->type != UACPI_OBJECT_INTEGER)) {
             uacpi_error("invalid _PRT sub-package %zu pin type: %s\n",
                         i, uacpi_object_type_to_string(elem_obj->type));
@@ -1078,7 +1411,7 @@ uacpi_status uacpi_get_pci_routing_table(
         }
         entry->pin = elem_obj->integer;
 
-        elem_obj = entry_pkg->objects[2];
+        elem_obj = uacpi_package_element(entry_pkg, 2, &scratch);
         switch (elem_obj->type) {
         case UACPI_OBJECT_STRING:
             ret = uacpi_object_resolve_as_aml_namepath(
@@ -1099,7 +1432,7 @@ uacpi_status uacpi_get_pci_routing_table(
             goto out_bad_encoding;
         }
 
-        elem_obj = entry_pkg->objects[3];
+        elem_obj = uacpi_package_element(entry_pkg, 3, &scratch);
         if (uacpi_unlikely(elem_obj->type != UACPI_OBJECT_INTEGER)) {
             uacpi_error("invalid _PRT sub-package %zu source index type: %s\n",
                         i, uacpi_object_type_to_string(elem_obj->type));
@@ -1137,3 +1470,345 @@ void uacpi_free_dynamic_string(const uacpi_char *str)
 
     uacpi_free((void*)str, uacpi_strlen(str) + 1);
 }
+
+const uacpi_char *uacpi_device_change_kind_to_string(
+    uacpi_device_change_kind kind
+)
+{
+    switch (kind) {
+    case UACPI_DEVICE_CHANGE_ADDED:
+        return "added";
+    case UACPI_DEVICE_CHANGE_REMOVED:
+        return "removed";
+    case UACPI_DEVICE_CHANGE_CHANGED:
+        return "changed";
+    default:
+        return "<invalid>";
+    }
+}
+
+#define FNV1A_OFFSET_BASIS 0xCBF29CE484222325ull
+#define FNV1A_PRIME 0x100000001B3ull
+
+static uacpi_u64 hash_bytes(uacpi_u64 hash, const void *data, uacpi_size size)
+{
+    const uacpi_u8 *bytes = data;
+    uacpi_size i;
+
+    for (i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+
+    return hash;
+}
+
+static uacpi_u64 hash_id_string(uacpi_u64 hash, const uacpi_id_string *id)
+{
+    hash = hash_bytes(hash, &id->size, sizeof(id->size));
+    return hash_bytes(hash, id->value, id->size);
+}
+
+/*
+ * The status of every evaluation is hashed as well, so that e.g. a missing _UID
+ * is different from a _UID that fails to evaluate.
+ */
+static uacpi_status eval_identity_locked(
+    uacpi_namespace_node *node, uacpi_u64 *out_identity
+)
+{
+    uacpi_status ret = UACPI_STATUS_OK, hid_ret, uid_ret, cid_ret, adr_ret;
+    uacpi_u64 hash = FNV1A_OFFSET_BASIS, adr = 0;
+    uacpi_id_string *hid = UACPI_NULL, *uid = UACPI_NULL;
+    uacpi_pnp_id_list *cid = UACPI_NULL;
+    uacpi_u32 i;
+
+    hid_ret = eval_hid(node, UACPI_TRUE, &hid);
+    uid_ret = eval_uid(node, UACPI_TRUE, &uid);
+    cid_ret = eval_cid(node, UACPI_TRUE, &cid);
+    adr_ret = eval_integer(node, "_ADR", UACPI_TRUE, &adr);
+
+    if (uacpi_unlikely(hid_ret == UACPI_STATUS_OUT_OF_MEMORY ||
+                       uid_ret == UACPI_STATUS_OUT_OF_MEMORY ||
+                       cid_ret == UACPI_STATUS_OUT_OF_MEMORY ||
+                       adr_ret == UACPI_STATUS_OUT_OF_MEMORY)) {
+        ret = UACPI_STATUS_OUT_OF_MEMORY;
+        goto out;
+    }
+
+    hash = hash_bytes(hash, &hid_ret, sizeof(hid_ret));
+    if (hid != UACPI_NULL)
+        hash = hash_id_string(hash, hid);
+
+    hash = hash_bytes(hash, &uid_ret, sizeof(uid_ret));
+    if (uid != UACPI_NULL)
+        hash = hash_id_string(hash, uid);
+
+    hash = hash_bytes(hash, &cid_ret, sizeof(cid_ret));
+    if (cid != UACPI_NULL) {
+        hash = hash_bytes(hash, &cid->num_ids, sizeof(cid->num_ids));
+
+        for (i = 0; i < cid->num_ids; ++i)
+            hash = hash_id_string(hash, &cid->ids[i]);
+    }
+
+    hash = hash_bytes(hash, &adr_ret, sizeof(adr_ret));
+    hash = hash_bytes(hash, &adr, sizeof(adr));
+
+    *out_identity = hash;
+out:
+    uacpi_free_id_string(hid);
+    uacpi_free_id_string(uid);
+    uacpi_free_pnp_id_list(cid);
+    return ret;
+}
+
+struct rescan_item {
+    uacpi_namespace_node *node;
+    uacpi_u32 depth;
+};
+
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE(rescan_item_array, struct rescan_item, 16)
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE_IMPL(
+    rescan_item_array, struct rescan_item, static
+)
+
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE(device_change_array, uacpi_device_change, 8)
+DYNAMIC_ARRAY_WITH_INLINE_STORAGE_IMPL(
+    device_change_array, uacpi_device_change, static
+)
+
+struct rescan_ctx {
+    struct rescan_item_array items;
+    struct device_change_array changes;
+    uacpi_status st;
+};
+
+static uacpi_iteration_decision collect_rescan_device(
+    void *opaque, uacpi_namespace_node *node, uacpi_u32 depth
+)
+{
+    struct rescan_ctx *ctx = opaque;
+    struct rescan_item *item;
+
+    item = rescan_item_array_alloc(&ctx->items);
+    if (uacpi_unlikely(item == UACPI_NULL)) {
+        ctx->st = UACPI_STATUS_OUT_OF_MEMORY;
+        return UACPI_ITERATION_DECISION_BREAK;
+    }
+
+    item->node = node;
+    item->depth = depth;
+    uacpi_shareable_ref(node);
+    return UACPI_ITERATION_DECISION_CONTINUE;
+}
+
+static uacpi_bool sta_is_valid_device(uacpi_u32 sta)
+{
+    return sta & (ACPI_STA_RESULT_DEVICE_PRESENT |
+                  ACPI_STA_RESULT_DEVICE_FUNCTIONING);
+}
+
+static uacpi_status rescan_device_locked(
+    struct rescan_ctx *ctx, uacpi_namespace_node *node,
+    struct uacpi_device_presence *presence, uacpi_u32 sta
+)
+{
+    uacpi_status ret;
+    uacpi_device_change *change;
+    uacpi_device_change_kind kind = UACPI_DEVICE_CHANGE_CHANGED;
+    uacpi_bool was_valid, is_valid, report = UACPI_FALSE;
+    uacpi_u64 identity = 0;
+
+    was_valid = (presence->flags & UACPI_DEVICE_PRESENCE_STA_VALID) &&
+                sta_is_valid_device(presence->sta);
+    is_valid = sta_is_valid_device(sta);
+
+    if (is_valid) {
+        ret = eval_identity_locked(node, &identity);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    }
+
+    if (was_valid != is_valid) {
+        kind = is_valid ? UACPI_DEVICE_CHANGE_ADDED :
+                          UACPI_DEVICE_CHANGE_REMOVED;
+        report = UACPI_TRUE;
+    } else if (is_valid) {
+        /*
+         * Namespace initialization only records _STA, so the identity of a
+         * device that has never been rescanned is unknown and might have
+         * changed since, report it conservatively.
+         */
+        report = presence->sta != sta ||
+                 !(presence->flags & UACPI_DEVICE_PRESENCE_IDENTITY_VALID) ||
+                 presence->identity != identity;
+    }
+
+    if (report) {
+        change = device_change_array_alloc(&ctx->changes);
+        if (uacpi_unlikely(change == UACPI_NULL))
+            return UACPI_STATUS_OUT_OF_MEMORY;
+
+        change->node = node;
+        uacpi_shareable_ref(node);
+        change->kind = kind;
+        change->old_sta = 0;
+        if (presence->flags & UACPI_DEVICE_PRESENCE_STA_VALID)
+            change->old_sta = presence->sta;
+        change->new_sta = sta;
+    }
+
+    presence->sta = sta;
+    presence->flags |= UACPI_DEVICE_PRESENCE_STA_VALID;
+
+    if (is_valid) {
+        presence->identity = identity;
+        presence->flags |= UACPI_DEVICE_PRESENCE_IDENTITY_VALID;
+    } else {
+        presence->flags &= ~UACPI_DEVICE_PRESENCE_IDENTITY_VALID;
+    }
+
+    return UACPI_STATUS_OK;
+}
+
+static uacpi_status rescan_locked(struct rescan_ctx *ctx)
+{
+    uacpi_status ret;
+    struct rescan_item *item;
+    uacpi_object *obj;
+    uacpi_size i;
+    uacpi_u32 sta, absent_depth = 0;
+    uacpi_bool below_absent = UACPI_FALSE;
+
+    for (i = 0; i < rescan_item_array_size(&ctx->items); ++i) {
+        item = rescan_item_array_at(&ctx->items, i);
+
+        // Might have been unloaded while we weren't holding the lock
+        obj = uacpi_namespace_node_get_object_typed(
+            item->node, UACPI_OBJECT_DEVICE_BIT
+        );
+        if (uacpi_unlikely(obj == UACPI_NULL))
+            continue;
+
+        if (below_absent && item->depth > absent_depth) {
+            // Children of an absent device are gone as well
+            sta = 0;
+        } else {
+            below_absent = UACPI_FALSE;
+
+            // Keep the previous state, _STA will complain by itself
+            ret = eval_sta(item->node, UACPI_TRUE, &sta);
+            if (uacpi_unlikely_error(ret))
+                continue;
+
+            if (!sta_is_valid_device(sta)) {
+                below_absent = UACPI_TRUE;
+                absent_depth = item->depth;
+            }
+        }
+
+        ret = rescan_device_locked(
+            ctx, item->node, &obj->device->presence, sta
+        );
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    }
+
+    return UACPI_STATUS_OK;
+}
+
+uacpi_status uacpi_rescan_devices(
+    uacpi_namespace_node *node, uacpi_device_change_list **out_list
+)
+{
+    uacpi_status ret;
+    struct rescan_ctx ctx = {
+        .st = UACPI_STATUS_OK,
+    };
+    uacpi_device_change_list *list;
+    uacpi_device_change *change;
+    uacpi_size i, count;
+    uacpi_bool is_device;
+
+    UACPI_ENSURE_INIT_LEVEL_AT_LEAST(UACPI_INIT_LEVEL_NAMESPACE_LOADED);
+
+    if (uacpi_unlikely(node == UACPI_NULL || out_list == UACPI_NULL))
+        return UACPI_STATUS_INVALID_ARGUMENT;
+
+    if (g_uacpi_rt_ctx.lazy_init_active) {
+        ret = uacpi_namespace_initialize_subtree(node);
+        if (uacpi_unlikely_error(ret))
+            return ret;
+    }
+
+    ret = uacpi_namespace_node_is(node, UACPI_OBJECT_DEVICE, &is_device);
+    if (uacpi_unlikely_error(ret))
+        return ret;
+
+    // The notified device itself is rescanned first
+    if (is_device)
+        collect_rescan_device(&ctx, node, 0);
+
+    if (ctx.st == UACPI_STATUS_OK) {
+        ret = uacpi_namespace_for_each_child(
+            node, collect_rescan_device, UACPI_NULL, UACPI_OBJECT_DEVICE_BIT,
+            UACPI_MAX_DEPTH_ANY, &ctx
+        );
+    }
+    if (ret == UACPI_STATUS_OK)
+        ret = ctx.st;
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    ret = uacpi_namespace_write_lock();
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    ret = rescan_locked(&ctx);
+    uacpi_namespace_write_unlock();
+    if (uacpi_unlikely_error(ret))
+        goto out;
+
+    count = device_change_array_size(&ctx.changes);
+    list = uacpi_kernel_alloc(
+        sizeof(*list) + count * sizeof(uacpi_device_change)
+    );
+    if (uacpi_unlikely(list == UACPI_NULL)) {
+        ret = UACPI_STATUS_OUT_OF_MEMORY;
+        goto out;
+    }
+
+    // The list takes over the node references
+    list->count = count;
+    for (i = 0; i < count; ++i)
+        list->changes[i] = *device_change_array_at(&ctx.changes, i);
+    device_change_array_clear(&ctx.changes);
+
+    *out_list = list;
+
+out:
+    for (i = 0; i < device_change_array_size(&ctx.changes); ++i) {
+        change = device_change_array_at(&ctx.changes, i);
+        uacpi_namespace_node_unref(change->node);
+    }
+    device_change_array_clear(&ctx.changes);
+
+    for (i = 0; i < rescan_item_array_size(&ctx.items); ++i)
+        uacpi_namespace_node_unref(rescan_item_array_at(&ctx.items, i)->node);
+    rescan_item_array_clear(&ctx.items);
+    return ret;
+}
+
+void uacpi_free_device_change_list(uacpi_device_change_list *list)
+{
+    uacpi_size i;
+
+    if (list == UACPI_NULL)
+        return;
+
+    for (i = 0; i < list->count; ++i)
+        uacpi_namespace_node_unref(list->changes[i].node);
+
+    uacpi_free(list, sizeof(*list) + list->count * sizeof(uacpi_device_change));
+}
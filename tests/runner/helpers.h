@@ -23,6 +23,9 @@ private:
 extern bool g_expect_virtual_addresses;
 extern uacpi_phys_addr g_rsdp;
 
+// Invoked for every BreakPoint instead of the default logging if set
+extern void (*g_breakpoint_hook)(void);
+
 UACPI_PACKED(struct full_xsdt {
     struct acpi_sdt_hdr hdr;
     acpi_fadt* fadt;
@@ -37,3 +40,11 @@ void build_xsdt(full_xsdt& xsdt, acpi_rsdp& rsdp, std::string_view dsdt_path,
 
 std::pair<void*, size_t>
 read_entire_file(std::string_view path, size_t min_size = 0);
+
+struct allocation_stats {
+    uacpi_u64 count;
+    uacpi_u64 bytes;
+};
+
+// Totals of all uacpi_kernel_alloc/calloc calls made so far
+allocation_stats get_allocation_stats();
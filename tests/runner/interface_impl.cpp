@@ -3,11 +3,13 @@
 #include <cstdarg>
 #include <cstdio>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <thread>
 #include <condition_variable>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <cstring>
 #include <cinttypes>
 
@@ -28,6 +30,8 @@
 
 #include <uacpi/kernel_api.h>
 
+#include "helpers.h"
+
 uacpi_phys_addr g_rsdp;
 
 uacpi_status uacpi_kernel_get_rsdp(uacpi_phys_addr *out_rdsp_address)
@@ -136,6 +140,7 @@ uacpi_status uacpi_kernel_pci_write(
 }
 
 bool g_expect_virtual_addresses = true;
+void (*g_breakpoint_hook)(void);
 
 struct mapping {
     void *virt;
@@ -163,9 +168,14 @@ virt_to_phys_and_refcount;
 static std::unordered_map<uacpi_phys_addr, std::unordered_set<mapping>>
 phys_to_virt;
 
+// Work items and test threads might map and allocate concurrently
+static std::mutex mapping_mutex;
+
 void* uacpi_kernel_map(uacpi_phys_addr addr, uacpi_size size)
 {
     if (!g_expect_virtual_addresses) {
+        std::unique_lock<std::mutex> lock(mapping_mutex);
+
         auto it = phys_to_virt.find(addr);
         if (it != phys_to_virt.end()) {
             auto mapping_it = it->second.find({ nullptr, size });
@@ -192,6 +202,8 @@ void* uacpi_kernel_map(uacpi_phys_addr addr, uacpi_size size)
 
 void uacpi_kernel_unmap(void* addr, uacpi_size size)
 {
+    std::unique_lock<std::mutex> lock(mapping_mutex);
+
     auto it = virt_to_phys_and_refcount.find(addr);
     if (it == virt_to_phys_and_refcount.end())
         return;
@@ -215,8 +227,23 @@ void uacpi_kernel_unmap(void* addr, uacpi_size size)
     virt_to_phys_and_refcount.erase(it);
 }
 
+static std::atomic<uacpi_u64> allocation_count;
+static std::atomic<uacpi_u64> allocation_bytes;
+
+allocation_stats get_allocation_stats()
+{
+    return { allocation_count.load(), allocation_bytes.load() };
+}
+
+static void account_allocation(uacpi_size size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
 #ifdef UACPI_SIZED_FREES
 static std::unordered_map<void*, uacpi_size> allocations;
+static std::mutex allocations_mutex;
 
 void* uacpi_kernel_alloc(uacpi_size size)
 {
@@ -227,6 +254,9 @@ void* uacpi_kernel_alloc(uacpi_size size)
     if (ret == nullptr)
         return ret;
 
+    account_allocation(size);
+
+    std::unique_lock<std::mutex> lock(allocations_mutex);
     allocations[ret] = size;
     return ret;
 }
@@ -236,6 +266,7 @@ void uacpi_kernel_free(void* mem, uacpi_size size)
     if (mem == nullptr)
         return;
 
+    std::unique_lock<std::mutex> lock(allocations_mutex);
     auto it = allocations.find(mem);
     if (it == allocations.end()) {
         std::fprintf(stderr, "unable to find heap allocation %p\n", mem);
@@ -252,6 +283,8 @@ void uacpi_kernel_free(void* mem, uacpi_size size)
     }
 
     allocations.erase(it);
+    lock.unlock();
+
     free(mem);
 }
 
@@ -270,6 +303,7 @@ void* uacpi_kernel_alloc(uacpi_size size)
     if (size == 0)
         std::abort();
 
+    account_allocation(size);
     return malloc(size);
 }
 
@@ -280,6 +314,7 @@ void uacpi_kernel_free(void* mem)
 
 void *uacpi_kernel_calloc(uacpi_size count, uacpi_size size)
 {
+    account_allocation(count * size);
     return calloc(count, size);
 }
 #endif
@@ -383,6 +418,7 @@ void uacpi_kernel_sleep(uacpi_u64 msec)
     std::this_thread::sleep_for(std::chrono::milliseconds(msec));
 }
 
+#ifndef UACPI_SINGLE_THREADED
 uacpi_handle uacpi_kernel_create_mutex(void)
 {
     return new std::timed_mutex();
@@ -434,6 +470,7 @@ void uacpi_kernel_release_mutex(uacpi_handle handle)
 
     mutex->unlock();
 }
+#endif
 
 class Event {
 public:
@@ -520,6 +557,11 @@ uacpi_status uacpi_kernel_handle_firmware_request(uacpi_firmware_request* req)
 {
     switch (req->type) {
     case UACPI_FIRMWARE_REQUEST_TYPE_BREAKPOINT:
+        if (g_breakpoint_hook) {
+            g_breakpoint_hook();
+            break;
+        }
+
         std::cout << "Ignoring breakpoint" << std::endl;
         break;
     case UACPI_FIRMWARE_REQUEST_TYPE_FATAL:
@@ -548,6 +590,7 @@ uacpi_status uacpi_kernel_uninstall_interrupt_handler(
     return UACPI_STATUS_OK;
 }
 
+#ifndef UACPI_SINGLE_THREADED
 uacpi_handle uacpi_kernel_create_spinlock(void)
 {
     return uacpi_kernel_create_mutex();
@@ -568,16 +611,81 @@ void uacpi_kernel_unlock_spinlock(uacpi_handle handle, uacpi_cpu_flags)
 {
     uacpi_kernel_release_mutex(handle);
 }
+#endif
+
+#ifndef UACPI_SINGLE_THREADED
+/*
+ * Work that is meant to make use of multiple CPUs is run on a thread of its
+ * own, so that the parallel code paths actually execute concurrently. Threads
+ * are joined by uacpi_kernel_wait_for_work_completion. Everything else is run
+ * inline to keep the output of the tests deterministic.
+ */
+static std::mutex g_work_mutex;
+static std::vector<std::thread> g_work_threads;
+
+static bool is_parallel_work(uacpi_work_type type)
+{
+    return type == UACPI_WORK_PARALLEL ||
+           type == UACPI_WORK_NAMESPACE_INITIALIZATION;
+}
+#endif
 
 uacpi_status uacpi_kernel_schedule_work(
-    uacpi_work_type, uacpi_work_handler handler, uacpi_handle ctx
+    uacpi_work_type type, uacpi_work_handler handler, uacpi_handle ctx
 )
 {
+#ifndef UACPI_SINGLE_THREADED
+    if (is_parallel_work(type)) {
+        std::unique_lock<std::mutex> lock(g_work_mutex);
+        g_work_threads.emplace_back(handler, ctx);
+        return UACPI_STATUS_OK;
+    }
+#else
+    static_cast<void>(type);
+#endif
+
     handler(ctx);
     return UACPI_STATUS_OK;
 }
 
 uacpi_status uacpi_kernel_wait_for_work_completion()
 {
+#ifndef UACPI_SINGLE_THREADED
+    auto self = std::this_thread::get_id();
+    std::vector<std::thread> threads;
+    std::vector<std::thread> remaining;
+
+    /*
+     * Threads might schedule more work while we're joining them, keep going
+     * until there's nothing left. A work item waiting for completion cannot
+     * join itself, so leave it for someone else to join.
+     */
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(g_work_mutex);
+            threads.swap(g_work_threads);
+        }
+
+        if (threads.empty())
+            break;
+
+        for (auto& thread : threads) {
+            if (thread.get_id() == self) {
+                remaining.push_back(std::move(thread));
+                continue;
+            }
+
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    if (!remaining.empty()) {
+        std::unique_lock<std::mutex> lock(g_work_mutex);
+        for (auto& thread : remaining)
+            g_work_threads.push_back(std::move(thread));
+    }
+#endif
+
     return UACPI_STATUS_OK;
 }
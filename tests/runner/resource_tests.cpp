@@ -1,11 +1,16 @@
 #include <array>
+#include <algorithm>
 #include <vector>
 #include <string_view>
 #include <optional>
 #include <iostream>
 #include <set>
+#include <chrono>
+#include <cstring>
 #include <uacpi/resources.h>
 
+#include "helpers.h"
+
 
 // This is private API, but we have to use it for tests here.
 extern "C" {
@@ -2140,22 +2145,13 @@ std::array test_cases = {
     }
 };
 
-void run_resource_tests()
+static size_t run_test_cases(std::string_view mode)
 {
-    if constexpr (sizeof(void*) == 4) {
-        /*
-         * Since resource tests do byte-by-byte memcmps it's too much work to
-         * make them support multiple bit widths. The current implementation
-         * is targeting 64-bit platforms.
-         */;
-        std::cout << "Resource tests only support 64-bit platforms\n";
-        return;
-    }
-
     size_t fail_count = 0;
 
     for (auto& test: test_cases) {
-        std::cout << "Running resource test '" << test.name << "'...";
+        std::cout << "Running resource test '" << test.name << "'"
+                  << mode << "...";
 
         uacpi_resources *resources;
         uacpi_buffer aml_buffer;
@@ -2184,6 +2180,17 @@ void run_resource_tests()
         for (size_t i = 0; i < resources->length; ++i) {
             if ((i & (sizeof(void*) - 1)) == 0 &&
                 test.pointer_offsets.count(i)) {
+                uint8_t *ptr;
+
+                // Must point into the same list, even if it had to be moved
+                std::memcpy(&ptr, bytes + i, sizeof(ptr));
+                if (ptr != nullptr &&
+                    (ptr < bytes || ptr >= bytes + resources->length)) {
+                    std::printf("native pointer at %zu is out of bounds\n", i);
+                    fail_count++;
+                    goto next_test;
+                }
+
                 i += sizeof(void*) - 1;
                 continue;
             }
@@ -2227,6 +2234,168 @@ void run_resource_tests()
         uacpi_object_unref(resource_template);
     }
 
+    return fail_count;
+}
+
+void run_resource_tests()
+{
+    if constexpr (sizeof(void*) == 4) {
+        /*
+         * Since resource tests do byte-by-byte memcmps it's too much work to
+         * make them support multiple bit widths. The current implementation
+         * is targeting 64-bit platforms.
+         */;
+        std::cout << "Resource tests only support 64-bit platforms\n";
+        return;
+    }
+
+    size_t fail_count = run_test_cases("");
+
+#ifdef UACPI_SPECIALIZED_RESOURCE_CONVERTERS
+    /*
+     * The specialized converters are generated from the same programs as the
+     * instruction tables, make sure both still produce identical results.
+     */
+    uacpi_resources_force_interpreter(UACPI_TRUE);
+    fail_count += run_test_cases(" (interpreter)");
+    uacpi_resources_force_interpreter(UACPI_FALSE);
+#endif
+
     if (fail_count)
         throw std::runtime_error("one or more resource tests failed");
 }
+
+/*
+ * The benchmark template is made up of the descriptors of these test cases,
+ * each repeated this many times.
+ */
+static constexpr std::string_view bench_test_cases[] = {
+    "GpioInt", "I2CSerialBusV2", "PinGroup", "QWordMemory",
+};
+static constexpr size_t bench_copies_per_test_case = 256;
+
+static size_t aml_descriptor_length(const uint8_t *data)
+{
+    // Large descriptors have a 16-bit length, small ones a 3-bit length
+    if (data[0] & 0x80)
+        return 3 + (data[1] | (data[2] << 8));
+
+    return 1 + (data[0] & 0x07);
+}
+
+static std::vector<uint8_t> build_bench_template(size_t& out_descriptors)
+{
+    std::vector<uint8_t> aml_bytes;
+
+    out_descriptors = 0;
+
+    for (auto name : bench_test_cases) {
+        auto *test = std::find_if(
+            test_cases.begin(), test_cases.end(),
+            [&](const test_case& test) { return test.name == name; }
+        );
+        if (test == test_cases.end())
+            throw std::runtime_error("missing benchmark test case");
+
+        // Everything but the end tag
+        auto& bytes = test->aml_bytes;
+        auto length = bytes.size() - 2;
+        size_t descriptors = 0;
+
+        for (size_t i = 0; i < length; i += aml_descriptor_length(&bytes[i]))
+            descriptors++;
+
+        for (size_t i = 0; i < bench_copies_per_test_case; ++i)
+            aml_bytes.insert(aml_bytes.end(), bytes.begin(),
+                             bytes.begin() + length);
+
+        out_descriptors += descriptors * bench_copies_per_test_case;
+    }
+
+    aml_bytes.insert(aml_bytes.end(), { AML_END_TAG });
+    return aml_bytes;
+}
+
+template <typename ConvertT>
+static void bench_conversion(
+    std::string_view name, size_t descriptors, uint32_t iterations,
+    ConvertT convert
+)
+{
+    auto stats_before = get_allocation_stats();
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; ++i)
+        convert();
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto stats_after = get_allocation_stats();
+
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    auto count = stats_after.count - stats_before.count;
+    auto bytes = stats_after.bytes - stats_before.bytes;
+
+    std::printf(
+        "%s: %.3f ms per template, %.0f descriptors/sec, "
+        "%.1f allocations (%.0f bytes) per template\n",
+        name.data(), seconds * 1000.0 / iterations,
+        descriptors * iterations / seconds,
+        double(count) / iterations, double(bytes) / iterations
+    );
+}
+
+void run_resource_bench(uint32_t iterations)
+{
+    uacpi_status ret;
+    uacpi_resources *resources;
+    uacpi_object *resource_template;
+    uacpi_buffer aml_buffer;
+    size_t descriptors;
+
+    auto aml_bytes = build_bench_template(descriptors);
+    aml_buffer.data = aml_bytes.data();
+    aml_buffer.size = aml_bytes.size();
+
+    std::printf(
+        "Benchmarking a %zu byte template with %zu descriptors, "
+        "%u iterations\n", aml_bytes.size(), descriptors, iterations
+    );
+
+    // Make sure the template survives a round trip before timing anything
+    ret = uacpi_native_resources_from_aml(&aml_buffer, &resources);
+    if (uacpi_unlikely_error(ret))
+        throw std::runtime_error("from_aml failed on the benchmark template");
+
+    ret = uacpi_native_resources_to_aml(resources, &resource_template);
+    if (uacpi_unlikely_error(ret)) {
+        uacpi_free_resources(resources);
+        throw std::runtime_error("to_aml failed on the benchmark template");
+    }
+
+    auto guard = ScopeGuard([&] {
+        uacpi_free_resources(resources);
+        uacpi_object_unref(resource_template);
+    });
+
+    auto *out_bytes = resource_template->buffer->byte_data;
+    if (resource_template->buffer->size != aml_bytes.size() ||
+        std::memcmp(out_bytes, aml_bytes.data(), aml_bytes.size()) != 0)
+        throw std::runtime_error("benchmark template round trip mismatch");
+
+    std::printf("native size: %zu bytes\n", resources->length);
+
+    bench_conversion("from_aml", descriptors, iterations, [&] {
+        uacpi_resources *out_resources;
+
+        ret = uacpi_native_resources_from_aml(&aml_buffer, &out_resources);
+        if (uacpi_likely_success(ret))
+            uacpi_free_resources(out_resources);
+    });
+    bench_conversion("to_aml", descriptors, iterations, [&] {
+        uacpi_object *out_template;
+
+        ret = uacpi_native_resources_to_aml(resources, &out_template);
+        if (uacpi_likely_success(ret))
+            uacpi_object_unref(out_template);
+    });
+}
@@ -5,6 +5,10 @@
 #include <string_view>
 #include <cinttypes>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
 
 #include "helpers.h"
 #include "argparser.h"
@@ -15,8 +19,10 @@
 #include <uacpi/osi.h>
 #include <uacpi/tables.h>
 #include <uacpi/opregion.h>
+#include <uacpi/kernel_api.h>
 
 void run_resource_tests();
+void run_resource_bench(uint32_t iterations);
 
 static uacpi_object_type string_to_object_type(std::string_view str)
 {
@@ -272,6 +278,50 @@ static uacpi_status handle_ec(uacpi_region_op op, uacpi_handle op_data)
     }
 }
 
+/*
+ * An index/data register pair at offsets 0 and 1, used to detect interleaved
+ * IndexField accesses. Selecting an index takes a while to widen the window.
+ */
+static std::mutex index_data_mutex;
+static uacpi_u8 index_data_index;
+static uacpi_u8 index_data_regs[256];
+
+static uacpi_status handle_ec_index_data(
+    uacpi_region_op op, uacpi_handle op_data
+)
+{
+    switch (op) {
+    case UACPI_REGION_OP_READ:
+    case UACPI_REGION_OP_WRITE: {
+        auto *rw_data = reinterpret_cast<uacpi_region_rw_data*>(op_data);
+        std::unique_lock<std::mutex> lock(index_data_mutex);
+
+        if (rw_data->offset == 0) {
+            if (op == UACPI_REGION_OP_READ) {
+                rw_data->value = index_data_index;
+                return UACPI_STATUS_OK;
+            }
+
+            index_data_index = rw_data->value;
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            return UACPI_STATUS_OK;
+        }
+
+        if (op == UACPI_REGION_OP_READ)
+            rw_data->value = index_data_regs[index_data_index];
+        else
+            index_data_regs[index_data_index] = rw_data->value;
+        return UACPI_STATUS_OK;
+    }
+    case UACPI_REGION_OP_ATTACH:
+    case UACPI_REGION_OP_DETACH:
+        return UACPI_STATUS_OK;
+    default:
+        return UACPI_STATUS_INVALID_ARGUMENT;
+    }
+}
+
 static void ensure_ok_status(uacpi_status st)
 {
     if (st == UACPI_STATUS_OK)
@@ -281,6 +331,31 @@ static void ensure_ok_status(uacpi_status st)
     throw std::runtime_error(std::string("uACPI error: ") + msg);
 }
 
+static uacpi_namespace_node *find_node(const char *path)
+{
+    uacpi_namespace_node *node;
+
+    auto st = uacpi_namespace_node_find(UACPI_NULL, path, &node);
+    ensure_ok_status(st);
+    return node;
+}
+
+// The resource test cases count their _CRS evaluations in \CNT
+static void check_crs_count(uacpi_u64 expected)
+{
+    uacpi_u64 crs_count;
+
+    auto st = uacpi_eval_simple_integer(UACPI_NULL, "\\CNT", &crs_count);
+    ensure_ok_status(st);
+
+    if (crs_count != expected) {
+        throw std::runtime_error(
+            "unexpected _CRS evaluation count " + std::to_string(crs_count) +
+            ", expected " + std::to_string(expected)
+        );
+    }
+}
+
 static void test_object_api()
 {
     uacpi_status st;
@@ -373,10 +448,1094 @@ static void test_object_api()
     uacpi_object_unref(objects[0]);
 }
 
+static void test_returned_package()
+{
+    uacpi_status st;
+    uacpi_object *pkg_obj, *nested;
+    uacpi_object_array elems;
+    uacpi_data_view view;
+    uacpi_u64 value;
+
+    st = uacpi_eval_simple_package(UACPI_NULL, "GPKG", &pkg_obj);
+    ensure_ok_status(st);
+
+    st = uacpi_object_get_package(pkg_obj, &elems);
+    ensure_ok_status(st);
+    if (elems.count != 4)
+        throw std::runtime_error("invalid returned package size");
+
+    st = uacpi_object_get_string(elems.objects[0], &view);
+    ensure_ok_status(st);
+    if (strcmp(view.text, "Hello") != 0)
+        throw std::runtime_error("invalid returned package string");
+
+    st = uacpi_object_get_integer(elems.objects[1], &value);
+    ensure_ok_status(st);
+    if (value != 0x123)
+        throw std::runtime_error("invalid returned package integer");
+
+    st = uacpi_object_assign_integer(elems.objects[1], 0x321);
+    ensure_ok_status(st);
+
+    st = uacpi_object_get_buffer(elems.objects[2], &view);
+    ensure_ok_status(st);
+    if (view.length != 3 || view.bytes[2] != 3)
+        throw std::runtime_error("invalid returned package buffer");
+
+    // Elements must stay alive after the package itself is gone
+    nested = elems.objects[3];
+    uacpi_object_ref(nested);
+    uacpi_object_unref(pkg_obj);
+
+    st = uacpi_object_get_package(nested, &elems);
+    ensure_ok_status(st);
+    if (elems.count != 2)
+        throw std::runtime_error("invalid nested package size");
+
+    st = uacpi_object_get_string(elems.objects[0], &view);
+    ensure_ok_status(st);
+    if (strcmp(view.text, "Nested") != 0)
+        throw std::runtime_error("invalid nested package string");
+
+    st = uacpi_object_get_buffer(elems.objects[1], &view);
+    ensure_ok_status(st);
+    if (view.length != 1 || view.bytes[0] != 0xFF)
+        throw std::runtime_error("invalid nested package buffer");
+
+    uacpi_object_unref(nested);
+}
+
+static void test_resource_cache()
+{
+    uacpi_status st;
+    uacpi_namespace_node *dev;
+    uacpi_resources *res;
+    uacpi_resource_cache_stats stats, initial_stats;
+
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\DEV0", &dev);
+    ensure_ok_status(st);
+
+    // Table loads count as invalidations as well
+    uacpi_get_resource_cache_stats(&initial_stats);
+
+    auto get_irq = [&] {
+        uacpi_resources *crs;
+
+        st = uacpi_get_current_resources(dev, &crs);
+        ensure_ok_status(st);
+
+        if (crs->entries[0].type != UACPI_RESOURCE_TYPE_IRQ ||
+            crs->entries[0].irq.num_irqs != 1)
+            throw std::runtime_error("invalid _CRS resources");
+
+        auto irq = crs->entries[0].irq.irqs[0];
+        uacpi_free_resources(crs);
+        return irq;
+    };
+    auto count_resources = [](void *user, uacpi_resource *resource) {
+        if (resource->type != UACPI_RESOURCE_TYPE_END_TAG)
+            ++*reinterpret_cast<int*>(user);
+        return UACPI_ITERATION_DECISION_CONTINUE;
+    };
+
+    if (get_irq() != 5 || get_irq() != 5)
+        throw std::runtime_error("invalid initial IRQ");
+    check_crs_count(1);
+
+    // Modifying a returned copy must not affect the cache
+    st = uacpi_get_current_resources(dev, &res);
+    ensure_ok_status(st);
+    res->entries[0].irq.irqs[0] = 7;
+    if (get_irq() != 5)
+        throw std::runtime_error("returned resources alias the cache");
+
+    int count = 0;
+    st = uacpi_for_each_device_resource(dev, "_CRS", count_resources, &count);
+    ensure_ok_status(st);
+    if (count != 1)
+        throw std::runtime_error("invalid number of iterated resources");
+    check_crs_count(1);
+
+    // _SRS must invalidate the cache
+    st = uacpi_set_resources(dev, res);
+    ensure_ok_status(st);
+    uacpi_free_resources(res);
+    if (get_irq() != 7)
+        throw std::runtime_error("resources not updated after _SRS");
+    check_crs_count(2);
+
+    // So do device check notifications and _DIS, even if done from AML
+    uacpi_object *arg = uacpi_object_create_integer(1);
+    uacpi_object_array args = { &arg, 1 };
+    st = uacpi_eval(UACPI_NULL, "\\NTFY", &args, UACPI_NULL);
+    uacpi_object_unref(arg);
+    ensure_ok_status(st);
+    get_irq();
+    check_crs_count(3);
+
+    st = uacpi_eval(dev, "_DIS", UACPI_NULL, UACPI_NULL);
+    ensure_ok_status(st);
+    get_irq();
+    check_crs_count(4);
+
+    uacpi_invalidate_resource_cache(UACPI_NULL);
+    get_irq();
+    get_irq();
+    check_crs_count(5);
+
+    uacpi_get_resource_cache_stats(&stats);
+    stats.invalidations -= initial_stats.invalidations;
+
+    if (stats.hits != 5 || stats.misses != 5 || stats.invalidations != 4) {
+        throw std::runtime_error(
+            "unexpected resource cache stats: " + std::to_string(stats.hits) +
+            " hits, " + std::to_string(stats.misses) + " misses, " +
+            std::to_string(stats.invalidations) + " invalidations"
+        );
+    }
+
+    // Copies must not point into the cached list, which may be gone by now
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\DEV1", &dev);
+    ensure_ok_status(st);
+    st = uacpi_get_current_resources(dev, &res);
+    ensure_ok_status(st);
+    uacpi_invalidate_resource_cache(UACPI_NULL);
+
+    uacpi_resources *crs;
+    st = uacpi_get_current_resources(dev, &crs);
+    ensure_ok_status(st);
+    uacpi_free_resources(crs);
+
+    auto& source = res->entries[0].extended_irq.source;
+    if (res->entries[0].type != UACPI_RESOURCE_TYPE_EXTENDED_IRQ ||
+        source.string == nullptr ||
+        std::string_view(source.string) != "\\DEV0") {
+        uacpi_free_resources(res);
+        throw std::runtime_error("invalid resource source in a copy");
+    }
+    uacpi_free_resources(res);
+}
+
+static void test_resource_streaming()
+{
+    uacpi_status st;
+    uacpi_namespace_node *dev;
+    uacpi_resources *res;
+    alignas(uacpi_resource) uacpi_u8 buf[128];
+    struct stream_result {
+        std::vector<uacpi_resource_type> seen;
+        const char *error;
+    } result;
+    auto& seen = result.seen;
+
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\DEV0", &dev);
+    ensure_ok_status(st);
+
+    auto check_resource = [](void *user, uacpi_resource *resource) {
+        // Don't throw across uACPI frames, just record the error
+        auto& result = *reinterpret_cast<stream_result*>(user);
+        auto *start = reinterpret_cast<uacpi_u8*>(resource);
+        auto in_buffer = [&](const void *ptr) {
+            auto *bytes = reinterpret_cast<const uacpi_u8*>(ptr);
+            return bytes >= start && bytes < start + resource->length;
+        };
+
+        switch (resource->type) {
+        case UACPI_RESOURCE_TYPE_EXTENDED_IRQ: {
+            auto& irq = resource->extended_irq;
+
+            if (irq.num_irqs != 1 || irq.irqs[0] != 9 ||
+                !in_buffer(irq.source.string) ||
+                std::string_view(irq.source.string) != "\\DEV0")
+                result.error = "invalid streamed extended IRQ";
+            break;
+        }
+        case UACPI_RESOURCE_TYPE_FIXED_MEMORY32:
+            if (resource->fixed_memory32.address != 0xFED00000 ||
+                resource->fixed_memory32.length != 0x400)
+                result.error = "invalid streamed memory range";
+            break;
+        case UACPI_RESOURCE_TYPE_SERIAL_I2C_CONNECTION: {
+            auto& i2c = resource->i2c_connection;
+
+            if (i2c.slave_address != 0x50 ||
+                i2c.connection_speed != 400000 ||
+                !in_buffer(i2c.common.source.string))
+                result.error = "invalid streamed I2C connection";
+            break;
+        }
+        default:
+            result.error = "unexpected streamed resource type";
+            break;
+        }
+
+        result.seen.push_back(
+            static_cast<uacpi_resource_type>(resource->type)
+        );
+        return UACPI_ITERATION_DECISION_CONTINUE;
+    };
+    auto stream = [&](uacpi_u64 mask, uacpi_size size = sizeof(buf)) {
+        seen.clear();
+        result.error = nullptr;
+
+        auto ret = uacpi_for_each_device_resource_of_type(
+            dev, "_CRS", mask, buf, size, check_resource, &result
+        );
+        if (result.error)
+            throw std::runtime_error(result.error);
+
+        return ret;
+    };
+    auto check_streaming = [&] {
+        st = stream(UACPI_RESOURCE_TYPE_BIT(UACPI_RESOURCE_TYPE_EXTENDED_IRQ));
+        ensure_ok_status(st);
+        if (seen.size() != 1)
+            throw std::runtime_error("extended IRQ not found");
+
+        st = stream(
+            UACPI_RESOURCE_TYPE_BIT(UACPI_RESOURCE_TYPE_FIXED_MEMORY32) |
+            UACPI_RESOURCE_TYPE_BIT(UACPI_RESOURCE_TYPE_SERIAL_I2C_CONNECTION)
+        );
+        ensure_ok_status(st);
+        if (seen.size() != 2 ||
+            seen[0] != UACPI_RESOURCE_TYPE_FIXED_MEMORY32 ||
+            seen[1] != UACPI_RESOURCE_TYPE_SERIAL_I2C_CONNECTION)
+            throw std::runtime_error("invalid streamed resources");
+
+        st = stream(UACPI_RESOURCE_TYPE_BIT(UACPI_RESOURCE_TYPE_GPIO_CONNECTION));
+        ensure_ok_status(st);
+        if (!seen.empty())
+            throw std::runtime_error("streamed an unrequested resource");
+
+        // Matching resources that don't fit are an error
+        st = stream(
+            UACPI_RESOURCE_TYPE_BIT(UACPI_RESOURCE_TYPE_EXTENDED_IRQ), 16
+        );
+        if (st != UACPI_STATUS_INVALID_ARGUMENT)
+            throw std::runtime_error("expected an undersized buffer error");
+    };
+
+    uacpi_resource_cache_stats before, after;
+    auto check_stats = [&](uacpi_u64 hits, uacpi_u64 misses) {
+        uacpi_get_resource_cache_stats(&after);
+
+        if (after.hits - before.hits != hits ||
+            after.misses - before.misses != misses)
+            throw std::runtime_error("unexpected resource cache stats");
+    };
+
+    // Streaming uncached resources doesn't populate the cache, not a miss
+    uacpi_get_resource_cache_stats(&before);
+    check_streaming();
+    check_crs_count(4);
+    check_stats(0, 0);
+
+    // Once cached, resources are streamed from the cache instead
+    st = uacpi_get_current_resources(dev, &res);
+    ensure_ok_status(st);
+    uacpi_free_resources(res);
+    check_crs_count(5);
+
+    uacpi_get_resource_cache_stats(&before);
+    check_streaming();
+    check_crs_count(5);
+    check_stats(4, 0);
+}
+
+static void test_resource_bulk()
+{
+    uacpi_status st;
+    uacpi_resource_set *set = nullptr;
+    uacpi_resources *res;
+    struct slice_result {
+        std::vector<uacpi_resource_type> types;
+        const uacpi_u8 *start, *end;
+        const char *error;
+    };
+
+    auto *dev0 = find_node("\\DEV0");
+    auto *dev2 = find_node("\\DEV2");
+    auto *chld = find_node("\\DEV2.CHLD");
+    auto *dev4 = find_node("\\DEV4");
+
+    auto check_resource = [](void *user, uacpi_resource *resource) {
+        // Don't throw across uACPI frames, just record the error
+        auto& result = *reinterpret_cast<slice_result*>(user);
+        auto *bytes = reinterpret_cast<const uacpi_u8*>(resource);
+
+        if (bytes < result.start || bytes + resource->length > result.end)
+            result.error = "resource outside of its slice";
+
+        if (resource->type == UACPI_RESOURCE_TYPE_EXTENDED_IRQ) {
+            auto *source = reinterpret_cast<const uacpi_u8*>(
+                resource->extended_irq.source.string
+            );
+
+            if (source < bytes || source >= bytes + resource->length ||
+                std::string_view(resource->extended_irq.source.string) !=
+                "\\DEV0")
+                result.error = "invalid extended IRQ source";
+        }
+
+        result.types.push_back(
+            static_cast<uacpi_resource_type>(resource->type)
+        );
+        return UACPI_ITERATION_DECISION_CONTINUE;
+    };
+    auto check_device = [&](
+        const uacpi_device_resources& dev, uacpi_namespace_node *node,
+        std::vector<uacpi_resource_type> expected
+    ) {
+        slice_result result {};
+
+        if (dev.device != node)
+            throw std::runtime_error("unexpected device in the set");
+        ensure_ok_status(dev.status);
+
+        result.start = reinterpret_cast<uacpi_u8*>(dev.resources.entries);
+        result.end = result.start + dev.resources.length;
+
+        st = uacpi_for_each_resource(
+            const_cast<uacpi_resources*>(&dev.resources), check_resource,
+            &result
+        );
+        ensure_ok_status(st);
+
+        if (result.error)
+            throw std::runtime_error(result.error);
+
+        expected.push_back(UACPI_RESOURCE_TYPE_END_TAG);
+        if (result.types != expected)
+            throw std::runtime_error("unexpected resources in a slice");
+    };
+    auto check_dev0 = [&](const uacpi_device_resources& dev) {
+        check_device(dev, dev0, {
+            UACPI_RESOURCE_TYPE_FIXED_MEMORY32,
+            UACPI_RESOURCE_TYPE_EXTENDED_IRQ,
+        });
+    };
+    auto check_chld = [&](const uacpi_device_resources& dev) {
+        check_device(dev, chld, { UACPI_RESOURCE_TYPE_FIXED_IO });
+    };
+    auto get_bulk = [&](
+        uacpi_namespace_node *parent, const uacpi_char *const *hids,
+        uacpi_u32 num_workers, uacpi_size expected_count
+    ) {
+        st = uacpi_get_current_resources_bulk(
+            parent, hids, num_workers, &set
+        );
+        ensure_ok_status(st);
+
+        if (set->count != expected_count) {
+            throw std::runtime_error(
+                "unexpected device count " + std::to_string(set->count)
+            );
+        }
+    };
+    auto set_guard = ScopeGuard([&] { uacpi_free_resource_set(set); });
+
+    uacpi_resource_cache_stats before, after;
+    uacpi_get_resource_cache_stats(&before);
+
+    get_bulk(uacpi_namespace_root(), UACPI_NULL, 1, 4);
+    check_dev0(set->devices[0]);
+    check_device(set->devices[1], dev2, {
+        UACPI_RESOURCE_TYPE_IO,
+        UACPI_RESOURCE_TYPE_IRQ,
+    });
+    check_chld(set->devices[2]);
+    if (set->devices[3].device != dev4 ||
+        set->devices[3].status == UACPI_STATUS_OK)
+        throw std::runtime_error("broken _CRS didn't fail");
+    uacpi_free_resource_set(set);
+    set = nullptr;
+    check_crs_count(2);
+
+    const uacpi_char *const hids[] = { "PNP0C01", UACPI_NULL };
+    get_bulk(uacpi_namespace_root(), hids, 2, 2);
+    check_dev0(set->devices[0]);
+    check_chld(set->devices[1]);
+    uacpi_free_resource_set(set);
+    set = nullptr;
+    check_crs_count(4);
+
+    get_bulk(dev2, UACPI_NULL, 8, 1);
+    check_chld(set->devices[0]);
+    uacpi_free_resource_set(set);
+    set = nullptr;
+    check_crs_count(5);
+
+    // Cached resources are copied instead of re-evaluating _CRS
+    st = uacpi_get_current_resources(dev0, &res);
+    ensure_ok_status(st);
+    uacpi_free_resources(res);
+    check_crs_count(6);
+
+    get_bulk(uacpi_namespace_root(), hids, 1, 2);
+    check_dev0(set->devices[0]);
+    check_chld(set->devices[1]);
+    check_crs_count(7);
+
+    // Only the uacpi_get_current_resources call above populated the cache
+    uacpi_get_resource_cache_stats(&after);
+    if (after.hits - before.hits != 1 || after.misses - before.misses != 1)
+        throw std::runtime_error("unexpected resource cache stats");
+}
+
+static void test_pci_routing_table_shared()
+{
+    uacpi_namespace_node *pci0 = find_node("\\PCI0");
+    std::atomic<bool> aml_failed = false;
+    constexpr int iterations = 1000;
+
+    // Don't throw from the AML thread, just record the error
+    auto run_aml = [&] {
+        for (int i = 0; i < iterations; ++i) {
+            uacpi_u64 sum;
+
+            auto st = uacpi_eval_simple_integer(UACPI_NULL, "\\SUMP", &sum);
+            if (st != UACPI_STATUS_OK || sum != 16 + 17 + 18 + 19)
+                aml_failed = true;
+        }
+    };
+    auto read_table = [&] {
+        for (int i = 0; i < iterations; ++i) {
+            uacpi_pci_routing_table *table;
+
+            auto st = uacpi_get_pci_routing_table(pci0, &table);
+            ensure_ok_status(st);
+            auto guard = ScopeGuard(
+                [table] { uacpi_free_pci_routing_table(table); }
+            );
+
+            if (table->num_entries != 4)
+                throw std::runtime_error("invalid number of _PRT entries");
+
+            for (uacpi_u32 j = 0; j < 4; ++j) {
+                auto& entry = table->entries[j];
+
+                if (entry.address != ((j + 1) << 16 | 0xFFFF) ||
+                    entry.pin != j || entry.source != UACPI_NULL ||
+                    entry.index != 16 + j)
+                    throw std::runtime_error("invalid _PRT entry");
+            }
+        }
+    };
+
+    /*
+     * Reading the table must not modify the named _PRT, which AML is
+     * indexing at the same time.
+     */
+#ifndef UACPI_SINGLE_THREADED
+    std::thread aml_thread(run_aml);
+    auto join_guard = ScopeGuard([&aml_thread] { aml_thread.join(); });
+    read_table();
+    join_guard.disarm();
+    aml_thread.join();
+#else
+    read_table();
+    run_aml();
+#endif
+
+    if (aml_failed)
+        throw std::runtime_error("AML observed an invalid _PRT");
+}
+
+static void test_pci_interrupt_routing()
+{
+    uacpi_status st;
+    uacpi_namespace_node *pci0, *lnka, *lnkb;
+    uacpi_resources *res;
+    uacpi_pci_interrupt_route route;
+
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\PCI0", &pci0);
+    ensure_ok_status(st);
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\LNKA", &lnka);
+    ensure_ok_status(st);
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\LNKB", &lnkb);
+    ensure_ok_status(st);
+
+    auto check_count = [](const char *counter, uacpi_u64 expected) {
+        uacpi_u64 value;
+
+        ensure_ok_status(
+            uacpi_eval_simple_integer(UACPI_NULL, counter, &value)
+        );
+        if (value != expected) {
+            throw std::runtime_error(
+                std::string("unexpected ") + counter + " " +
+                std::to_string(value) + ", expected " +
+                std::to_string(expected)
+            );
+        }
+    };
+    auto check_route = [&](
+        uacpi_u8 device, uacpi_u8 pin, uacpi_namespace_node *link,
+        uacpi_bool resolved, uacpi_u32 gsi
+    ) {
+        st = uacpi_get_pci_interrupt_route(pci0, device, pin, &route);
+        ensure_ok_status(st);
+
+        if (route.link != link || route.resolved != resolved)
+            throw std::runtime_error("unexpected PCI interrupt route");
+        if (!resolved)
+            return;
+
+        if (route.gsi != gsi ||
+            route.triggering != UACPI_TRIGGERING_LEVEL ||
+            route.polarity != UACPI_POLARITY_ACTIVE_LOW ||
+            route.sharing != UACPI_SHARED) {
+            throw std::runtime_error(
+                "unexpected PCI interrupt route GSI " +
+                std::to_string(route.gsi)
+            );
+        }
+    };
+    auto check_routes = [&](uacpi_u32 link_gsi) {
+        check_route(1, 0, UACPI_NULL, UACPI_TRUE, 16);
+        check_route(2, 1, lnka, UACPI_TRUE, link_gsi);
+        check_route(2, 2, lnka, UACPI_TRUE, link_gsi);
+        check_route(4, 0, lnkb, UACPI_FALSE, 0);
+
+        st = uacpi_get_pci_interrupt_route(pci0, 3, 0, &route);
+        if (st != UACPI_STATUS_NOT_FOUND)
+            throw std::runtime_error("expected a missing PCI interrupt route");
+
+        st = uacpi_get_pci_interrupt_route(pci0, 32, 0, &route);
+        if (st != UACPI_STATUS_INVALID_ARGUMENT)
+            throw std::runtime_error("expected an invalid PCI device error");
+    };
+
+    check_routes(5);
+    check_routes(5);
+    check_count("\\PRTC", 1);
+    check_count("\\CRSC", 1);
+
+    // Reprogramming a link only resolves the routes through it again
+    st = uacpi_get_current_resources(lnka, &res);
+    ensure_ok_status(st);
+    res->entries[0].irq.irqs[0] = 9;
+    st = uacpi_set_resources(lnka, res);
+    uacpi_free_resources(res);
+    ensure_ok_status(st);
+
+    check_routes(9);
+    check_count("\\PRTC", 1);
+    check_count("\\CRSC", 2);
+
+    uacpi_invalidate_resource_cache(UACPI_NULL);
+    check_routes(9);
+    check_count("\\PRTC", 2);
+    check_count("\\CRSC", 3);
+}
+
+static void test_set_resources()
+{
+    uacpi_status st;
+    uacpi_namespace_node *dev;
+    uacpi_resources *res;
+    uacpi_object *kept;
+    uacpi_data_view view;
+
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\DEV0", &dev);
+    ensure_ok_status(st);
+
+    auto set_irq = [&](uacpi_u8 irq) {
+        st = uacpi_get_current_resources(dev, &res);
+        ensure_ok_status(st);
+
+        res->entries[0].irq.irqs[0] = irq;
+        st = uacpi_set_resources(dev, res);
+        uacpi_free_resources(res);
+        ensure_ok_status(st);
+    };
+    auto check_irq = [&](uacpi_u8 irq) {
+        st = uacpi_get_current_resources(dev, &res);
+        ensure_ok_status(st);
+
+        auto actual = res->entries[0].irq.irqs[0];
+        uacpi_free_resources(res);
+
+        if (actual != irq) {
+            throw std::runtime_error(
+                "unexpected IRQ " + std::to_string(actual) + ", expected " +
+                std::to_string(irq)
+            );
+        }
+    };
+
+    for (uacpi_u8 irq : { 9, 10, 11, 12 }) {
+        set_irq(irq);
+        check_irq(irq);
+    }
+
+    // The second template was kept by AML, so it must not have been reused
+    st = uacpi_eval_typed(
+        dev, "GETK", UACPI_NULL, UACPI_OBJECT_BUFFER_BIT, &kept
+    );
+    ensure_ok_status(st);
+    st = uacpi_object_get_string_or_buffer(kept, &view);
+    ensure_ok_status(st);
+
+    auto *bytes = view.const_bytes;
+    auto mask = view.length < 3 ? 0 : bytes[1] | (bytes[2] << 8);
+    uacpi_object_unref(kept);
+
+    if (mask != (1 << 10))
+        throw std::runtime_error("a template kept by AML was overwritten");
+}
+
+struct async_init_snapshot {
+    bool taken;
+    uacpi_init_stage stage;
+    bool dev0_initialized;
+    bool dev1_initialized;
+    bool sb_initialized;
+};
+static async_init_snapshot g_async_init_snapshot;
+
+static bool is_subtree_initialized(const char *path)
+{
+    uacpi_namespace_node *node = UACPI_NULL;
+
+    uacpi_namespace_node_find(UACPI_NULL, path, &node);
+    return uacpi_is_subtree_initialized(node);
+}
+
+// Called from \_SB.DEV1._INI, exceptions must not be thrown from here
+static void take_async_init_snapshot()
+{
+    auto& snapshot = g_async_init_snapshot;
+
+    snapshot.taken = true;
+    snapshot.stage = uacpi_get_current_init_stage();
+    snapshot.dev0_initialized = is_subtree_initialized("\\_SB.DEV0");
+    snapshot.dev1_initialized = is_subtree_initialized("\\_SB.DEV1");
+    snapshot.sb_initialized = is_subtree_initialized("\\_SB");
+}
+
+static void test_async_init()
+{
+    auto& snapshot = g_async_init_snapshot;
+    uacpi_namespace_node *dev;
+    uacpi_status st;
+
+    if (!snapshot.taken)
+        throw std::runtime_error("\\_SB.DEV1._INI was never executed");
+    if (snapshot.stage != UACPI_INIT_STAGE_REG_DONE)
+        throw std::runtime_error("unexpected stage during device init");
+    if (!snapshot.dev0_initialized)
+        throw std::runtime_error("\\_SB.DEV0 wasn't marked as initialized");
+    if (snapshot.dev1_initialized || snapshot.sb_initialized)
+        throw std::runtime_error("a subtree was marked initialized too early");
+
+    if (uacpi_get_current_init_stage() != UACPI_INIT_STAGE_DEVICES_INITIALIZED)
+        throw std::runtime_error("initialization didn't reach the last stage");
+
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\_SB.DEV1", &dev);
+    ensure_ok_status(st);
+
+    st = uacpi_wait_for_subtree_initialization(dev, 0);
+    ensure_ok_status(st);
+
+    st = uacpi_wait_for_init_stage(UACPI_INIT_STAGE_ROOT_INI_DONE, 0);
+    ensure_ok_status(st);
+
+    st = uacpi_namespace_initialize_async();
+    if (st != UACPI_STATUS_INIT_LEVEL_MISMATCH)
+        throw std::runtime_error("namespace was initialized twice");
+}
+
+static void test_lazy_init()
+{
+    uacpi_namespace_node *node;
+    uacpi_status st;
+
+    auto get_int = [&](const char *path) {
+        uacpi_u64 value;
+
+        st = uacpi_eval_simple_integer(UACPI_NULL, path, &value);
+        ensure_ok_status(st);
+        return value;
+    };
+    auto expect_int = [&](const char *path, uacpi_u64 expected) {
+        auto value = get_int(path);
+
+        if (value != expected) {
+            throw std::runtime_error(
+                std::string(path) + " is " + std::to_string(value) +
+                ", expected " + std::to_string(expected)
+            );
+        }
+    };
+    auto expect_initialized = [&](const char *path, bool expected) {
+        st = uacpi_namespace_node_find(UACPI_NULL, path, &node);
+        ensure_ok_status(st);
+
+        if (uacpi_is_subtree_initialized(node) != expected) {
+            throw std::runtime_error(
+                std::string(path) + (expected ? " wasn't" : " was") +
+                " initialized"
+            );
+        }
+    };
+
+    expect_initialized("\\_SB.DEV0", false);
+    expect_initialized("\\_SB.DEV2", false);
+
+    // First evaluation inside of DEV0 initializes it, children included
+    expect_int("\\_SB.DEV0.INIT", 1);
+    expect_int("\\_SB.DEV0.INIT", 1);
+    expect_int("\\_SB.DEV0.CHLD.INIT", 1);
+    expect_initialized("\\_SB.DEV0", true);
+    expect_initialized("\\_SB.DEV2", false);
+
+    // Parent is not present, the child must not be initialized
+    st = uacpi_namespace_node_find(UACPI_NULL, "\\_SB.DEV1.CHLD", &node);
+    ensure_ok_status(st);
+    st = uacpi_namespace_initialize_subtree(node);
+    ensure_ok_status(st);
+    expect_int("\\BAD", 0);
+
+    const uacpi_char *const hids[] = { "PNP0C02", UACPI_NULL };
+    size_t found = 0;
+
+    st = uacpi_find_devices_at(
+        uacpi_namespace_root(), hids,
+        [](void *user, uacpi_namespace_node*, uacpi_u32) {
+            ++*reinterpret_cast<size_t*>(user);
+            return UACPI_ITERATION_DECISION_CONTINUE;
+        }, &found
+    );
+    ensure_ok_status(st);
+    if (found != 1)
+        throw std::runtime_error("unexpected number of devices found");
+
+    expect_initialized("\\", true);
+    expect_int("\\_SB.DEV2.INIT", 1);
+    expect_int("\\_SB.DEV0.INIT", 1);
+    expect_int("\\BAD", 0);
+}
+
+static void test_boot_timeline()
+{
+    uacpi_boot_timeline *timeline;
+    uacpi_namespace_node *dev;
+
+    auto st = uacpi_namespace_node_find(UACPI_NULL, "\\DEV0", &dev);
+    ensure_ok_status(st);
+
+    st = uacpi_get_boot_timeline(&timeline);
+    ensure_ok_status(st);
+    auto guard = ScopeGuard(
+        [&timeline] { uacpi_free_boot_timeline(timeline); }
+    );
+
+    auto find = [&](uacpi_timeline_event event, auto&& pred) {
+        for (size_t i = 0; i < timeline->count; ++i) {
+            auto& rec = timeline->records[i];
+
+            if (rec.event == event && pred(rec))
+                return i;
+        }
+
+        throw std::runtime_error(
+            std::string("no matching ") +
+            uacpi_timeline_event_to_string(event) + " record"
+        );
+    };
+    auto any = [](const uacpi_timeline_record&) { return true; };
+    auto is_table = [](const char *sig) {
+        return [sig](const uacpi_timeline_record& rec) {
+            return strncmp(rec.signature.text, sig, 4) == 0;
+        };
+    };
+
+    for (size_t i = 0; i < timeline->count; ++i) {
+        auto& rec = timeline->records[i];
+
+        if (rec.end_ns < rec.begin_ns)
+            throw std::runtime_error("timeline record ends before it begins");
+    }
+
+    find(UACPI_TIMELINE_EVENT_RSDP_PARSE, any);
+    auto& xsdt = timeline->records[
+        find(UACPI_TIMELINE_EVENT_RXSDT_PARSE, is_table(ACPI_XSDT_SIGNATURE))
+    ];
+    if (xsdt.count == 0)
+        throw std::runtime_error("no XSDT entries recorded");
+
+    // The runner ID table is installed after uacpi_initialize
+    find(UACPI_TIMELINE_EVENT_TABLE_INSTALL, is_table(ACPI_SSDT_SIGNATURE));
+
+    auto dsdt_idx = find(
+        UACPI_TIMELINE_EVENT_TABLE_LOAD, is_table(ACPI_DSDT_SIGNATURE)
+    );
+    auto& dsdt = timeline->records[dsdt_idx];
+    if (dsdt.status != UACPI_STATUS_OK || dsdt.ops == 0 ||
+        dsdt.allocations == 0)
+        throw std::runtime_error("bad DSDT load record");
+
+    find(UACPI_TIMELINE_EVENT_REG, [](const uacpi_timeline_record& rec) {
+        return rec.space == UACPI_ADDRESS_SPACE_EMBEDDED_CONTROLLER;
+    });
+
+    auto is_dev = [dev](const uacpi_timeline_record& rec) {
+        return rec.node == dev;
+    };
+    auto sta_idx = find(UACPI_TIMELINE_EVENT_STA, is_dev);
+    auto ini_idx = find(UACPI_TIMELINE_EVENT_INI, is_dev);
+    if (timeline->records[sta_idx].count != 0x0F || sta_idx > ini_idx ||
+        dsdt_idx > sta_idx)
+        throw std::runtime_error("bad _STA/_INI records");
+
+#ifndef UACPI_REDUCED_HARDWARE
+    find(UACPI_TIMELINE_EVENT_GPE_MATCH, any);
+#endif
+
+    // Nothing is recorded past the namespace initialization
+    st = uacpi_eval(dev, "_INI", UACPI_NULL, UACPI_NULL);
+    ensure_ok_status(st);
+
+    uacpi_boot_timeline *after;
+    st = uacpi_get_boot_timeline(&after);
+    ensure_ok_status(st);
+
+    auto count_after = after->count;
+    uacpi_free_boot_timeline(after);
+
+    if (count_after != timeline->count)
+        throw std::runtime_error("events recorded after initialization");
+}
+
+static void test_device_info_snapshot()
+{
+    uacpi_device_info_snapshot *snapshot;
+    uacpi_namespace_node *dev0, *dev1, *chld;
+
+    dev0 = find_node("\\DEV0");
+    dev1 = find_node("\\DEV1");
+    chld = find_node("\\DEV1.CHLD");
+
+    auto take_snapshot = [&](uacpi_u32 since) {
+        auto st = uacpi_get_device_info_snapshot(
+            uacpi_namespace_root(), UACPI_OBJECT_DEVICE_BIT, since, &snapshot
+        );
+        ensure_ok_status(st);
+    };
+    auto find_entry = [&](uacpi_namespace_node *node) {
+        for (size_t i = 0; i < snapshot->count; ++i) {
+            if (snapshot->entries[i].node == node)
+                return &snapshot->entries[i];
+        }
+
+        throw std::runtime_error(
+            std::string(uacpi_namespace_node_name(node).text, 4) +
+            " is missing from the snapshot"
+        );
+    };
+    auto expect_count = [&](size_t count) {
+        if (snapshot->count != count) {
+            throw std::runtime_error(
+                "unexpected snapshot size " + std::to_string(snapshot->count) +
+                ", expected " + std::to_string(count)
+            );
+        }
+    };
+    auto eval = [](const char *path) {
+        auto st = uacpi_eval(UACPI_NULL, path, UACPI_NULL, UACPI_NULL);
+        ensure_ok_status(st);
+    };
+
+    take_snapshot(0);
+    auto guard = ScopeGuard(
+        [&snapshot] { uacpi_free_device_info_snapshot(snapshot); }
+    );
+
+    auto *info = find_entry(dev0)->info;
+    if (!(info->flags & UACPI_NS_NODE_INFO_HAS_HID) ||
+        strcmp(info->hid.value, "PNP0C01") != 0 ||
+        !(info->flags & UACPI_NS_NODE_INFO_HAS_UID) ||
+        strcmp(info->uid.value, "5") != 0 ||
+        !(info->flags & UACPI_NS_NODE_INFO_HAS_ADR) || info->adr != 0x10)
+        throw std::runtime_error("bad DEV0 info");
+
+    auto *entry = find_entry(dev1);
+    info = entry->info;
+    if (entry->sta != 0x0F || strcmp(info->hid.value, "PNP0A03") != 0 ||
+        !(info->flags & UACPI_NS_NODE_INFO_HAS_CID) ||
+        info->cid.num_ids != 2 ||
+        strcmp(info->cid.ids[0].value, "PNP0A08") != 0 ||
+        strcmp(info->cid.ids[1].value, "PNP0C02") != 0)
+        throw std::runtime_error("bad DEV1 info");
+
+    info = find_entry(chld)->info;
+    if (!(info->flags & UACPI_NS_NODE_INFO_HAS_SXD) || info->sxd[0] != 2 ||
+        info->flags & UACPI_NS_NODE_INFO_HAS_HID)
+        throw std::runtime_error("bad DEV1.CHLD info");
+
+    // Nothing has changed since
+    auto generation = snapshot->generation;
+    uacpi_free_device_info_snapshot(snapshot);
+    take_snapshot(generation);
+    expect_count(0);
+
+    eval("\\BCHK");
+    generation = snapshot->generation;
+    uacpi_free_device_info_snapshot(snapshot);
+    take_snapshot(generation);
+    expect_count(2);
+    if (find_entry(dev1)->sta != 0x0D)
+        throw std::runtime_error("stale DEV1._STA");
+    find_entry(chld);
+
+    eval("\\DCHK");
+    generation = snapshot->generation;
+    uacpi_free_device_info_snapshot(snapshot);
+    take_snapshot(generation);
+    expect_count(1);
+    find_entry(dev0);
+}
+
+static void test_device_rescan()
+{
+    uacpi_device_change_list *list = nullptr;
+    uacpi_namespace_node *bus, *dev0, *dev1;
+
+    bus = find_node("\\BUS0");
+    dev0 = find_node("\\BUS0.DEV0");
+    dev1 = find_node("\\BUS0.DEV1");
+
+    auto guard = ScopeGuard(
+        [&list] { uacpi_free_device_change_list(list); }
+    );
+
+    struct expected_change {
+        uacpi_namespace_node *node;
+        uacpi_device_change_kind kind;
+        uacpi_u32 old_sta, new_sta;
+    };
+    auto rescan = [&](
+        const char *method, uacpi_namespace_node *node,
+        std::initializer_list<expected_change> expected
+    ) {
+        if (method != nullptr) {
+            auto st = uacpi_eval(UACPI_NULL, method, UACPI_NULL, UACPI_NULL);
+            ensure_ok_status(st);
+        }
+
+        uacpi_free_device_change_list(list);
+        list = nullptr;
+        auto st = uacpi_rescan_devices(node, &list);
+        ensure_ok_status(st);
+
+        if (list->count != expected.size()) {
+            throw std::runtime_error(
+                "unexpected number of changes " + std::to_string(list->count) +
+                ", expected " + std::to_string(expected.size())
+            );
+        }
+
+        size_t i = 0;
+        for (auto& change : expected) {
+            auto& actual = list->changes[i++];
+
+            if (actual.node != change.node || actual.kind != change.kind ||
+                actual.old_sta != change.old_sta ||
+                actual.new_sta != change.new_sta) {
+                throw std::runtime_error(
+                    std::string("unexpected change ") +
+                    uacpi_device_change_kind_to_string(actual.kind) +
+                    " of " +
+                    std::string(uacpi_namespace_node_name(actual.node).text, 4)
+                );
+            }
+        }
+    };
+
+    // Only _STA is seeded by namespace initialization, identity is unknown
+    rescan("\\CHID", bus, {
+        { bus, UACPI_DEVICE_CHANGE_CHANGED, 0x0F, 0x0F },
+        { dev0, UACPI_DEVICE_CHANGE_CHANGED, 0xFFFFFFFF, 0xFFFFFFFF },
+        { dev1, UACPI_DEVICE_CHANGE_CHANGED, 0x0F, 0x0F },
+    });
+    rescan(nullptr, bus, {});
+
+    rescan("\\CHI2", bus, {
+        { dev1, UACPI_DEVICE_CHANGE_CHANGED, 0x0F, 0x0F },
+    });
+    rescan("\\HIDE", dev1, {
+        { dev1, UACPI_DEVICE_CHANGE_CHANGED, 0x0F, 0x0D },
+    });
+
+    // Children of a removed device are removed without being evaluated
+    rescan("\\UNPL", bus, {
+        { bus, UACPI_DEVICE_CHANGE_REMOVED, 0x0F, 0 },
+        { dev0, UACPI_DEVICE_CHANGE_REMOVED, 0xFFFFFFFF, 0 },
+        { dev1, UACPI_DEVICE_CHANGE_REMOVED, 0x0D, 0 },
+    });
+    rescan("\\PLUG", bus, {
+        { bus, UACPI_DEVICE_CHANGE_ADDED, 0, 0x0F },
+        { dev0, UACPI_DEVICE_CHANGE_ADDED, 0, 0xFFFFFFFF },
+        { dev1, UACPI_DEVICE_CHANGE_ADDED, 0, 0x0D },
+    });
+    rescan(nullptr, bus, {});
+}
+
+static void print_boot_timeline()
+{
+    uacpi_boot_timeline *timeline;
+
+    auto st = uacpi_get_boot_timeline(&timeline);
+    ensure_ok_status(st);
+    auto guard = ScopeGuard(
+        [timeline] { uacpi_free_boot_timeline(timeline); }
+    );
+
+    auto base_ns = timeline->count ? timeline->records[0].begin_ns : 0;
+
+    for (size_t i = 0; i < timeline->count; ++i) {
+        auto& rec = timeline->records[i];
+
+        std::printf(
+            "[+%10.3fms] %-15s %9.3fms ",
+            (rec.begin_ns - base_ns) / 1000000.0,
+            uacpi_timeline_event_to_string(rec.event),
+            (rec.end_ns - rec.begin_ns) / 1000000.0
+        );
+
+        switch (rec.event) {
+        case UACPI_TIMELINE_EVENT_RXSDT_PARSE:
+        case UACPI_TIMELINE_EVENT_TABLE_INSTALL:
+        case UACPI_TIMELINE_EVENT_TABLE_LOAD:
+            std::printf("%.4s", rec.signature.text);
+            break;
+        case UACPI_TIMELINE_EVENT_REG:
+            std::printf("%s", uacpi_address_space_to_string(rec.space));
+            break;
+        case UACPI_TIMELINE_EVENT_STA:
+        case UACPI_TIMELINE_EVENT_INI:
+        case UACPI_TIMELINE_EVENT_GPE_MATCH: {
+            auto *path = uacpi_namespace_node_generate_absolute_path(rec.node);
+            std::printf("%s", path);
+            uacpi_free_absolute_path(path);
+        } break;
+        default:
+            break;
+        }
+
+        std::printf(
+            " (%" PRIu64 " ops, %" PRIu64 " allocations, count %" PRIu64
+            "): %s\n", rec.ops, rec.allocations, rec.count,
+            uacpi_status_to_string(rec.status)
+        );
+    }
+}
+
 static void run_test(
     std::string_view dsdt_path, const std::vector<std::string>& ssdt_paths,
     uacpi_object_type expected_type, std::string_view expected_value,
-    bool dump_namespace
+    bool dump_namespace, bool print_timeline
 )
 {
     acpi_rsdp rsdp {};
@@ -393,6 +1552,8 @@ static void run_test(
 
     auto xsdt_delete = ScopeGuard(
         [&xsdt, &ssdt_paths] {
+            // Work items might still be running, e.g. asynchronous init
+            uacpi_kernel_wait_for_work_completion();
             uacpi_state_reset();
 
             if (xsdt->fadt) {
@@ -432,7 +1593,18 @@ static void run_test(
     st = uacpi_table_unref(&tbl);
     ensure_ok_status(st);
 
-    st = uacpi_initialize(UACPI_FLAG_NO_ACPI_MODE);
+    uacpi_u64 flags = UACPI_FLAG_NO_ACPI_MODE;
+    if (expected_value == "check-lazy-init-works")
+        flags |= UACPI_FLAG_LAZY_NAMESPACE_INIT;
+    else if (expected_value == "check-lazy-reg-works")
+        flags |= UACPI_FLAG_LAZY_REG;
+    else if (expected_value == "check-parallel-namespace-init-works")
+        flags |= UACPI_FLAG_PARALLEL_NAMESPACE_INIT;
+
+    if (print_timeline || expected_value == "check-boot-timeline-works")
+        flags |= UACPI_FLAG_BOOT_TIMELINE;
+
+    st = uacpi_initialize(flags);
     ensure_ok_status(st);
 
     /*
@@ -503,15 +1675,33 @@ static void run_test(
 
     st = uacpi_install_address_space_handler(
         uacpi_namespace_root(), UACPI_ADDRESS_SPACE_EMBEDDED_CONTROLLER,
-        handle_ec, nullptr
+        expected_value == "check-parallel-namespace-init-works" ?
+            handle_ec_index_data : handle_ec,
+        nullptr
     );
     ensure_ok_status(st);
 
-    st = uacpi_namespace_initialize();
+    if (expected_value == "check-async-init-works") {
+        if (uacpi_get_current_init_stage() != UACPI_INIT_STAGE_TABLES_LOADED)
+            throw std::runtime_error("unexpected stage after namespace load");
+
+        g_breakpoint_hook = take_async_init_snapshot;
+        st = uacpi_namespace_initialize_async();
+        ensure_ok_status(st);
+
+        st = uacpi_wait_for_init_stage(
+            UACPI_INIT_STAGE_DEVICES_INITIALIZED, 0xFFFF
+        );
+        g_breakpoint_hook = nullptr;
+    } else {
+        st = uacpi_namespace_initialize();
+    }
     ensure_ok_status(st);
 
     if (dump_namespace)
         enumerate_namespace();
+    if (print_timeline)
+        print_boot_timeline();
 
     if (!is_test_mode)
         // We're done with emulation mode
@@ -519,6 +1709,62 @@ static void run_test(
 
     if (expected_value == "check-object-api-works") {
         test_object_api();
+        test_returned_package();
+        return;
+    }
+
+    if (expected_value == "check-resource-cache-works") {
+        test_resource_cache();
+        return;
+    }
+
+    if (expected_value == "check-resource-streaming-works") {
+        test_resource_streaming();
+        return;
+    }
+
+    if (expected_value == "check-resource-bulk-works") {
+        test_resource_bulk();
+        return;
+    }
+
+    if (expected_value == "check-pci-interrupt-routing-works") {
+        test_pci_interrupt_routing();
+        return;
+    }
+
+    if (expected_value == "check-pci-routing-table-shared-works") {
+        test_pci_routing_table_shared();
+        return;
+    }
+
+    if (expected_value == "check-set-resources-works") {
+        test_set_resources();
+        return;
+    }
+
+    if (expected_value == "check-async-init-works") {
+        test_async_init();
+        return;
+    }
+
+    if (expected_value == "check-lazy-init-works") {
+        test_lazy_init();
+        return;
+    }
+
+    if (expected_value == "check-boot-timeline-works") {
+        test_boot_timeline();
+        return;
+    }
+
+    if (expected_value == "check-device-info-snapshot-works") {
+        test_device_info_snapshot();
+        return;
+    }
+
+    if (expected_value == "check-device-rescan-works") {
+        test_device_rescan();
         return;
     }
 
@@ -558,8 +1804,9 @@ int main(int argc, char** argv)
     auto args = ArgParser {};
     args.add_positional(
             "dsdt-path-or-keyword",
-            "path to the DSDT to run or \"resource-tests\" to run the resource "
-            "tests and exit"
+            "path to the DSDT to run, \"resource-tests\" to run the resource "
+            "tests and exit, or \"resource-bench\" to benchmark resource "
+            "conversions and exit"
         )
         .add_list(
             "expect", 'r', "test mode, evaluate \\MAIN and expect "
@@ -572,10 +1819,18 @@ int main(int argc, char** argv)
             "enumerate-namespace", 'd',
             "dump the entire namespace after loading it"
         )
+        .add_flag(
+            "boot-timeline", 'b',
+            "record the boot timeline and print it after initialization"
+        )
         .add_param(
             "while-loop-timeout", 't',
             "number of seconds to use for the while loop timeout"
         )
+        .add_param(
+            "bench-iterations", 'n',
+            "number of conversions to time per direction for resource-bench"
+        )
         .add_param(
             "log-level", 'l',
             "log level to set, one of: debug, trace, info, warning, error"
@@ -598,6 +1853,11 @@ int main(int argc, char** argv)
             return 0;
         }
 
+        if (dsdt_path_or_keyword == "resource-bench") {
+            run_resource_bench(args.get_uint_or("bench-iterations", 1000));
+            return 0;
+        }
+
         std::string_view expected_value;
         uacpi_object_type expected_type = UACPI_OBJECT_UNINITIALIZED;
 
@@ -620,7 +1880,8 @@ int main(int argc, char** argv)
         uacpi_context_set_log_level(log_level);
 
         run_test(dsdt_path_or_keyword, args.get_list_or("extra-tables", {}),
-                 expected_type, expected_value, dump_namespace);
+                 expected_type, expected_value, dump_namespace,
+                 args.is_set('b'));
     } catch (const std::exception& ex) {
         std::cerr << "unexpected error: " << ex.what() << std::endl;
         return 1;